@@ -0,0 +1,329 @@
+#ifndef ASYNC_POOL_HPP
+#define ASYNC_POOL_HPP
+
+// Asynchronous pins for C++20 coroutines. Request handlers are Tasks run
+// by an Executor on one thread; "co_await pool.pin(pageNum)" completes
+// without suspending on a hit and suspends on a miss while an IoThreadPool
+// thread reads the page. The pool's metadata is only touched on the
+// executor thread: I/O threads fill the reserved frame and post the
+// completion back. Write-backs of dirty victims stay synchronous.
+
+#include "buffer_pool.hpp"
+
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace bm {
+
+class Executor;
+
+// Fire-and-forget coroutine started with Executor::spawn()
+class Task {
+public:
+	struct promise_type {
+		Executor *executor = nullptr;
+
+		Task get_return_object()
+		{
+			return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+		}
+		std::suspend_always initial_suspend() noexcept { return {}; }
+		std::suspend_never final_suspend() noexcept;
+		void return_void() {}
+		void unhandled_exception() { std::terminate(); }
+	};
+
+	Task(Task &&other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+	Task(const Task &) = delete;
+	Task &operator=(const Task &) = delete;
+	Task &operator=(Task &&) = delete;
+
+	// A task that was never spawned is destroyed without running
+	~Task()
+	{
+		if (handle) {
+			handle.destroy();
+		}
+	}
+
+private:
+	friend class Executor;
+	explicit Task(std::coroutine_handle<promise_type> h) : handle(h) {}
+
+	std::coroutine_handle<promise_type> handle;
+};
+
+// Single-threaded run loop; post() may be called from any thread
+class Executor {
+public:
+	Executor() = default;
+	Executor(const Executor &) = delete;
+	Executor &operator=(const Executor &) = delete;
+
+	// Queues a function to run on the executor thread
+	void post(std::function<void()> fn)
+	{
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			queue.push_back(std::move(fn));
+		}
+		wakeup.notify_one();
+	}
+
+	// Starts a task on the next turn of the loop
+	void spawn(Task task)
+	{
+		std::coroutine_handle<Task::promise_type> h = std::exchange(task.handle, nullptr);
+		h.promise().executor = this;
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			liveTasks++;
+		}
+		post([h] { h.resume(); });
+	}
+
+	// Runs queued work on the calling thread until every spawned task finished
+	void run()
+	{
+		for (;;) {
+			std::function<void()> fn;
+			{
+				std::unique_lock<std::mutex> guard(lock);
+				wakeup.wait(guard, [this] { return !queue.empty() || liveTasks == 0; });
+				if (queue.empty()) {
+					return;
+				}
+				fn = std::move(queue.front());
+				queue.pop_front();
+			}
+			fn();
+		}
+	}
+
+private:
+	friend struct Task::promise_type;
+
+	void taskDone()
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		liveTasks--;
+	}
+
+	std::mutex lock;
+	std::condition_variable wakeup;
+	std::deque<std::function<void()>> queue;
+	int liveTasks = 0;
+};
+
+inline std::suspend_never Task::promise_type::final_suspend() noexcept
+{
+	executor->taskDone();
+	return {};
+}
+
+// Threads running blocking reads
+class IoThreadPool {
+public:
+	explicit IoThreadPool(int numThreads)
+	{
+		for (int i = 0; i < numThreads; i++) {
+			threads.emplace_back([this] { work(); });
+		}
+	}
+
+	IoThreadPool(const IoThreadPool &) = delete;
+	IoThreadPool &operator=(const IoThreadPool &) = delete;
+
+	// Finishes the queued jobs, then joins the threads
+	~IoThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			stopping = true;
+		}
+		wakeup.notify_all();
+		for (std::thread &thread : threads) {
+			thread.join();
+		}
+	}
+
+	void submit(std::function<void()> job)
+	{
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			jobs.push_back(std::move(job));
+		}
+		wakeup.notify_one();
+	}
+
+private:
+	void work()
+	{
+		for (;;) {
+			std::function<void()> job;
+			{
+				std::unique_lock<std::mutex> guard(lock);
+				wakeup.wait(guard, [this] { return !jobs.empty() || stopping; });
+				if (jobs.empty()) {
+					return;
+				}
+				job = std::move(jobs.front());
+				jobs.pop_front();
+			}
+			job();
+		}
+	}
+
+	std::mutex lock;
+	std::condition_variable wakeup;
+	std::deque<std::function<void()>> jobs;
+	bool stopping = false;
+	std::vector<std::thread> threads;
+};
+
+// Outcome of an asynchronous pin
+struct PinResult {
+	RC rc = RC_ERROR;
+	PageRef ref;
+};
+
+// BufferPool whose misses are read by an IoThreadPool; use it only from
+// tasks of its executor
+template <class Policy, std::size_t PageSize = PAGE_SIZE>
+class AsyncBufferPool {
+	using Pool = BufferPool<Policy, PageSize>;
+
+	struct Load;
+
+public:
+	class PinAwaiter;
+
+	AsyncBufferPool(Executor &executor, IoThreadPool &io) : executor(executor), io(io) {}
+
+	RC init(const char *pageFileName, int frames)
+	{
+		RC result = pool.init(pageFileName, frames);
+		if (result == RC_OK) {
+			loads.assign(frames, nullptr);
+			suspendedPins = 0;
+		}
+		return result;
+	}
+
+	// Fails while pages are pinned or still loading
+	RC shutdown() { return pool.shutdown(); }
+
+	// co_await pin(pageNum) yields a PinResult
+	PinAwaiter pin(PageNumber pageNum) { return PinAwaiter(*this, pageNum); }
+
+	RC unpin(const PageRef &ref) { return pool.unpin(ref); }
+	RC markDirty(const PageRef &ref) { return pool.markDirty(ref); }
+	RC forcePage(const PageRef &ref) { return pool.forcePage(ref); }
+	RC forceFlush() { return pool.forceFlush(); }
+	int numReadIO() const { return pool.numReadIO(); }
+	int numWriteIO() const { return pool.numWriteIO(); }
+	// Pins that had to wait for a read
+	int numSuspendedPins() const { return suspendedPins; }
+
+	class PinAwaiter {
+	public:
+		PinAwaiter(AsyncBufferPool &owner, PageNumber pageNum) : owner(owner), pageNum(pageNum) {}
+
+		// Hits on loaded pages and failures complete without suspending
+		bool await_ready()
+		{
+			if (pageNum < 0) {
+				result.rc = RC_READ_NON_EXISTING_PAGE;
+				return true;
+			}
+
+			int idx = owner.pool.frameOf(pageNum);
+			if (idx != -1) {
+				owner.pool.pinFrame(idx, result.ref);
+				result.rc = RC_OK;
+				load = owner.loads[idx];
+				return load == nullptr;
+			}
+
+			auto pending = std::make_shared<Load>();
+			result.rc = owner.pool.reserveFrame(pageNum, pending->pending);
+			if (result.rc != RC_OK) {
+				return true;
+			}
+			result.ref = pending->pending.ref;
+			load = pending.get();
+			owner.loads[result.ref.frame] = load;
+			owner.startRead(std::move(pending));
+			return false;
+		}
+
+		void await_suspend(std::coroutine_handle<> h)
+		{
+			waiter = h;
+			load->waiters.push_back(this);
+			owner.suspendedPins++;
+		}
+
+		PinResult await_resume() { return result; }
+
+	private:
+		friend class AsyncBufferPool;
+
+		AsyncBufferPool &owner;
+		PageNumber pageNum;
+		PinResult result;
+		Load *load = nullptr;
+		std::coroutine_handle<> waiter;
+	};
+
+private:
+	// Read in flight and the pins waiting for it
+	struct Load {
+		typename Pool::PendingLoad pending;
+		RC rc = RC_OK;
+		std::vector<PinAwaiter *> waiters;
+	};
+
+	void startRead(std::shared_ptr<Load> load)
+	{
+		io.submit([this, load] {
+			load->rc = Pool::readPage(load->pending);
+			executor.post([this, load] { finishRead(*load); });
+		});
+	}
+
+	// Publishes a page read on an I/O thread and resumes its waiters
+	void finishRead(Load &load)
+	{
+		int idx = load.pending.ref.frame;
+		loads[idx] = nullptr;
+		pool.completeLoad(load.pending, load.rc);
+
+		std::vector<PinAwaiter *> waiters = std::move(load.waiters);
+		for (PinAwaiter *awaiter : waiters) {
+			if (load.rc != RC_OK) {
+				awaiter->result.rc = load.rc;
+				awaiter->result.ref = PageRef();
+			}
+			awaiter->waiter.resume();
+		}
+	}
+
+	Executor &executor;
+	IoThreadPool &io;
+	Pool pool;
+	std::vector<Load *> loads;  // Read in flight per frame, nullptr if none
+	int suspendedPins = 0;
+};
+
+} // namespace bm
+
+#endif
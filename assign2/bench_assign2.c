@@ -0,0 +1,1217 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "storage_mgr.h"
+#include "buffer_mgr.h"
+#include "dberror.h"
+#include "frame_scan.h"
+
+#include <limits.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// page file used by all benchmarks
+#define BENCH_FILE "benchbuffer.bin"
+
+// benchmarks
+static void benchWarmup (void);
+static void benchHugePages (void);
+static void benchScan (void);
+static void benchLoop (void);
+static void benchSkewed (void);
+static void benchAdmission (void);
+static void benchAdaptive (void);
+static void benchHints (void);
+static void benchHandles (void);
+static void benchDirtyRanges (void);
+static void benchTier (void);
+static void benchVictim (void);
+static void benchShared (void);
+static void benchStats (void);
+
+// helper methods
+static double nowMs (void);
+static unsigned int nextRandom (void);
+static void createBenchFile (int numPages);
+static void initZipf (int numPages, double skew);
+static int nextZipf (void);
+static const char *strategyName (ReplacementStrategy strategy);
+static void replay (ReplacementStrategy strategy, const BM_PoolOptions *options, int poolSize,
+                    const int *requests, int numRequests, double *hitRatio,
+                    double *nsPerRequest);
+
+typedef struct Benchmark {
+  const char *name;
+  void (*run) (void);
+} Benchmark;
+
+static const Benchmark benchmarks[] = {
+  { "warmup", benchWarmup },
+  { "hugepages", benchHugePages },
+  { "simd", benchScan },
+  { "lirs", benchLoop },
+  { "sieve", benchSkewed },
+  { "tinylfu", benchAdmission },
+  { "adaptive", benchAdaptive },
+  { "hints", benchHints },
+  { "handles", benchHandles },
+  { "ranges", benchDirtyRanges },
+  { "tier", benchTier },
+  { "victim", benchVictim },
+  { "shared", benchShared },
+  { "stats", benchStats },
+};
+static const int numBenchmarks = sizeof(benchmarks) / sizeof(benchmarks[0]);
+
+// run the benchmarks named on the command line, or all of them
+int
+main (int argc, char *argv[])
+{
+  int i, j;
+
+  initStorageManager();
+
+  for (i = 0; i < numBenchmarks; i++)
+    {
+      int selected = (argc < 2);
+      for (j = 1; j < argc; j++)
+        if (strcmp(argv[j], benchmarks[i].name) == 0)
+          selected = 1;
+      if (selected)
+        {
+          printf("== %s ==\n", benchmarks[i].name);
+          benchmarks[i].run();
+          printf("\n");
+        }
+    }
+  return 0;
+}
+
+/************************************************************
+ *                    helpers                               *
+ ************************************************************/
+
+double
+nowMs (void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+// xorshift generator, so every run sees the same request sequence
+static unsigned int randomState = 2463534242u;
+
+unsigned int
+nextRandom (void)
+{
+  randomState ^= randomState << 13;
+  randomState ^= randomState >> 17;
+  randomState ^= randomState << 5;
+  return randomState;
+}
+
+// create the benchmark page file with numPages zeroed pages
+void
+createBenchFile (int numPages)
+{
+  SM_FileHandle fh;
+
+  CHECK(createPageFile(BENCH_FILE));
+  CHECK(openPageFile(BENCH_FILE, &fh));
+  CHECK(ensureCapacity(numPages, &fh));
+  CHECK(closePageFile(&fh));
+}
+
+// cumulative distribution of a zipf distribution over the pages
+static double *zipfCdf = NULL;
+static int zipfPages = 0;
+
+void
+initZipf (int numPages, double skew)
+{
+  int i;
+  double sum = 0;
+
+  free(zipfCdf);
+  zipfCdf = malloc(sizeof(double) * numPages);
+  zipfPages = numPages;
+  for (i = 0; i < numPages; i++)
+    {
+      sum += 1.0 / pow(i + 1, skew);
+      zipfCdf[i] = sum;
+    }
+  for (i = 0; i < numPages; i++)
+    zipfCdf[i] /= sum;
+}
+
+// draw a page; popular ranks are scattered over the file
+int
+nextZipf (void)
+{
+  double u = (nextRandom() & 0xFFFFFF) / (double) 0x1000000;
+  int lo = 0, hi = zipfPages - 1;
+
+  while (lo < hi)
+    {
+      int mid = (lo + hi) / 2;
+      if (zipfCdf[mid] < u)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+  return (int) ((lo * 2654435761u) % (unsigned int) zipfPages);
+}
+
+/************************************************************
+ *                    warm-up                               *
+ ************************************************************/
+
+#define WARM_FILE_PAGES 16384
+#define WARM_POOL_PAGES 4096
+#define WARM_WINDOW 1000
+#define WARM_MAX_REQUESTS 400000
+// emulated device latency, roughly a random read on a SATA SSD
+#define WARM_READ_LATENCY 100
+
+// run the zipf workload until the hit ratio of a window reaches target
+static void
+runUntilWarm (const BM_PoolOptions *options, double target, const char *label)
+{
+  BM_BufferPool bm;
+  BM_PageHandle h;
+  int requests = 0, windowMisses = 0, misses = 0;
+  int reads, preloaded;
+  double start, ratio = 0;
+
+  randomState = 2463534242u;
+  start = nowMs();
+  CHECK(initBufferPoolWithOptions(&bm, BENCH_FILE, WARM_POOL_PAGES, RS_LRU, NULL, options));
+
+  while (requests < WARM_MAX_REQUESTS)
+    {
+      reads = getNumReadIO(&bm);
+      preloaded = getNumPreloadedPages(&bm);
+      CHECK(pinPage(&bm, &h, nextZipf()));
+      CHECK(unpinPage(&bm, &h));
+      windowMisses += (getNumReadIO(&bm) - reads) - (getNumPreloadedPages(&bm) - preloaded);
+      requests++;
+
+      if (requests % WARM_WINDOW == 0)
+        {
+          ratio = 1.0 - (double) windowMisses / WARM_WINDOW;
+          misses += windowMisses;
+          windowMisses = 0;
+          if (ratio >= target)
+            break;
+        }
+    }
+
+  printf("%-6s reached %.1f%% hits after %7d requests, %8.1f ms, %6d misses, %5d preloaded\n",
+         label, ratio * 100, requests, nowMs() - start, misses, getNumPreloadedPages(&bm));
+  CHECK(shutdownBufferPool(&bm));
+}
+
+// reach steady state once, return its hit ratio; shutdown dumps the hot set
+static double
+dumpSteadyState (const BM_PoolOptions *options)
+{
+  BM_BufferPool bm;
+  BM_PageHandle h;
+  int i, reads, misses = 0;
+
+  randomState = 2463534242u;
+  CHECK(initBufferPoolWithOptions(&bm, BENCH_FILE, WARM_POOL_PAGES, RS_LRU, NULL, options));
+  for (i = 0; i < WARM_MAX_REQUESTS; i++)
+    {
+      reads = getNumReadIO(&bm);
+      CHECK(pinPage(&bm, &h, nextZipf()));
+      CHECK(unpinPage(&bm, &h));
+      if (i >= WARM_MAX_REQUESTS / 2)
+        misses += getNumReadIO(&bm) - reads;
+    }
+  CHECK(shutdownBufferPool(&bm));
+
+  return 1.0 - (double) misses / (WARM_MAX_REQUESTS / 2);
+}
+
+// time for a restarted pool to reach the steady-state hit ratio, cold vs
+// preloaded, with reads from the page cache and with injected read latency
+void
+benchWarmup (void)
+{
+  const long latencies[] = { 0, WARM_READ_LATENCY };
+  BM_PoolOptions options;
+  double steady;
+  int i;
+
+  memset(&options, 0, sizeof(options));
+  options.warmFile = "benchbuffer.warm";
+
+  createBenchFile(WARM_FILE_PAGES);
+  initZipf(WARM_FILE_PAGES, 0.9);
+
+  for (i = 0; i < 2; i++)
+    {
+      // every warm run starts from the same dump
+      remove(options.warmFile);
+      setReadLatency(0);
+      steady = dumpSteadyState(&options);
+      if (i == 0)
+        printf("file %d pages, pool %d frames, zipf 0.9, LRU; steady state %.1f%% hits\n",
+               WARM_FILE_PAGES, WARM_POOL_PAGES, steady * 100);
+      printf("time to reach 98%% of the steady-state hit ratio (windows of %d requests), "
+             "%ld us per read call:\n", WARM_WINDOW, latencies[i]);
+
+      setReadLatency(latencies[i]);
+      runUntilWarm(NULL, steady * 0.98, "cold");
+      runUntilWarm(&options, steady * 0.98, "warm");
+    }
+
+  setReadLatency(0);
+  remove(options.warmFile);
+  CHECK(destroyPageFile(BENCH_FILE));
+}
+
+/************************************************************
+ *                    huge pages                            *
+ ************************************************************/
+
+// 64 MB of frames, well beyond the reach of a 4 KB TLB
+#define HUGE_POOL_PAGES 16384
+#define HUGE_PINS 200000
+#define HUGE_TOUCHES 20000000
+
+static const char *
+frameMemoryName (FrameMemoryMode mode)
+{
+  switch (mode)
+    {
+    case FM_HEAP:
+      return "heap";
+    case FM_TRANSPARENT_HUGE:
+      return "thp";
+    case FM_HUGETLB:
+      return "hugetlb";
+    default:
+      return "auto";
+    }
+}
+
+// random pins and random accesses to pinned pages over a pool larger than the TLB reach
+void
+benchHugePages (void)
+{
+  const FrameMemoryMode modes[] = { FM_HEAP, FM_TRANSPARENT_HUGE, FM_HUGETLB };
+  BM_BufferPool bm;
+  BM_PageHandle h;
+  BM_PoolOptions options;
+  char **data = malloc(sizeof(char *) * HUGE_POOL_PAGES);
+  unsigned int sum = 0;
+  int m, i;
+  double start, pinNs, touchNs;
+
+  createBenchFile(HUGE_POOL_PAGES);
+  printf("pool %d frames (%d MB), %d random pins, %d random accesses to pinned pages\n",
+         HUGE_POOL_PAGES, HUGE_POOL_PAGES / 256, HUGE_PINS, HUGE_TOUCHES);
+
+  for (m = 0; m < 3; m++)
+    {
+      memset(&options, 0, sizeof(options));
+      options.frameMemory = modes[m];
+      CHECK(initBufferPoolWithOptions(&bm, BENCH_FILE, HUGE_POOL_PAGES, RS_CLOCK, NULL, &options));
+      if (m > 0 && getFrameMemoryMode(&bm) != modes[m])
+        {
+          printf("%-8s unavailable, got %s\n", frameMemoryName(modes[m]),
+                 frameMemoryName(getFrameMemoryMode(&bm)));
+          CHECK(shutdownBufferPool(&bm));
+          continue;
+        }
+
+      // load every page and keep it pinned
+      for (i = 0; i < HUGE_POOL_PAGES; i++)
+        {
+          CHECK(pinPage(&bm, &h, i));
+          data[i] = h.data;
+        }
+
+      randomState = 2463534242u;
+      start = nowMs();
+      for (i = 0; i < HUGE_PINS; i++)
+        {
+          CHECK(pinPage(&bm, &h, nextRandom() % HUGE_POOL_PAGES));
+          sum += (unsigned char) h.data[(nextRandom() % 64) * 64];
+          CHECK(unpinPage(&bm, &h));
+        }
+      pinNs = (nowMs() - start) * 1000000.0 / HUGE_PINS;
+
+      // each access depends on the previous one, so TLB misses are not overlapped
+      start = nowMs();
+      for (i = 0; i < HUGE_TOUCHES; i++)
+        {
+          unsigned int r = nextRandom() + sum;
+          sum += (unsigned char) data[r % HUGE_POOL_PAGES][(r >> 20) % 64 * 64];
+        }
+      touchNs = (nowMs() - start) * 1000000.0 / HUGE_TOUCHES;
+
+      printf("%-8s pin+access+unpin %8.1f ns/op, access pinned page %6.2f ns/op\n",
+             frameMemoryName(getFrameMemoryMode(&bm)), pinNs, touchNs);
+
+      for (i = 0; i < HUGE_POOL_PAGES; i++)
+        {
+          h.fileId = DEFAULT_FILE_ID;
+          h.pageNum = i;
+          CHECK(unpinPage(&bm, &h));
+        }
+      CHECK(shutdownBufferPool(&bm));
+    }
+
+  if (sum == 1)
+    printf("\n");
+  free(data);
+  CHECK(destroyPageFile(BENCH_FILE));
+}
+
+// pools sizes for the scan benchmark, and scans per size
+#define SCAN_MAX_FRAMES 4096
+#define SCAN_WORK 50000000
+
+// first unpinned frame with a clear reference bit, one frame at a time
+static int
+firstCandidateScalar (const int *fixCounts, const char *refs, int n)
+{
+  int i;
+  for (i = 0; i < n; i++)
+    if (fixCounts[i] == 0 && !refs[i])
+      return i;
+  return -1;
+}
+
+// the same search over pinned and reference bitmaps, 64 frames per step
+static int
+firstCandidateBitmap (const uint64_t *pinned, const uint64_t *refs, int n)
+{
+  int w;
+  for (w = 0; w < (n + 63) / 64; w++)
+    {
+      uint64_t free = ~(pinned[w] | refs[w]);
+      if (n - w * 64 < 64)
+        free &= ((uint64_t) 1 << (n - w * 64)) - 1;
+      if (free != 0)
+        return w * 64 + __builtin_ctzll(free);
+    }
+  return -1;
+}
+
+// the three frame searches of pinPage, scalar loops against the vector kernels
+void
+benchScan (void)
+{
+  const int sizes[] = { 64, 256, 1024, 4096 };
+  int *pages = malloc(sizeof(int) * SCAN_MAX_FRAMES);
+  int *stamps = malloc(sizeof(int) * SCAN_MAX_FRAMES);
+  int *fixCounts = malloc(sizeof(int) * SCAN_MAX_FRAMES);
+  char *refs = malloc(SCAN_MAX_FRAMES);
+  uint64_t pinnedBits[SCAN_MAX_FRAMES / 64], refBits[SCAN_MAX_FRAMES / 64];
+  long sum = 0;
+  int s, i, r;
+
+  printf("kernel %s; ns per scan of the whole pool\n", scanKernelName());
+  printf("%6s %12s %12s %12s %12s %12s %12s\n", "frames", "find scalar", "find simd",
+         "lru scalar", "lru simd", "clock scalar", "clock bitmap");
+
+  for (s = 0; s < 4; s++)
+    {
+      int n = sizes[s];
+      int rounds = SCAN_WORK / n;
+      double start, t[6];
+
+      // a full pool of distinct pages, half of them pinned or referenced
+      memset(pinnedBits, 0, sizeof(pinnedBits));
+      memset(refBits, 0, sizeof(refBits));
+      randomState = 2463534242u;
+      for (i = 0; i < n; i++)
+        {
+          pages[i] = i * 7;
+          stamps[i] = (int) (nextRandom() % 1000000);
+          fixCounts[i] = (nextRandom() % 2 == 0);
+          refs[i] = (i < n - 1);
+          if (fixCounts[i])
+            pinnedBits[i / 64] |= (uint64_t) 1 << (i % 64);
+          if (refs[i])
+            refBits[i / 64] |= (uint64_t) 1 << (i % 64);
+        }
+      fixCounts[n - 1] = 0;
+      pinnedBits[(n - 1) / 64] &= ~((uint64_t) 1 << ((n - 1) % 64));
+
+      // lookups miss, as every lookup of pinPage does before a read
+      start = nowMs();
+      for (r = 0; r < rounds; r++)
+        sum += scanFindPageScalar(pages, 0, n, -2 - (r & 1));
+      t[0] = nowMs() - start;
+      start = nowMs();
+      for (r = 0; r < rounds; r++)
+        sum += scanFindPage(pages, 0, n, -2 - (r & 1));
+      t[1] = nowMs() - start;
+
+      start = nowMs();
+      for (r = 0; r < rounds; r++)
+        {
+          stamps[r % n] ^= 1;
+          sum += scanMinUnpinnedScalar(stamps, fixCounts, n);
+        }
+      t[2] = nowMs() - start;
+      start = nowMs();
+      for (r = 0; r < rounds; r++)
+        {
+          stamps[r % n] ^= 1;
+          sum += scanMinUnpinned(stamps, fixCounts, n);
+        }
+      t[3] = nowMs() - start;
+
+      // the only candidate is the last frame, the worst case of a clock sweep
+      start = nowMs();
+      for (r = 0; r < rounds; r++)
+        {
+          refs[r % (n - 1)] = 1;
+          sum += firstCandidateScalar(fixCounts, refs, n);
+        }
+      t[4] = nowMs() - start;
+      start = nowMs();
+      for (r = 0; r < rounds; r++)
+        {
+          refBits[0] |= (uint64_t) (r & 1);
+          sum += firstCandidateBitmap(pinnedBits, refBits, n);
+        }
+      t[5] = nowMs() - start;
+
+      printf("%6d", n);
+      for (i = 0; i < 6; i++)
+        printf(" %12.1f", t[i] * 1000000.0 / rounds);
+      printf("\n");
+    }
+
+  if (sum == 1)
+    printf("\n");
+  free(pages);
+  free(stamps);
+  free(fixCounts);
+  free(refs);
+}
+
+/************************************************************
+ *                    replacement strategies                *
+ ************************************************************/
+
+const char *
+strategyName (ReplacementStrategy strategy)
+{
+  switch (strategy)
+    {
+    case RS_FIFO:
+      return "FIFO";
+    case RS_LRU:
+      return "LRU";
+    case RS_CLOCK:
+      return "CLOCK";
+    case RS_GCLOCK:
+      return "GCLOCK";
+    case RS_CLOCK_PRO:
+      return "CLOCK-Pro";
+    case RS_LIRS:
+      return "LIRS";
+    case RS_SIEVE:
+      return "SIEVE";
+    default:
+      return "?";
+    }
+}
+
+// pin and unpin every request once, reporting the hit ratio and the time per request
+void
+replay (ReplacementStrategy strategy, const BM_PoolOptions *options, int poolSize,
+        const int *requests, int numRequests, double *hitRatio, double *nsPerRequest)
+{
+  BM_BufferPool bm;
+  BM_PageHandle h;
+  double start;
+  int i;
+
+  CHECK(initBufferPoolWithOptions(&bm, BENCH_FILE, poolSize, strategy, NULL, options));
+  start = nowMs();
+  for (i = 0; i < numRequests; i++)
+    {
+      CHECK(pinPage(&bm, &h, requests[i]));
+      CHECK(unpinPage(&bm, &h));
+    }
+  *nsPerRequest = (nowMs() - start) * 1000000.0 / numRequests;
+  *hitRatio = 1.0 - (double) getNumReadIO(&bm) / numRequests;
+  CHECK(shutdownBufferPool(&bm));
+}
+
+// pool size and passes of the looping benchmark
+#define LOOP_POOL_PAGES 1000
+#define LOOP_PASSES 20
+
+// sequential loops over slightly more pages than the pool holds
+void
+benchLoop (void)
+{
+  const ReplacementStrategy strategies[] = { RS_LRU, RS_CLOCK, RS_CLOCK_PRO, RS_LIRS };
+  const int loopPercent[] = { 90, 110, 150 };
+  int maxLoop = LOOP_POOL_PAGES * 3 / 2;
+  int *requests = malloc(sizeof(int) * maxLoop * LOOP_PASSES);
+  double hitRatio, ns;
+  int l, s, i;
+
+  createBenchFile(maxLoop);
+  printf("pool %d frames, %d passes over each loop\n", LOOP_POOL_PAGES, LOOP_PASSES);
+  printf("%-10s", "loop");
+  for (s = 0; s < 4; s++)
+    printf(" %21s", strategyName(strategies[s]));
+  printf("\n");
+
+  for (l = 0; l < 3; l++)
+    {
+      int loop = LOOP_POOL_PAGES * loopPercent[l] / 100;
+      for (i = 0; i < loop * LOOP_PASSES; i++)
+        requests[i] = i % loop;
+
+      printf("%4d pages", loop);
+      for (s = 0; s < 4; s++)
+        {
+          replay(strategies[s], NULL, LOOP_POOL_PAGES, requests, loop * LOOP_PASSES, &hitRatio, &ns);
+          printf("   %5.1f%% hits %6.0f ns", hitRatio * 100.0, ns);
+        }
+      printf("\n");
+    }
+
+  free(requests);
+  CHECK(destroyPageFile(BENCH_FILE));
+}
+
+// skewed workload: zipf requests over a file ten times the pool
+#define SKEW_POOL_PAGES 1000
+#define SKEW_FILE_PAGES 10000
+#define SKEW_REQUESTS 1000000
+
+// hit ratio and time per request of the FIFO family against LRU on zipf workloads
+void
+benchSkewed (void)
+{
+  const ReplacementStrategy strategies[] = { RS_FIFO, RS_LRU, RS_CLOCK, RS_SIEVE };
+  const double skews[] = { 0.6, 0.8, 1.0 };
+  int *requests = malloc(sizeof(int) * SKEW_REQUESTS);
+  double hitRatio, ns;
+  int k, s, i;
+
+  createBenchFile(SKEW_FILE_PAGES);
+  printf("pool %d frames, %d pages, %d zipf requests\n", SKEW_POOL_PAGES, SKEW_FILE_PAGES,
+         SKEW_REQUESTS);
+  printf("%-6s", "skew");
+  for (s = 0; s < 4; s++)
+    printf(" %21s", strategyName(strategies[s]));
+  printf("\n");
+
+  for (k = 0; k < 3; k++)
+    {
+      initZipf(SKEW_FILE_PAGES, skews[k]);
+      randomState = 2463534242u;
+      for (i = 0; i < SKEW_REQUESTS; i++)
+        requests[i] = nextZipf();
+
+      printf("%-6.1f", skews[k]);
+      for (s = 0; s < 4; s++)
+        {
+          replay(strategies[s], NULL, SKEW_POOL_PAGES, requests, SKEW_REQUESTS, &hitRatio, &ns);
+          printf("   %5.1f%% hits %6.0f ns", hitRatio * 100.0, ns);
+        }
+      printf("\n");
+    }
+
+  free(requests);
+  CHECK(destroyPageFile(BENCH_FILE));
+}
+
+// share of requests that touch a cold page, and the pages they cycle through; a
+// cold page comes back only after far more requests than the pool or the sketch remembers
+#define ONE_HIT_PERCENT 30
+#define ONE_HIT_PAGES 20000
+
+// zipf requests mixed with one-hit pages, with and without the TinyLFU admission filter
+void
+benchAdmission (void)
+{
+  const ReplacementStrategy strategies[] = { RS_FIFO, RS_LRU, RS_CLOCK };
+  int *requests = malloc(sizeof(int) * SKEW_REQUESTS);
+  int nextOneHit = 0;
+  BM_PoolOptions options;
+  double hitRatio, ns;
+  int s, a, i;
+
+  createBenchFile(SKEW_FILE_PAGES + ONE_HIT_PAGES);
+  initZipf(SKEW_FILE_PAGES, 0.8);
+  randomState = 2463534242u;
+  for (i = 0; i < SKEW_REQUESTS; i++)
+    if (nextRandom() % 100 < ONE_HIT_PERCENT)
+      requests[i] = SKEW_FILE_PAGES + nextOneHit++ % ONE_HIT_PAGES;
+    else
+      requests[i] = nextZipf();
+
+  printf("pool %d frames, %d zipf(0.8) pages, %d requests, %d%% one-hit pages\n",
+         SKEW_POOL_PAGES, SKEW_FILE_PAGES, SKEW_REQUESTS, ONE_HIT_PERCENT);
+  printf("%-10s %21s %21s\n", "strategy", "plain", "tinylfu");
+  memset(&options, 0, sizeof(options));
+  for (s = 0; s < 3; s++)
+    {
+      printf("%-10s", strategyName(strategies[s]));
+      for (a = 0; a < 2; a++)
+        {
+          options.admissionFilter = (a == 1);
+          replay(strategies[s], &options, SKEW_POOL_PAGES, requests, SKEW_REQUESTS,
+                 &hitRatio, &ns);
+          printf("   %5.1f%% hits %6.0f ns", hitRatio * 100.0, ns);
+        }
+      printf("\n");
+    }
+
+  free(requests);
+  CHECK(destroyPageFile(BENCH_FILE));
+}
+
+// requests of each phase of the adaptive benchmark
+#define PHASE_REQUESTS 500000
+
+// a zipf phase followed by a loop phase, with fixed strategies and with an
+// adaptive pool starting from FIFO
+void
+benchAdaptive (void)
+{
+  const ReplacementStrategy strategies[] = { RS_FIFO, RS_LRU, RS_CLOCK };
+  int *requests = malloc(sizeof(int) * PHASE_REQUESTS * 2);
+  int loop = SKEW_POOL_PAGES * 3 / 2;
+  BM_PoolOptions options;
+  BM_BufferPool bm;
+  BM_PageHandle h;
+  double hitRatio, ns, start;
+  int s, i;
+
+  createBenchFile(SKEW_FILE_PAGES);
+  initZipf(SKEW_FILE_PAGES, 0.8);
+  randomState = 2463534242u;
+  for (i = 0; i < PHASE_REQUESTS; i++)
+    requests[i] = nextZipf();
+  // every other request goes to a small hot set, the rest loops over more pages than the pool
+  for (i = 0; i < PHASE_REQUESTS; i++)
+    requests[PHASE_REQUESTS + i] = (i % 2 == 0) ? (int) (nextRandom() % (SKEW_POOL_PAGES / 2))
+      : SKEW_POOL_PAGES / 2 + (i / 2) % loop;
+
+  printf("pool %d frames, %d zipf(0.8) requests, then %d hot set + loop requests\n",
+         SKEW_POOL_PAGES, PHASE_REQUESTS, PHASE_REQUESTS);
+  for (s = 0; s < 3; s++)
+    {
+      replay(strategies[s], NULL, SKEW_POOL_PAGES, requests, PHASE_REQUESTS * 2, &hitRatio, &ns);
+      printf("%-10s %5.1f%% hits %6.0f ns\n", strategyName(strategies[s]), hitRatio * 100.0, ns);
+    }
+
+  memset(&options, 0, sizeof(options));
+  options.adaptiveStrategy = true;
+  CHECK(initBufferPoolWithOptions(&bm, BENCH_FILE, SKEW_POOL_PAGES, RS_FIFO, NULL, &options));
+  start = nowMs();
+  for (i = 0; i < PHASE_REQUESTS * 2; i++)
+    {
+      CHECK(pinPage(&bm, &h, requests[i]));
+      CHECK(unpinPage(&bm, &h));
+      if (i == PHASE_REQUESTS - 1)
+        printf("adaptive   after the zipf phase: %s, %d switches\n", strategyName(bm.strategy),
+               getNumStrategySwitches(&bm));
+    }
+  ns = (nowMs() - start) * 1000000.0 / (PHASE_REQUESTS * 2);
+  hitRatio = 1.0 - (double) getNumReadIO(&bm) / (PHASE_REQUESTS * 2);
+  printf("adaptive   %5.1f%% hits %6.0f ns, ends with %s after %d switches\n", hitRatio * 100.0,
+         ns, strategyName(bm.strategy), getNumStrategySwitches(&bm));
+  CHECK(shutdownBufferPool(&bm));
+
+  free(requests);
+  CHECK(destroyPageFile(BENCH_FILE));
+}
+
+// share of requests made by the bulk scan, and the pages it reads once each
+#define SCAN_PERCENT 50
+#define SCAN_PAGES (SKEW_REQUESTS * SCAN_PERCENT / 100)
+
+// hit ratio of zipf traffic while a scan reads every page once, pinned plainly or as one-shot
+void
+benchHints (void)
+{
+  const ReplacementStrategy strategies[] = { RS_FIFO, RS_LRU, RS_CLOCK };
+  const PinHint hints[] = { PH_NORMAL, PH_EVICT_SOON };
+  BM_BufferPool bm;
+  BM_PageHandle h;
+  int nextScan, onlineRequests, onlineMisses, reads;
+  double start, ns;
+  int s, k, i;
+
+  createBenchFile(SKEW_FILE_PAGES + SCAN_PAGES);
+  initZipf(SKEW_FILE_PAGES, 0.8);
+  printf("pool %d frames, %d zipf(0.8) pages, %d requests, %d%% from a sequential scan\n",
+         SKEW_POOL_PAGES, SKEW_FILE_PAGES, SKEW_REQUESTS, SCAN_PERCENT);
+  printf("%-10s %28s %28s\n", "strategy", "scan PH_NORMAL", "scan PH_EVICT_SOON");
+  for (s = 0; s < 3; s++)
+    {
+      printf("%-10s", strategyName(strategies[s]));
+      for (k = 0; k < 2; k++)
+        {
+          randomState = 2463534242u;
+          nextScan = SKEW_FILE_PAGES;
+          onlineRequests = 0;
+          onlineMisses = 0;
+          CHECK(initBufferPool(&bm, BENCH_FILE, SKEW_POOL_PAGES, strategies[s], NULL));
+          start = nowMs();
+          for (i = 0; i < SKEW_REQUESTS; i++)
+            {
+              if (nextRandom() % 100 < SCAN_PERCENT && nextScan < SKEW_FILE_PAGES + SCAN_PAGES)
+                {
+                  CHECK(pinPageWithHint(&bm, &h, nextScan++, hints[k]));
+                }
+              else
+                {
+                  reads = getNumReadIO(&bm);
+                  CHECK(pinPage(&bm, &h, nextZipf()));
+                  onlineMisses += getNumReadIO(&bm) - reads;
+                  onlineRequests++;
+                }
+              CHECK(unpinPage(&bm, &h));
+            }
+          ns = (nowMs() - start) * 1000000.0 / SKEW_REQUESTS;
+          printf("   %5.1f%% online hits %6.0f ns",
+                 100.0 - 100.0 * onlineMisses / onlineRequests, ns);
+          CHECK(shutdownBufferPool(&bm));
+        }
+      printf("\n");
+    }
+
+  CHECK(destroyPageFile(BENCH_FILE));
+}
+
+/************************************************************
+ *                    frame-index handles                   *
+ ************************************************************/
+
+#define HANDLE_OPS 2000000
+
+// ns per pin + markDirty + unpin of a resident page; without the frame
+// recorded in the handle, markDirty and unpin look the page up again
+static double
+handleOps (BM_BufferPool *bm, const int *requests, int useFrame)
+{
+  BM_PageHandle h;
+  double start = nowMs();
+  int i;
+
+  for (i = 0; i < HANDLE_OPS; i++)
+    {
+      CHECK(pinPage(bm, &h, requests[i]));
+      if (!useFrame)
+        h.frame = -1;
+      CHECK(markDirty(bm, &h));
+      CHECK(unpinPage(bm, &h));
+    }
+  return (nowMs() - start) * 1000000.0 / HANDLE_OPS;
+}
+
+// markDirty and unpin through the handle's frame against a lookup
+void
+benchHandles (void)
+{
+  const int poolSizes[] = { 64, 1024, 8192 };
+  int *requests = malloc(sizeof(int) * HANDLE_OPS);
+  BM_BufferPool bm;
+  BM_PageHandle h;
+  int p, i;
+
+  createBenchFile(poolSizes[2]);
+  printf("ns per pin + markDirty + unpin of a resident page (LRU), %d random hits\n", HANDLE_OPS);
+  printf("%-6s %10s %10s\n", "frames", "lookup", "frame");
+  for (p = 0; p < 3; p++)
+    {
+      double lookup = 1e9, frame = 1e9;
+      int r;
+
+      randomState = 2463534242u;
+      for (i = 0; i < HANDLE_OPS; i++)
+        requests[i] = nextRandom() % poolSizes[p];
+
+      CHECK(initBufferPool(&bm, BENCH_FILE, poolSizes[p], RS_LRU, NULL));
+      for (i = 0; i < poolSizes[p]; i++)
+        {
+          CHECK(pinPage(&bm, &h, i));
+          CHECK(unpinPage(&bm, &h));
+        }
+      // interleave the runs and keep the best of each
+      for (r = 0; r < 3; r++)
+        {
+          double ns = handleOps(&bm, requests, 0);
+          lookup = (ns < lookup) ? ns : lookup;
+          ns = handleOps(&bm, requests, 1);
+          frame = (ns < frame) ? ns : frame;
+        }
+      printf("%-6d %10.1f %10.1f\n", poolSizes[p], lookup, frame);
+      CHECK(shutdownBufferPool(&bm));
+    }
+
+  free(requests);
+  CHECK(destroyPageFile(BENCH_FILE));
+}
+
+/************************************************************
+ *                    sub-page dirty ranges                 *
+ ************************************************************/
+
+#define RANGE_FILE_PAGES 4096
+#define RANGE_POOL_PAGES 256
+#define RANGE_UPDATES 100000
+#define RANGE_BYTES 200
+
+// random updates of RANGE_BYTES bytes, marked with markDirty or markDirtyRange
+void
+benchDirtyRanges (void)
+{
+  BM_BufferPool bm;
+  BM_PageHandle h;
+  int useRange, i;
+
+  createBenchFile(RANGE_FILE_PAGES);
+  printf("pool %d frames, %d random updates of %d bytes over %d pages\n", RANGE_POOL_PAGES,
+         RANGE_UPDATES, RANGE_BYTES, RANGE_FILE_PAGES);
+  printf("%-14s %10s %14s %14s %10s\n", "marking", "writes", "bytes written", "bytes saved",
+         "ms");
+
+  for (useRange = 0; useRange < 2; useRange++)
+    {
+      double start;
+
+      randomState = 2463534242u;
+      CHECK(initBufferPool(&bm, BENCH_FILE, RANGE_POOL_PAGES, RS_LRU, NULL));
+      start = nowMs();
+      for (i = 0; i < RANGE_UPDATES; i++)
+        {
+          int offset = nextRandom() % (PAGE_SIZE - RANGE_BYTES);
+          CHECK(pinPage(&bm, &h, nextRandom() % RANGE_FILE_PAGES));
+          memset(h.data + offset, i & 0xff, RANGE_BYTES);
+          CHECK(useRange ? markDirtyRange(&bm, &h, offset, RANGE_BYTES) : markDirty(&bm, &h));
+          CHECK(unpinPage(&bm, &h));
+        }
+      CHECK(forceFlushPool(&bm));
+      printf("%-14s %10d %14ld %14ld %10.0f\n", useRange ? "markDirtyRange" : "markDirty",
+             getNumWriteIO(&bm), getNumBytesWritten(&bm), getNumBytesSaved(&bm),
+             nowMs() - start);
+      CHECK(shutdownBufferPool(&bm));
+    }
+
+  CHECK(destroyPageFile(BENCH_FILE));
+}
+
+/************************************************************
+ *                    compressed tier                       *
+ ************************************************************/
+
+// zipf requests over pages holding a few short records each, one in ten an update
+#define TIER_POOL_PAGES 1000
+#define TIER_FILE_PAGES 10000
+#define TIER_REQUESTS 1000000
+#define TIER_RECORDS 16
+#define TIER_RECORD_BYTES 32
+
+// disk reads, tier hits and time per request for growing tier limits
+void
+benchTier (void)
+{
+  const long limits[] = { 0, 1 << 20, 4 << 20, 16 << 20 };
+  BM_BufferPool bm;
+  BM_PageHandle h;
+  BM_PoolOptions options;
+  SM_FileHandle fh;
+  char *block = calloc(1, PAGE_SIZE);
+  int l, i, r;
+
+  createBenchFile(TIER_FILE_PAGES);
+  CHECK(openPageFile(BENCH_FILE, &fh));
+  for (i = 0; i < TIER_FILE_PAGES; i++)
+    {
+      for (r = 0; r < TIER_RECORDS; r++)
+        snprintf(block + r * TIER_RECORD_BYTES, TIER_RECORD_BYTES, "page %d record %d", i, r);
+      CHECK(writeBlock(i, &fh, block));
+    }
+  CHECK(closePageFile(&fh));
+  initZipf(TIER_FILE_PAGES, 0.8);
+
+  printf("pool %d frames, %d pages of %d records, %d zipf requests\n", TIER_POOL_PAGES,
+         TIER_FILE_PAGES, TIER_RECORDS, TIER_REQUESTS);
+  printf("%-10s %10s %10s %10s %12s %10s\n", "tier", "disk reads", "tier hits", "writes",
+         "tier bytes", "ns/req");
+
+  for (l = 0; l < 4; l++)
+    {
+      double start;
+
+      memset(&options, 0, sizeof(options));
+      options.compressedTierBytes = limits[l];
+      randomState = 2463534242u;
+      CHECK(initBufferPoolWithOptions(&bm, BENCH_FILE, TIER_POOL_PAGES, RS_LRU, NULL, &options));
+      start = nowMs();
+      for (i = 0; i < TIER_REQUESTS; i++)
+        {
+          CHECK(pinPage(&bm, &h, nextZipf()));
+          if (i % 10 == 0)
+            {
+              h.data[(i / 10) % (TIER_RECORDS * TIER_RECORD_BYTES)]++;
+              CHECK(markDirty(&bm, &h));
+            }
+          CHECK(unpinPage(&bm, &h));
+        }
+      CHECK(forceFlushPool(&bm));
+      printf("%-10ld %10d %10d %10d %12ld %10.0f\n", limits[l], getNumReadIO(&bm),
+             getNumTierHits(&bm), getNumWriteIO(&bm), getTierBytesUsed(&bm),
+             (nowMs() - start) * 1e6 / TIER_REQUESTS);
+      CHECK(shutdownBufferPool(&bm));
+    }
+
+  free(block);
+  CHECK(destroyPageFile(BENCH_FILE));
+}
+
+/************************************************************
+ *                    victim cache file                     *
+ ************************************************************/
+
+// zipf requests against a page file on a slow volume; the victim cache file
+// lives on a fast local one. Reads of the slow file are charged a modelled
+// network latency on top of the measured time
+#define VICTIM_DIR_SLOW "benchslow"
+#define VICTIM_DIR_FAST "benchfast"
+#define VICTIM_POOL_PAGES 1000
+#define VICTIM_FILE_PAGES 10000
+#define VICTIM_CACHE_PAGES 4000
+#define VICTIM_REQUESTS 200000
+#define VICTIM_SLOW_READ_US 500
+
+// slow reads and modelled time without a victim cache, then over two runs with one
+void
+benchVictim (void)
+{
+  const char *pageFile = VICTIM_DIR_SLOW "/" BENCH_FILE;
+  const char *cacheFile = VICTIM_DIR_FAST "/victim.bin";
+  const char *labels[] = { "none", "cold", "restart" };
+  BM_BufferPool bm;
+  BM_PageHandle h;
+  BM_PoolOptions options;
+  SM_FileHandle fh;
+  int run, i;
+
+  mkdir(VICTIM_DIR_SLOW, 0755);
+  mkdir(VICTIM_DIR_FAST, 0755);
+  CHECK(createPageFile(pageFile));
+  CHECK(openPageFile(pageFile, &fh));
+  CHECK(ensureCapacity(VICTIM_FILE_PAGES, &fh));
+  CHECK(closePageFile(&fh));
+  initZipf(VICTIM_FILE_PAGES, 0.8);
+
+  printf("pool %d frames, %d pages, cache file %d pages, %d zipf requests, %d us per slow read\n",
+         VICTIM_POOL_PAGES, VICTIM_FILE_PAGES, VICTIM_CACHE_PAGES, VICTIM_REQUESTS,
+         VICTIM_SLOW_READ_US);
+  printf("%-8s %10s %10s %10s %10s %12s\n", "cache", "slow reads", "restored", "local hits",
+         "ms", "modelled ms");
+
+  for (run = 0; run < 3; run++)
+    {
+      double start, ms;
+
+      memset(&options, 0, sizeof(options));
+      if (run > 0)
+        {
+          options.victimCacheFile = cacheFile;
+          options.victimCachePages = VICTIM_CACHE_PAGES;
+        }
+      randomState = 2463534242u;
+      start = nowMs();
+      CHECK(initBufferPoolWithOptions(&bm, pageFile, VICTIM_POOL_PAGES, RS_LRU, NULL, &options));
+      for (i = 0; i < VICTIM_REQUESTS; i++)
+        {
+          CHECK(pinPage(&bm, &h, nextZipf()));
+          CHECK(unpinPage(&bm, &h));
+        }
+      ms = nowMs() - start;
+      printf("%-8s %10d %10d %10d %10.0f %12.0f\n", labels[run], getNumReadIO(&bm),
+             getNumVictimRestored(&bm), getNumVictimHits(&bm), ms,
+             ms + getNumReadIO(&bm) * (VICTIM_SLOW_READ_US / 1000.0));
+      CHECK(shutdownBufferPool(&bm));
+    }
+
+  CHECK(destroyPageFile(pageFile));
+  CHECK(destroyPageFile(cacheFile));
+  remove(VICTIM_DIR_FAST "/victim.bin.idx");
+  rmdir(VICTIM_DIR_SLOW);
+  rmdir(VICTIM_DIR_FAST);
+}
+
+/************************************************************
+ *                    shared pool                           *
+ ************************************************************/
+
+// worker processes draw zipf requests from the same page file, each with a
+// private pool or all attached to one shared pool. The parent holds the
+// shared pool open while the workers run
+#define SHARED_NAME "/bm_benchbuffer"
+#define SHARED_WORKERS 4
+#define SHARED_POOL_PAGES 1000
+#define SHARED_FILE_PAGES 10000
+#define SHARED_REQUESTS 250000
+
+// run one worker's requests and send its disk reads up the pipe
+static void
+sharedWorker (int worker, int numPages, const BM_PoolOptions *options, int fd)
+{
+  BM_BufferPool bm;
+  BM_PageHandle h;
+  int i, reads;
+
+  randomState = 2463534242u + worker * 7919u;
+  CHECK(initBufferPoolWithOptions(&bm, BENCH_FILE, numPages, RS_CLOCK, NULL, options));
+  for (i = 0; i < SHARED_REQUESTS; i++)
+    {
+      CHECK(pinPage(&bm, &h, nextZipf()));
+      CHECK(unpinPage(&bm, &h));
+    }
+  reads = getNumReadIO(&bm);
+  CHECK(shutdownBufferPool(&bm));
+  if (write(fd, &reads, sizeof(reads)) != sizeof(reads))
+    _exit(1);
+  _exit(0);
+}
+
+// disk reads and time of private pools against shared pools of the same
+// frame count per pool and of the same total memory
+void
+benchShared (void)
+{
+  const char *labels[] = { "private", "shared", "shared" };
+  const int frames[] = { SHARED_POOL_PAGES, SHARED_POOL_PAGES,
+                         SHARED_POOL_PAGES * SHARED_WORKERS };
+  BM_BufferPool owner;
+  BM_PoolOptions options;
+  int run, w;
+
+  createBenchFile(SHARED_FILE_PAGES);
+  initZipf(SHARED_FILE_PAGES, 0.8);
+  shm_unlink(SHARED_NAME);
+
+  printf("%d workers, %d pages, %d zipf requests each, CLOCK\n", SHARED_WORKERS,
+         SHARED_FILE_PAGES, SHARED_REQUESTS);
+  printf("%-8s %8s %12s %10s %10s\n", "pools", "frames", "total frames", "disk reads", "ms");
+
+  for (run = 0; run < 3; run++)
+    {
+      int fds[2];
+      int total = 0, reads, status;
+      double start;
+
+      memset(&options, 0, sizeof(options));
+      if (run > 0)
+        {
+          options.sharedPoolName = SHARED_NAME;
+          CHECK(initBufferPoolWithOptions(&owner, BENCH_FILE, frames[run], RS_CLOCK, NULL,
+                                          &options));
+        }
+      if (pipe(fds) != 0)
+        exit(1);
+      fflush(stdout);
+      start = nowMs();
+      for (w = 0; w < SHARED_WORKERS; w++)
+        if (fork() == 0)
+          {
+            close(fds[0]);
+            sharedWorker(w, frames[run], &options, fds[1]);
+          }
+      close(fds[1]);
+      for (w = 0; w < SHARED_WORKERS; w++)
+        {
+          if (read(fds[0], &reads, sizeof(reads)) != sizeof(reads))
+            exit(1);
+          total += reads;
+        }
+      for (w = 0; w < SHARED_WORKERS; w++)
+        {
+          wait(&status);
+          if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+            exit(1);
+        }
+      close(fds[0]);
+      printf("%-8s %8d %12d %10d %10.0f\n", labels[run], frames[run],
+             run == 0 ? frames[run] * SHARED_WORKERS : frames[run], total, nowMs() - start);
+      if (run > 0)
+        CHECK(shutdownBufferPool(&owner));
+    }
+
+  CHECK(destroyPageFile(BENCH_FILE));
+}
+
+/************************************************************
+ *                    statistics segment                    *
+ ************************************************************/
+
+// cost of publishing statistics on the skewed workload, with a pool that
+// holds every page (hits only) and with the usual one (I/O on misses);
+// "./bmtop /bm_benchstats" in another terminal shows the pool while it runs
+#define STATS_NAME "/bm_benchstats"
+#define STATS_ROUNDS 3
+
+// best time per request of three rounds without and with the segment
+void
+benchStats (void)
+{
+  const ReplacementStrategy strategies[] = { RS_FIFO, RS_LRU, RS_CLOCK, RS_CLOCK };
+  const int frames[] = { SKEW_FILE_PAGES, SKEW_FILE_PAGES, SKEW_FILE_PAGES, SKEW_POOL_PAGES };
+  int *requests = malloc(sizeof(int) * SKEW_REQUESTS);
+  BM_PoolOptions options;
+  double hitRatio[2], ns, best[2];
+  int s, k, r, i;
+
+  createBenchFile(SKEW_FILE_PAGES);
+  initZipf(SKEW_FILE_PAGES, 0.8);
+  randomState = 2463534242u;
+  for (i = 0; i < SKEW_REQUESTS; i++)
+    requests[i] = nextZipf();
+
+  printf("%d pages, %d zipf requests, best of %d\n", SKEW_FILE_PAGES, SKEW_REQUESTS,
+         STATS_ROUNDS);
+  printf("%-8s %7s %7s %12s %12s\n", "strategy", "frames", "hits", "ns no stats", "ns stats");
+  for (s = 0; s < 4; s++)
+    {
+      for (k = 0; k < 2; k++)
+        {
+          memset(&options, 0, sizeof(options));
+          options.statsName = (k == 1) ? STATS_NAME : NULL;
+          best[k] = 0;
+          for (r = 0; r < STATS_ROUNDS; r++)
+            {
+              replay(strategies[s], &options, frames[s], requests, SKEW_REQUESTS,
+                     &hitRatio[k], &ns);
+              if (r == 0 || ns < best[k])
+                best[k] = ns;
+            }
+        }
+      printf("%-8s %7d %6.1f%% %12.0f %12.0f\n", strategyName(strategies[s]), frames[s],
+             hitRatio[0] * 100.0, best[0], best[1]);
+    }
+
+  free(requests);
+  CHECK(destroyPageFile(BENCH_FILE));
+}
@@ -0,0 +1,433 @@
+extern "C" {
+#include "storage_mgr.h"
+#include "buffer_mgr.h"
+#include "dberror.h"
+}
+#include "buffer_pool.hpp"
+#include "page_guard.hpp"
+#include "async_pool.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <algorithm>
+
+// page file used by all benchmarks
+#define BENCH_FILE "benchpool.bin"
+
+// benchmarks
+static void benchTemplate (void);
+static void benchGuard (void);
+static void benchCoro (void);
+
+// helper methods
+static double nowMs (void);
+static unsigned int nextRandom (void);
+static void createBenchFile (int numPages);
+
+typedef struct Benchmark {
+  const char *name;
+  void (*run) (void);
+} Benchmark;
+
+static const Benchmark benchmarks[] = {
+  { "template", benchTemplate },
+  { "guard", benchGuard },
+  { "coro", benchCoro },
+};
+static const int numBenchmarks = sizeof(benchmarks) / sizeof(benchmarks[0]);
+
+// run the benchmarks named on the command line, or all of them
+int
+main (int argc, char *argv[])
+{
+  int i, j;
+
+  initStorageManager();
+
+  for (i = 0; i < numBenchmarks; i++)
+    {
+      int selected = (argc < 2);
+      for (j = 1; j < argc; j++)
+        if (strcmp(argv[j], benchmarks[i].name) == 0)
+          selected = 1;
+      if (selected)
+        {
+          printf("== %s ==\n", benchmarks[i].name);
+          benchmarks[i].run();
+          printf("\n");
+        }
+    }
+  return 0;
+}
+
+/************************************************************
+ *                    helpers                               *
+ ************************************************************/
+
+double
+nowMs (void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+// xorshift generator, so every run sees the same request sequence
+static unsigned int randomState = 2463534242u;
+
+unsigned int
+nextRandom (void)
+{
+  randomState ^= randomState << 13;
+  randomState ^= randomState >> 17;
+  randomState ^= randomState << 5;
+  return randomState;
+}
+
+// create the benchmark page file with numPages zeroed pages
+void
+createBenchFile (int numPages)
+{
+  SM_FileHandle fh;
+
+  CHECK(createPageFile(BENCH_FILE));
+  CHECK(openPageFile(BENCH_FILE, &fh));
+  CHECK(ensureCapacity(numPages, &fh));
+  CHECK(closePageFile(&fh));
+}
+
+/************************************************************
+ *                    template pool                         *
+ ************************************************************/
+
+#define HIT_REQUESTS 2000000
+
+// time per pin and unpin of resident pages through the C interface
+static double
+cHitPath (ReplacementStrategy strategy, int poolSize, const int *requests)
+{
+  BM_BufferPool bm;
+  BM_PageHandle h;
+  double start, ns;
+  int i;
+
+  CHECK(initBufferPool(&bm, BENCH_FILE, poolSize, strategy, NULL));
+  for (i = 0; i < poolSize; i++)
+    {
+      CHECK(pinPage(&bm, &h, i));
+      CHECK(unpinPage(&bm, &h));
+    }
+
+  start = nowMs();
+  for (i = 0; i < HIT_REQUESTS; i++)
+    {
+      CHECK(pinPage(&bm, &h, requests[i]));
+      CHECK(unpinPage(&bm, &h));
+    }
+  ns = (nowMs() - start) * 1000000.0 / HIT_REQUESTS;
+  CHECK(shutdownBufferPool(&bm));
+  return ns;
+}
+
+// the same through a template pool
+template <class Pool> static double
+templateHitPath (int poolSize, const int *requests)
+{
+  Pool pool;
+  bm::PageRef ref;
+  double start, ns;
+  int i;
+
+  CHECK(pool.init(BENCH_FILE, poolSize));
+  for (i = 0; i < poolSize; i++)
+    {
+      CHECK(pool.pin(i, ref));
+      CHECK(pool.unpin(ref));
+    }
+
+  start = nowMs();
+  for (i = 0; i < HIT_REQUESTS; i++)
+    {
+      CHECK(pool.pin(requests[i], ref));
+      CHECK(pool.unpin(ref));
+    }
+  ns = (nowMs() - start) * 1000000.0 / HIT_REQUESTS;
+  CHECK(pool.shutdown());
+  return ns;
+}
+
+// hit path of the C switch against the compile-time specialized pools
+void
+benchTemplate (void)
+{
+  const int poolSizes[] = { 16, 128, 1024 };
+  int *requests = (int *) malloc(sizeof(int) * HIT_REQUESTS);
+  int p, i;
+
+  createBenchFile(poolSizes[2]);
+  printf("ns per pin + unpin of a resident page, %d random hits\n", HIT_REQUESTS);
+  printf("%-6s %10s %10s %10s %10s %10s %10s\n", "frames", "C FIFO", "tmpl FIFO",
+         "C LRU", "tmpl LRU", "C CLOCK", "tmpl CLOCK");
+
+  for (p = 0; p < 3; p++)
+    {
+      randomState = 2463534242u;
+      for (i = 0; i < HIT_REQUESTS; i++)
+        requests[i] = nextRandom() % poolSizes[p];
+
+      printf("%-6d", poolSizes[p]);
+      printf(" %10.1f", cHitPath(RS_FIFO, poolSizes[p], requests));
+      printf(" %10.1f", templateHitPath<bm::FifoBufferPool>(poolSizes[p], requests));
+      printf(" %10.1f", cHitPath(RS_LRU, poolSizes[p], requests));
+      printf(" %10.1f", templateHitPath<bm::LruBufferPool>(poolSizes[p], requests));
+      printf(" %10.1f", cHitPath(RS_CLOCK, poolSizes[p], requests));
+      printf(" %10.1f", templateHitPath<bm::ClockBufferPool>(poolSizes[p], requests));
+      printf("\n");
+    }
+
+  free(requests);
+  CHECK(destroyPageFile(BENCH_FILE));
+}
+
+/************************************************************
+ *                    page guards                           *
+ ************************************************************/
+
+// ns per request of raw pinPage / markDirty / unpinPage calls
+static double
+rawAccess (BM_BufferPool *bm, const int *requests, bool write, long *checksum)
+{
+  BM_PageHandle h;
+  double start = nowMs();
+  int i;
+
+  for (i = 0; i < HIT_REQUESTS; i++)
+    {
+      CHECK(pinPage(bm, &h, requests[i]));
+      if (write)
+        {
+          CHECK(markDirty(bm, &h));
+          ((int *) h.data)[1]++;
+        }
+      *checksum += ((int *) h.data)[1];
+      CHECK(unpinPage(bm, &h));
+    }
+  return (nowMs() - start) * 1000000.0 / HIT_REQUESTS;
+}
+
+// the same through guards and typed views
+static double
+guardedAccess (BM_BufferPool *bm, const int *requests, bool write, long *checksum)
+{
+  double start = nowMs();
+  int i;
+
+  for (i = 0; i < HIT_REQUESTS; i++)
+    {
+      if (write)
+        {
+          bm::WritePageGuard page;
+          CHECK(page.pin(bm, requests[i]));
+          bm::PageView<int> ints = page.view<int>();
+          ints[1]++;
+          *checksum += ints[1];
+        }
+      else
+        {
+          bm::PageGuard page;
+          CHECK(page.pin(bm, requests[i]));
+          *checksum += page.view<int>()[1];
+        }
+    }
+  return (nowMs() - start) * 1000000.0 / HIT_REQUESTS;
+}
+
+#define GUARD_ROUNDS 5
+
+// guards against the raw C calls they replace
+void
+benchGuard (void)
+{
+  const int poolSizes[] = { 16, 1024 };
+  int *requests = (int *) malloc(sizeof(int) * HIT_REQUESTS);
+  long rawSum, guardSum;
+  BM_BufferPool bm;
+  BM_PageHandle h;
+  int p, w, r, i;
+
+  createBenchFile(poolSizes[1]);
+  printf("ns per access of a resident page through the C interface (LRU), %d random hits\n",
+         HIT_REQUESTS);
+  printf("%-6s %-6s %10s %10s\n", "frames", "access", "raw calls", "guards");
+
+  for (p = 0; p < 2; p++)
+    {
+      randomState = 2463534242u;
+      for (i = 0; i < HIT_REQUESTS; i++)
+        requests[i] = nextRandom() % poolSizes[p];
+
+      CHECK(initBufferPool(&bm, BENCH_FILE, poolSizes[p], RS_LRU, NULL));
+      for (i = 0; i < poolSizes[p]; i++)
+        {
+          CHECK(pinPage(&bm, &h, i));
+          CHECK(unpinPage(&bm, &h));
+        }
+
+      for (w = 0; w < 2; w++)
+        {
+          // interleave the runs and keep the best of each, so noise hits both sides alike
+          double raw = 1e9, guarded = 1e9;
+          rawSum = guardSum = 0;
+          for (r = 0; r < GUARD_ROUNDS; r++)
+            {
+              raw = std::min(raw, rawAccess(&bm, requests, w == 1, &rawSum));
+              guarded = std::min(guarded, guardedAccess(&bm, requests, w == 1, &guardSum));
+            }
+          printf("%-6d %-6s %10.1f %10.1f\n", poolSizes[p], w ? "write" : "read", raw, guarded);
+          if (w == 0 && rawSum != guardSum)
+            printf("checksum mismatch\n");
+        }
+      CHECK(shutdownBufferPool(&bm));
+    }
+
+  free(requests);
+  CHECK(destroyPageFile(BENCH_FILE));
+}
+
+/************************************************************
+ *                    coroutine pins                        *
+ ************************************************************/
+
+#define CORO_FILE_PAGES 8192
+#define CORO_FRAMES 2048
+#define CORO_REQUESTS 262144
+// emulated device: every read call waits this long, on fewer requests
+#define CORO_READ_LATENCY 200
+#define CORO_LATENCY_REQUESTS 4096
+
+// sums the first int of each requested page
+static bm::Task
+coroRequests (bm::AsyncBufferPool<bm::LruPolicy> &pool, const int *requests, int n, long *checksum)
+{
+  int i;
+
+  for (i = 0; i < n; i++)
+    {
+      bm::PinResult pin = co_await pool.pin(requests[i]);
+      CHECK(pin.rc);
+      *checksum += ((int *) pin.ref.data)[0];
+      CHECK(pool.unpin(pin.ref));
+    }
+}
+
+// ms for the requests split over numTasks coroutines and numThreads I/O threads
+static double
+coroRun (const int *requests, int numRequests, int numTasks, int numThreads, long *checksum,
+         int *suspended)
+{
+  bm::Executor executor;
+  bm::IoThreadPool io(numThreads);
+  bm::AsyncBufferPool<bm::LruPolicy> pool(executor, io);
+  int perTask = numRequests / numTasks;
+  double start;
+  int t;
+
+  CHECK(pool.init(BENCH_FILE, CORO_FRAMES));
+  start = nowMs();
+  for (t = 0; t < numTasks; t++)
+    executor.spawn(coroRequests(pool, requests + t * perTask, perTask, checksum));
+  executor.run();
+  start = nowMs() - start;
+  *suspended = pool.numSuspendedPins();
+  CHECK(pool.shutdown());
+  return start;
+}
+
+// the same requests pinned one after another
+static double
+syncRun (const int *requests, int numRequests, long *checksum)
+{
+  bm::LruBufferPool pool;
+  bm::PageRef ref;
+  double start;
+  int i;
+
+  CHECK(pool.init(BENCH_FILE, CORO_FRAMES));
+  start = nowMs();
+  for (i = 0; i < numRequests; i++)
+    {
+      CHECK(pool.pin(requests[i], ref));
+      *checksum += ((int *) ref.data)[0];
+      CHECK(pool.unpin(ref));
+    }
+  start = nowMs() - start;
+  CHECK(pool.shutdown());
+  return start;
+}
+
+// one table of the synchronous loop and every task and I/O thread count
+static void
+coroTable (const int *requests, int numRequests)
+{
+  const int tasks[] = { 16, 256, 2048 };
+  const int threads[] = { 1, 4 };
+  long syncSum = 0, coroSum;
+  int t, k, suspended;
+  double ms;
+
+  printf("%-6s %-10s %10s %12s %10s\n", "tasks", "io threads", "ms", "pins/ms", "suspended");
+  ms = syncRun(requests, numRequests, &syncSum);
+  printf("%-6s %-10s %10.1f %12.1f %10s\n", "sync", "-", ms, numRequests / ms, "-");
+
+  for (t = 0; t < 3; t++)
+    for (k = 0; k < 2; k++)
+      {
+        coroSum = 0;
+        ms = coroRun(requests, numRequests, tasks[t], threads[k], &coroSum, &suspended);
+        printf("%-6d %-10d %10.1f %12.1f %10d\n", tasks[t], threads[k], ms,
+               numRequests / ms, suspended);
+        if (coroSum != syncSum)
+          printf("checksum mismatch\n");
+      }
+}
+
+// thousands of concurrent requests on one executor thread against a
+// synchronous loop; each task holds at most one pin, so the pool has a
+// frame for every task. Reads come from the page cache first, then wait
+// CORO_READ_LATENCY us each like reads of a device would
+void
+benchCoro (void)
+{
+  int *requests = (int *) malloc(sizeof(int) * CORO_REQUESTS);
+  SM_FileHandle fh;
+  char page[PAGE_SIZE];
+  int i;
+
+  createBenchFile(CORO_FILE_PAGES);
+  CHECK(openPageFile(BENCH_FILE, &fh));
+  memset(page, 0, PAGE_SIZE);
+  for (i = 0; i < CORO_FILE_PAGES; i++)
+    {
+      ((int *) page)[0] = i;
+      CHECK(writeBlock(i, &fh, page));
+    }
+  CHECK(closePageFile(&fh));
+
+  randomState = 2463534242u;
+  for (i = 0; i < CORO_REQUESTS; i++)
+    requests[i] = nextRandom() % CORO_FILE_PAGES;
+
+  printf("%d random pins over %d pages, %d frames (LRU), file in the page cache\n",
+         CORO_REQUESTS, CORO_FILE_PAGES, CORO_FRAMES);
+  coroTable(requests, CORO_REQUESTS);
+
+  printf("\n%d random pins, %d us per read call\n", CORO_LATENCY_REQUESTS, CORO_READ_LATENCY);
+  setReadLatency(CORO_READ_LATENCY);
+  coroTable(requests, CORO_LATENCY_REQUESTS);
+  setReadLatency(0);
+
+  free(requests);
+  CHECK(destroyPageFile(BENCH_FILE));
+}
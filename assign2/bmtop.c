@@ -0,0 +1,184 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "buffer_mgr.h"
+#include "pool_stats.h"
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// live view of the statistics segments of running buffer pools; every
+// interval it prints one line per pool with the rates since the last one
+
+typedef struct Monitor {
+  const char *name;
+  const PoolStats *stats;
+  PoolStats last;
+} Monitor;
+
+static const char *strategyName (int64_t strategy);
+static void sleepMs (int ms);
+static void printHeader (void);
+static int printPool (Monitor *m, double seconds);
+
+int
+main (int argc, char *argv[])
+{
+  Monitor *monitors;
+  int intervalMs = 1000, count = 0;
+  int numMonitors = 0, refresh, i, opt, badOption = 0;
+  int clear = isatty(STDOUT_FILENO);
+
+  while ((opt = getopt(argc, argv, "i:n:")) != -1)
+    {
+      if (opt == 'i' && atoi(optarg) > 0)
+        intervalMs = atoi(optarg);
+      else if (opt == 'n' && atoi(optarg) > 0)
+        count = atoi(optarg);
+      else
+        badOption = 1;
+    }
+  if (badOption || optind >= argc)
+    {
+      fprintf(stderr, "usage: %s [-i interval_ms] [-n refreshes] name...\n"
+              "  name: statistics segment of a pool (BM_PoolOptions.statsName)\n", argv[0]);
+      return 2;
+    }
+
+  monitors = malloc(sizeof(Monitor) * (argc - optind));
+  for (i = optind; i < argc; i++)
+    {
+      Monitor *m = &monitors[numMonitors];
+      m->name = argv[i];
+      m->stats = openPoolStats(argv[i]);
+      if (m->stats == NULL)
+        {
+          fprintf(stderr, "%s: no pool statistics under %s\n", argv[0], argv[i]);
+          continue;
+        }
+      snapshotPoolStats(m->stats, &m->last);
+      numMonitors++;
+    }
+  if (numMonitors == 0)
+    return 1;
+
+  for (refresh = 0; count == 0 || refresh < count; refresh++)
+    {
+      int running = 0;
+
+      sleepMs(intervalMs);
+      if (clear)
+        printf("\033[H\033[2J");
+      else if (refresh > 0)
+        printf("\n");
+      printHeader();
+      for (i = 0; i < numMonitors; i++)
+        running += printPool(&monitors[i], intervalMs / 1000.0);
+      fflush(stdout);
+      if (running == 0)
+        break;
+    }
+
+  for (i = 0; i < numMonitors; i++)
+    closePoolStats(monitors[i].stats);
+  free(monitors);
+  return 0;
+}
+
+const char *
+strategyName (int64_t strategy)
+{
+  switch (strategy)
+    {
+    case RS_FIFO:
+      return "FIFO";
+    case RS_LRU:
+      return "LRU";
+    case RS_CLOCK:
+      return "CLOCK";
+    case RS_GCLOCK:
+      return "GCLOCK";
+    case RS_CLOCK_PRO:
+      return "CLOCK-Pro";
+    case RS_LIRS:
+      return "LIRS";
+    case RS_SIEVE:
+      return "SIEVE";
+    case RS_CUSTOM:
+      return "custom";
+    default:
+      return "?";
+    }
+}
+
+void
+sleepMs (int ms)
+{
+  struct timespec ts;
+  ts.tv_sec = ms / 1000;
+  ts.tv_nsec = (ms % 1000) * 1000000L;
+  while (nanosleep(&ts, &ts) != 0 && errno == EINTR)
+    ;
+}
+
+void
+printHeader (void)
+{
+  printf("%-16s %7s %-9s %7s %6s %9s %6s %7s %7s %9s %8s %8s %11s %11s\n", "POOL", "PID",
+         "STRATEGY", "FRAMES", "STATE", "PINS/S", "HIT%", "DIRTY", "PINNED", "EVICT/S",
+         "READS/S", "WRITES/S", "READ p50/99", "WRITE p50/99");
+}
+
+// print the rates since the last refresh; returns whether the pool still runs
+int
+printPool (Monitor *m, double seconds)
+{
+  PoolStats now;
+  uint64_t readDelta[LATENCY_BUCKETS], writeDelta[LATENCY_BUCKETS];
+  uint64_t pins, hits;
+  char hitRatio[16], readLatency[32], writeLatency[32];
+  const char *state = "run";
+  int i;
+
+  snapshotPoolStats(m->stats, &now);
+  if (now.closed)
+    state = "closed";
+  else if (kill((pid_t) now.pid, 0) != 0 && errno == ESRCH)
+    state = "dead";
+
+  hits = now.hits - m->last.hits;
+  pins = hits + now.misses - m->last.misses;
+  for (i = 0; i < LATENCY_BUCKETS; i++)
+    {
+      readDelta[i] = now.readLatency[i] - m->last.readLatency[i];
+      writeDelta[i] = now.writeLatency[i] - m->last.writeLatency[i];
+    }
+
+  strcpy(hitRatio, "-");
+  if (pins > 0)
+    snprintf(hitRatio, sizeof(hitRatio), "%.1f", 100.0 * hits / pins);
+  strcpy(readLatency, "-");
+  if (latencyPercentile(readDelta, 0.5) > 0)
+    snprintf(readLatency, sizeof(readLatency), "%llu/%llu",
+             (unsigned long long) latencyPercentile(readDelta, 0.5),
+             (unsigned long long) latencyPercentile(readDelta, 0.99));
+  strcpy(writeLatency, "-");
+  if (latencyPercentile(writeDelta, 0.5) > 0)
+    snprintf(writeLatency, sizeof(writeLatency), "%llu/%llu",
+             (unsigned long long) latencyPercentile(writeDelta, 0.5),
+             (unsigned long long) latencyPercentile(writeDelta, 0.99));
+
+  printf("%-16s %7lld %-9s %7lld %6s %9.0f %6s %7llu %7llu %9.0f %8.0f %8.0f %11s %11s\n",
+         m->name, (long long) now.pid, strategyName(now.strategy), (long long) now.numFrames,
+         state, pins / seconds, hitRatio, (unsigned long long) now.dirtyFrames,
+         (unsigned long long) now.pinnedFrames, (now.evictions - m->last.evictions) / seconds,
+         (now.reads - m->last.reads) / seconds, (now.writes - m->last.writes) / seconds,
+         readLatency, writeLatency);
+
+  m->last = now;
+  return strcmp(state, "run") == 0;
+}
@@ -1,673 +1,4868 @@
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
 #include "buffer_mgr.h"
+#include "compressed_cache.h"
+#include "frame_scan.h"
+#include "frequency_sketch.h"
+#include "ghost_cache.h"
+#include "pool_stats.h"
+#include "replacement_policy.h"
 #include "storage_mgr.h"
+#include "trace_probes.h"
+#include "victim_cache.h"
+
+/* Version line at the top of a warm file */
+#define WARM_FILE_MAGIC "BMWARM 1"
+
+/* Maximum number of pages fetched by one read of the preload thread */
+#define PRELOAD_RUN_PAGES 64
+
+/* Unlisted pages the preload thread reads over to merge two nearby reads;
+ * a read syscall costs far more than copying a few extra pages */
+#define PRELOAD_MAX_GAP 8
+
+/* handleFrame result for a handle whose frame no longer holds its page */
+#define STALE_HANDLE (-2)
+
+/* Sector mask of a fully modified page */
+#define ALL_SECTORS ((1u << SECTORS_PER_PAGE) - 1)
+
+/* Number of 64-bit words of a bitmap with one bit per frame */
+#define BITMAP_WORDS(n) (((n) + 63) / 64)
+
+/* Alignment of each frame metadata array, one cache line */
+#define METADATA_ALIGN 64
+
+/* Size of the huge pages used for the frame area */
+#define HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+/* Upper bound on the NUMA nodes a pool is partitioned over */
+#define MAX_NUMA_NODES 64
+
+/* Calls of currentNumaNode() between two getcpu system calls of a thread */
+#define NUMA_NODE_REFRESH 256
+
+/* Memory policy of mbind(2), from <linux/mempolicy.h> */
+#define NUMA_MPOL_PREFERRED 1
+
+#if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+
+/* First field of a shared pool segment, "BMSHPOOL" */
+#define SHARED_MAGIC 0x4C4F4F5048534D42ULL
+
+/* Processes attached to one shared pool at a time */
+#define SHARED_MAX_PROCESSES 32
+
+/* Page files registered with a shared pool, and the longest name */
+#define SHARED_MAX_FILES 32
+#define SHARED_FILE_NAME_MAX 256
+
+/* Attempts, 1 ms apart, to attach while another process is creating or
+ * removing the segment */
+#define SHARED_ATTACH_ATTEMPTS 1000
+
+/* Page listed in a warm file and scheduled for preloading */
+typedef struct WarmEntry {
+    FileId fileId;
+    PageNumber pageNum;
+    int loaded;     /* Written by the loader thread before publishing numLoaded */
+    int skipped;    /* Written by the pool: page was read by a regular miss */
+} WarmEntry;
+
+/* Background preload of the pages listed in a warm file */
+typedef struct WarmLoader {
+    pthread_t thread;
+    pthread_mutex_t lock;
+    WarmEntry *entries;     /* Sorted by (fileId, pageNum) for sequential reads */
+    char *staging;          /* PAGE_SIZE bytes per entry */
+    char *runBuffer;        /* PRELOAD_RUN_PAGES pages for reads spanning gaps */
+    int freeHint;           /* Where the search for an empty frame resumes */
+    char **fileNames;       /* Private copies, indexed by FileId */
+    int numFiles;
+    int numEntries;
+    int numLoaded;          /* Entries handled by the loader thread, guarded by lock */
+    int numInstalled;       /* Entries handled by the pool */
+    int stop;               /* Guarded by lock */
+    int joined;             /* Thread already joined by finishPreload */
+} WarmLoader;
+
+/* Frames serving pages rejected by the admission filter */
+#define ADMISSION_BYPASS_FRAMES 4
+
+/* Frame outside the pool holding a page the admission filter rejected;
+ * it is released when the page is unpinned */
+typedef struct BypassFrame {
+    PageNumber pageNum;     /* NO_PAGE while free */
+    FileId fileId;
+    int fixCount;
+    int dirty;
+    char *data;
+} BypassFrame;
+
+/* TinyLFU admission filter */
+typedef struct Admission {
+    FrequencySketch sketch;
+    BypassFrame bypass[ADMISSION_BYPASS_FRAMES];
+    char *bypassData;       /* PAGE_SIZE bytes per bypass frame */
+    int numRejected;
+} Admission;
+
+/* Strategies an adaptive pool chooses from, in order of preference on ties */
+static const ReplacementStrategy adaptiveCandidates[] = { RS_FIFO, RS_LRU, RS_CLOCK };
+#define ADAPTIVE_CANDIDATES 3
+
+/* Pools of more than twice this many frames feed their shadow caches with
+ * a sample of 1 in 2^k pages, shrinking the shadows to at least this size */
+#define ADAPTIVE_SHADOW_FRAMES 64
+
+/* Sampled accesses per comparison window: this many per shadow frame, and
+ * at least ADAPTIVE_MIN_WINDOW */
+#define ADAPTIVE_WINDOW_FACTOR 8
+#define ADAPTIVE_MIN_WINDOW 256
+
+/* A competitor must beat the active strategy by more than 1/ADAPTIVE_MARGIN
+ * of a window's accesses in ADAPTIVE_SWITCH_WINDOWS windows in a row */
+#define ADAPTIVE_MARGIN 50
+#define ADAPTIVE_SWITCH_WINDOWS 2
+
+/* Runtime strategy selection: shadow caches of the candidates and the hits
+ * they scored in the current window */
+typedef struct Adaptive {
+    GhostCache shadows[ADAPTIVE_CANDIDATES];
+    uint64_t sampleMask;    /* Pages whose hash has these bits clear are sampled */
+    int windowSize;
+    int windowAccesses;
+    int windowHits[ADAPTIVE_CANDIDATES];
+    int leader;             /* Candidate ahead of the active one, -1 if none */
+    int leaderWindows;      /* Consecutive windows the leader was ahead */
+    int numSwitches;
+} Adaptive;
+
+/* Replacement policy of an RS_CUSTOM pool, with the view its callbacks get */
+typedef struct CustomPolicy {
+    BM_ReplacementPolicy policy;
+    BM_PolicyView view;
+} CustomPolicy;
+
+/* Bounded wait of pins that find every frame pinned. While a pool has one,
+ * its page operations hold the lock, so other threads can unpin pages */
+typedef struct PinWait {
+    pthread_mutex_t lock;
+    pthread_cond_t unpinned;    /* Broadcast when a frame becomes evictable */
+    int timeoutMs;
+} PinWait;
+
+/* Header of the POSIX shared memory segment of a pool shared by processes.
+ * It is followed by the frame metadata arrays, one row of per-frame pin
+ * counts per process slot and the page-aligned frames */
+typedef struct SharedHeader {
+    uint64_t magic;
+    int ready;                  /* Set by the creator once the segment is initialized */
+    int closed;                 /* Set by the last process before it removes the name */
+    int numFrames;
+    ReplacementStrategy strategy;
+    int maxUsageCount;
+    PinWait pinWait;            /* Process-shared robust lock and condition */
+    int recentHitCount;         /* LRU clock of all processes */
+    PoolPartition partition;    /* Replacement hands */
+    int numFiles;               /* Page file registry, file 0 is the pool's own */
+    char files[SHARED_MAX_FILES][SHARED_FILE_NAME_MAX];
+    pid_t processes[SHARED_MAX_PROCESSES];  /* Attached processes, 0 for free slots */
+    int numAttached;
+    int reclaimed;              /* Dead processes whose pins were given back */
+    int missFrame;              /* Frame a miss is refilling, -1 if none */
+} SharedHeader;
+
+/* A process's mapping of a shared pool segment */
+typedef struct SharedPool {
+    SharedHeader *header;
+    size_t size;
+    char *name;
+    int slot;                   /* Slot of this process, -1 when not attached */
+    int *allPins;               /* Pin rows of all slots, numFrames ints each */
+    int *pins;                  /* Row of this process */
+} SharedPool;
+
+/* Hash index over the entries of a replacement strategy, keyed by page;
+ * the strategies index their non-resident pages in it */
+typedef struct PageIndex {
+    int *buckets;           /* First entry of each bucket, -1 if none */
+    int *next;              /* Next entry of the same bucket, -1 at the end */
+    int bucketMask;
+} PageIndex;
+
+/* Flags of a CLOCK-Pro ring entry */
+#define CP_HOT 1
+#define CP_TEST 2       /* Cold page in its test period */
+
+/* CLOCK-Pro page ring: resident pages and non-resident cold pages still in
+ * their test period, stored as dense arrays indexed by entry */
+typedef struct ClockPro {
+    PageNumber *pages;      /* NO_PAGE for free entries */
+    FileId *files;
+    int *frames;            /* Frame of a resident page, -1 if non-resident */
+    int *prev;
+    int *next;              /* Ring neighbours; next also links free entries */
+    uint8_t *flags;
+    int *frameEntries;      /* Entry of each frame, -1 for empty frames */
+    PageIndex nonResident;
+    int capacity;
+    int freeList;
+    int handHot;            /* All hands are -1 while the ring is empty */
+    int handCold;
+    int handTest;
+    int numHot;
+    int numCold;            /* Resident cold pages */
+    int numNonResident;
+    int coldTarget;         /* Adaptive share of resident cold pages */
+} ClockPro;
+
+/* Flags of a LIRS entry */
+#define LIRS_LIR 1
+#define LIRS_STACKED 2  /* Entry is in the recency stack */
+
+/* LIRS state: the recency stack S holds LIR pages and recently used HIR
+ * pages, resident or not; resident HIR pages also wait in the queue Q.
+ * Non-resident HIR pages are additionally kept in eviction order so the
+ * stack can be pruned to one of them per frame */
+typedef struct Lirs {
+    PageNumber *pages;      /* NO_PAGE for free entries */
+    FileId *files;
+    int *frames;            /* Frame of a resident page, -1 if non-resident */
+    int *stackPrev;
+    int *stackNext;         /* Towards the top of S; also links free entries */
+    int *queuePrev;
+    int *queueNext;         /* Q for resident pages, eviction order otherwise */
+    uint8_t *flags;
+    int *frameEntries;      /* Entry of each frame, -1 for empty frames */
+    PageIndex nonResident;
+    int capacity;
+    int freeList;
+    int stackBottom;        /* Ends are -1 for empty lists */
+    int stackTop;
+    int queueHead;          /* Next resident HIR page to evict */
+    int queueTail;
+    int ghostHead;          /* Oldest non-resident HIR page */
+    int ghostTail;
+    int numLir;
+    int lirTarget;          /* Frames reserved for LIR pages */
+    int numNonResident;
+} Lirs;
 
 /* Forward declarations of page replacement strategy functions */
-static void FIFO(BM_BufferPool *const bm, FrameInfo *page);
-static void LRU(BM_BufferPool *const bm, FrameInfo *page);
-static void CLOCK(BM_BufferPool *const bm, FrameInfo *page);
+static int FIFO(BM_BufferPool *const bm, PoolPartition *part);
+static int LRU(BM_BufferPool *const bm, PoolPartition *part);
+static int CLOCK(BM_BufferPool *const bm, PoolPartition *part);
+static int GCLOCK(BM_BufferPool *const bm, PoolPartition *part);
+static int CLOCK_PRO(BM_BufferPool *const bm, PoolPartition *part);
+static void clockProInsert(BufferPoolInfo *poolInfo, int idx, bool filling);
+static void clockProEvict(BufferPoolInfo *poolInfo, int idx);
+static int LIRS(BM_BufferPool *const bm, PoolPartition *part);
+static int SIEVE(BM_BufferPool *const bm, PoolPartition *part);
+static void sieveInsert(BufferPoolInfo *poolInfo, int idx);
+static void sieveEvict(BufferPoolInfo *poolInfo, int idx);
+static void lirsHit(BufferPoolInfo *poolInfo, int idx);
+static void lirsInsert(BufferPoolInfo *poolInfo, int idx, bool mayBeLir);
+static void lirsEvict(BufferPoolInfo *poolInfo, int idx);
+static RC syncSharedFiles(BufferPoolInfo *poolInfo);
 
 /* Helper function to get buffer pool info */
 static inline BufferPoolInfo* getPoolInfo(BM_BufferPool *const bm) {
     return (BufferPoolInfo*)bm->mgmtData;
 }
 
+/* Helper function to get the open handle of a registered page file */
+static inline SM_FileHandle* getFileHandle(BufferPoolInfo *poolInfo, FileId fileId) {
+    /* Another process of a shared pool may have registered the file */
+    if (fileId >= poolInfo->numFiles && poolInfo->shared != NULL) {
+        syncSharedFiles(poolInfo);
+    }
+    if (fileId < 0 || fileId >= poolInfo->numFiles) {
+        return NULL;
+    }
+    return &poolInfo->files[fileId].fh;
+}
+
+/* Helper functions for per-frame bitmaps */
+static inline int testBit(const uint64_t *bits, int idx) {
+    return (int)((bits[idx >> 6] >> (idx & 63)) & 1);
+}
+
+static inline void setBit(uint64_t *bits, int idx) {
+    bits[idx >> 6] |= (uint64_t)1 << (idx & 63);
+}
+
+static inline void clearBit(uint64_t *bits, int idx) {
+    bits[idx >> 6] &= ~((uint64_t)1 << (idx & 63));
+}
+
+/* Mask of bits lo (inclusive) to hi (exclusive) of one word, 0 <= lo <= hi <= 64 */
+static inline uint64_t rangeMask(int lo, int hi) {
+    if (hi - lo == 64) {
+        return ~(uint64_t)0;
+    }
+    return (((uint64_t)1 << (hi - lo)) - 1) << lo;
+}
+
+/* Position of the lowest set bit of a non-zero word */
+static inline int lowestBit(uint64_t word) {
+#if defined(__GNUC__)
+    return __builtin_ctzll(word);
+#else
+    int pos = 0;
+    while ((word & 1) == 0) {
+        word >>= 1;
+        pos++;
+    }
+    return pos;
+#endif
+}
+
+/* Number of set bits of a sector mask */
+static inline int countBits(unsigned int mask) {
+#if defined(__GNUC__)
+    return __builtin_popcount(mask);
+#else
+    int count = 0;
+    for (; mask != 0; mask &= mask - 1) {
+        count++;
+    }
+    return count;
+#endif
+}
+
 /*
- * Initializes a new buffer pool
- * Creates a buffer pool with the specified number of page frames
- * @param bm - Pointer to buffer pool structure
- * @param pageFileName - Name of the page file to manage
- * @param numPages - Number of page frames in the buffer pool
- * @param strategy - Page replacement strategy to use
- * @param stratData - Strategy-specific data (unused)
- * @return RC_OK on success, error code otherwise
+ * Counts the set bits of a frame bitmap
  */
-extern RC initBufferPool(BM_BufferPool *const bm, const char *const pageFileName,
-                         const int numPages, ReplacementStrategy strategy, void *stratData)
+static int countFrames(const uint64_t *bits, int numFrames)
 {
-    if (bm == NULL) {
-        return RC_BUFF_POOL_NOT_FOUND;
+    int count = 0;
+    for (int w = 0; w < BITMAP_WORDS(numFrames); w++) {
+        count += countBits((unsigned int)bits[w]) + countBits((unsigned int)(bits[w] >> 32));
     }
+    return count;
+}
 
-    if (pageFileName == NULL) {
-        return RC_FILE_NOT_FOUND;
+/*
+ * Refreshes the dirty and pinned frame gauges of the statistics segment
+ */
+static void publishGauges(BufferPoolInfo *poolInfo)
+{
+    if (poolInfo->stats != NULL) {
+        statSet(&poolInfo->stats->dirtyFrames,
+                countFrames(poolInfo->dirtyBits, poolInfo->bufferSize));
+        statSet(&poolInfo->stats->pinnedFrames,
+                countFrames(poolInfo->pinnedBits, poolInfo->bufferSize));
     }
+}
 
-    if (numPages <= 0) {
-        return RC_ERROR;
+/*
+ * Counts a pin in the statistics segment, refreshing the gauges every
+ * POOL_STATS_GAUGE_PINS pins
+ * @param hit - Whether the page was already in the pool
+ */
+static inline void publishPin(BufferPoolInfo *poolInfo, bool hit)
+{
+    PoolStats *stats = poolInfo->stats;
+    if (stats != NULL) {
+        statAdd(hit ? &stats->hits : &stats->misses, 1);
+        if ((stats->hits + stats->misses) % POOL_STATS_GAUGE_PINS == 0) {
+            publishGauges(poolInfo);
+        }
     }
+}
 
-    /* Allocate and initialize buffer pool info structure */
-    BufferPoolInfo *poolInfo = (BufferPoolInfo*)malloc(sizeof(BufferPoolInfo));
-    if (poolInfo == NULL) {
-        return RC_ERROR;
+/* Start time of an I/O, 0 if the pool publishes no statistics */
+static inline uint64_t ioStart(const BufferPoolInfo *poolInfo) {
+    return (poolInfo->stats != NULL) ? poolStatsClock() : 0;
+}
+
+/*
+ * Counts a page read or write and its latency in the statistics segment
+ * @param start - Value of ioStart before the I/O
+ */
+static inline void publishIO(BufferPoolInfo *poolInfo, bool write, uint64_t start)
+{
+    PoolStats *stats = poolInfo->stats;
+    if (stats != NULL) {
+        statAdd(write ? &stats->writes : &stats->reads, 1);
+        recordLatency(write ? stats->writeLatency : stats->readLatency, poolStatsClock() - start);
     }
+}
 
-    /* Allocate page frames */
-    poolInfo->frames = (FrameInfo*)calloc(numPages, sizeof(FrameInfo));
-    if (poolInfo->frames == NULL) {
-        free(poolInfo);
-        return RC_ERROR;
+/* End of the run of frames starting at idx that shares idx's bitmap word */
+static inline int wordSegmentEnd(int idx, int limit) {
+    int wordEnd = (idx | 63) + 1;
+    return (wordEnd < limit) ? wordEnd : limit;
+}
+
+/* Helper function to get the memory of a frame */
+static inline char* frameData(BufferPoolInfo *poolInfo, int idx) {
+    return poolInfo->frameArea + (size_t)idx * PAGE_SIZE;
+}
+
+/* Helper functions to pin and unpin a frame */
+static inline void pinFrame(BufferPoolInfo *poolInfo, int idx) {
+    poolInfo->fixCounts[idx]++;
+    setBit(poolInfo->pinnedBits, idx);
+    if (poolInfo->shared != NULL) {
+        poolInfo->shared->pins[idx]++;
+    }
+}
+
+static inline void unpinFrame(BufferPoolInfo *poolInfo, int idx) {
+    if (poolInfo->shared != NULL && poolInfo->shared->pins[idx] > 0) {
+        poolInfo->shared->pins[idx]--;
     }
+    if (poolInfo->fixCounts[idx] > 0 && --poolInfo->fixCounts[idx] == 0) {
+        clearBit(poolInfo->pinnedBits, idx);
+    }
+}
 
-    /* Initialize all frames */
-    for (int i = 0; i < numPages; i++) {
-        poolInfo->frames[i].pageNumber = NO_PAGE;
-        poolInfo->frames[i].dirtybit = 0;
-        poolInfo->frames[i].accessCount = 0;
-        poolInfo->frames[i].secondChance = 0;
-        poolInfo->frames[i].recentHit = 0;
-        poolInfo->frames[i].index = 0;
-        poolInfo->frames[i].data = NULL;
+/*
+ * Finds the frame holding the given page of the given file
+ * Page numbers are compared with a vector kernel; the file id is only
+ * checked on candidate frames
+ * @return Frame index, or -1 if the page is not in the buffer
+ */
+static int findFrame(BufferPoolInfo *poolInfo, FileId fileId, PageNumber pageNum)
+{
+    int i = scanFindPage(poolInfo->pageNumbers, 0, poolInfo->bufferSize, pageNum);
+    while (i != -1 && poolInfo->fileIds[i] != fileId) {
+        i = scanFindPage(poolInfo->pageNumbers, i + 1, poolInfo->bufferSize, pageNum);
     }
+    return i;
+}
 
-    /* Initialize buffer pool metadata */
-    poolInfo->readCount = 0;
-    poolInfo->writeCount = 0;
-    poolInfo->recentHitCount = 0;
-    poolInfo->frameIndex = 0;
-    poolInfo->clockPointer = 0;
-    poolInfo->bufferSize = numPages;
+/*
+ * Finds the frame of a pinned page handle
+ * The generation recorded by the pin tells whether the frame still holds
+ * the residency that was pinned: a handle whose page was evicted, even if
+ * it was read again since, no longer holds a pin. Handles without a frame
+ * (frame -1), and handles whose pageNum or fileId the caller changed since
+ * the pin, are looked up
+ * @return Frame index, -1 if the page is not in the buffer, STALE_HANDLE
+ *         if the recorded frame received another page since the pin
+ */
+static int handleFrame(BufferPoolInfo *poolInfo, const BM_PageHandle *page)
+{
+    int idx = page->frame;
+    if (idx == -1 || page->pageNum != page->pinnedPageNum ||
+        page->fileId != page->pinnedFileId) {
+        return findFrame(poolInfo, page->fileId, page->pageNum);
+    }
+    if (idx < 0 || idx >= poolInfo->bufferSize ||
+        poolInfo->generations[idx] != page->generation) {
+        return STALE_HANDLE;
+    }
+    return idx;
+}
 
-    /* Set buffer pool attributes */
-    bm->pageFile = (char*)malloc(strlen(pageFileName) + 1);
-    if (bm->pageFile == NULL) {
-        free(poolInfo->frames);
-        free(poolInfo);
-        return RC_ERROR;
+/*
+ * Refreshes the page count of a handle of a shared pool from the file
+ * size, since other processes may have grown the file
+ */
+static void refreshPageCount(BufferPoolInfo *poolInfo, SM_FileHandle *fh)
+{
+    struct stat st;
+    if (poolInfo->shared != NULL && stat(fh->fileName, &st) == 0) {
+        fh->totalNumPages = (int)(st.st_size / PAGE_SIZE);
     }
-    strcpy(bm->pageFile, pageFileName);
+}
 
-    bm->numPages = numPages;
-    bm->strategy = strategy;
-    bm->mgmtData = poolInfo;
+/*
+ * Writes the contents of a frame back to its page file
+ * @return RC_OK on success, error code otherwise
+ */
+static RC writeBackFrame(BufferPoolInfo *poolInfo, int idx)
+{
+    SM_FileHandle *fh = getFileHandle(poolInfo, poolInfo->fileIds[idx]);
+    if (fh == NULL) {
+        return RC_FILE_HANDLE_NOT_INIT;
+    }
+    refreshPageCount(poolInfo, fh);
+
+    /* Pages modified through markDirtyRange only write their dirty sectors */
+    unsigned int sectors = poolInfo->dirtySectors[idx];
+    uint64_t start = ioStart(poolInfo);
+    uint64_t traceStart = TRACE_CLOCK();
+    RC result;
+    if (sectors != 0 && sectors != ALL_SECTORS) {
+        result = writeBlockSectors(poolInfo->pageNumbers[idx], sectors, fh, frameData(poolInfo, idx));
+    } else {
+        sectors = ALL_SECTORS;
+        result = writeBlock(poolInfo->pageNumbers[idx], fh, frameData(poolInfo, idx));
+    }
+    if (result != RC_OK) {
+        return RC_WRITE_FAILED;
+    }
 
+    long written = (long)countBits(sectors) * SECTOR_SIZE;
+    TRACE_WRITE_BACK(poolInfo->fileIds[idx], poolInfo->pageNumbers[idx], idx, written,
+                     TRACE_CLOCK() - traceStart);
+    clearBit(poolInfo->dirtyBits, idx);
+    poolInfo->dirtySectors[idx] = 0;
+    poolInfo->writeCount++;
+    publishIO(poolInfo, true, start);
+    poolInfo->bytesWritten += written;
+    poolInfo->bytesSaved += PAGE_SIZE - written;
     return RC_OK;
 }
 
+/* Rounds a size up to the alignment of the frame metadata arrays */
+static inline size_t alignMetadata(size_t size) {
+    return (size + METADATA_ALIGN - 1) / METADATA_ALIGN * METADATA_ALIGN;
+}
+
+/* Size of the block holding the frame metadata arrays of n frames */
+static size_t frameMetadataSize(size_t n)
+{
+    size_t bitmapSize = alignMetadata(BITMAP_WORDS(n) * sizeof(uint64_t));
+    return alignMetadata(n * sizeof(PageNumber)) + alignMetadata(n * sizeof(FileId)) +
+           4 * alignMetadata(n * sizeof(int)) + 2 * alignMetadata(n * sizeof(unsigned int)) +
+           alignMetadata(n * sizeof(uint8_t)) +
+           4 * bitmapSize;
+}
+
 /*
- * Shuts down the buffer pool
- * Writes all dirty pages to disk and frees all resources
- * @param bm - Pointer to buffer pool
- * @return RC_OK on success, error code otherwise
+ * Points the frame metadata arrays into a block of frameMetadataSize bytes,
+ * each array starting on its own cache line
  */
-extern RC shutdownBufferPool(BM_BufferPool *const bm)
+static void placeFrameMetadata(BufferPoolInfo *poolInfo, char *block)
 {
-    if (bm == NULL) {
-        return RC_BUFF_POOL_NOT_FOUND;
+    size_t n = (size_t)poolInfo->bufferSize;
+    size_t bitmapSize = alignMetadata(BITMAP_WORDS(n) * sizeof(uint64_t));
+
+    char *next = block;
+    poolInfo->pageNumbers = (PageNumber*)next;
+    next += alignMetadata(n * sizeof(PageNumber));
+    poolInfo->fileIds = (FileId*)next;
+    next += alignMetadata(n * sizeof(FileId));
+    poolInfo->fixCounts = (int*)next;
+    next += alignMetadata(n * sizeof(int));
+    poolInfo->generations = (unsigned int*)next;
+    next += alignMetadata(n * sizeof(unsigned int));
+    poolInfo->dirtySectors = (unsigned int*)next;
+    next += alignMetadata(n * sizeof(unsigned int));
+    poolInfo->recentHits = (int*)next;
+    next += alignMetadata(n * sizeof(int));
+    poolInfo->usageCounts = (uint8_t*)next;
+    next += alignMetadata(n * sizeof(uint8_t));
+    poolInfo->newerFrames = (int*)next;
+    next += alignMetadata(n * sizeof(int));
+    poolInfo->olderFrames = (int*)next;
+    next += alignMetadata(n * sizeof(int));
+    poolInfo->refBits = (uint64_t*)next;
+    next += bitmapSize;
+    poolInfo->keepBits = (uint64_t*)next;
+    next += bitmapSize;
+    poolInfo->dirtyBits = (uint64_t*)next;
+    next += bitmapSize;
+    poolInfo->pinnedBits = (uint64_t*)next;
+}
+
+/* Marks every frame of freshly zeroed frame metadata empty */
+static void markFramesEmpty(BufferPoolInfo *poolInfo)
+{
+    for (int i = 0; i < poolInfo->bufferSize; i++) {
+        poolInfo->pageNumbers[i] = NO_PAGE;
+        poolInfo->fileIds[i] = DEFAULT_FILE_ID;
     }
+}
 
-    BufferPoolInfo *poolInfo = getPoolInfo(bm);
-    if (poolInfo == NULL) {
+/*
+ * Allocates the frame metadata arrays in one block and marks every frame empty
+ * @return RC_OK on success, RC_ERROR if memory allocation fails
+ */
+static RC allocFrameMetadata(BufferPoolInfo *poolInfo)
+{
+    size_t size = frameMetadataSize((size_t)poolInfo->bufferSize);
+
+    void *block = NULL;
+    if (posix_memalign(&block, METADATA_ALIGN, size) != 0) {
         return RC_ERROR;
     }
+    memset(block, 0, size);
 
-    /* Flush all dirty pages */
-    RC result = forceFlushPool(bm);
-    if (result != RC_OK) {
-        return result;
+    placeFrameMetadata(poolInfo, (char*)block);
+    markFramesEmpty(poolInfo);
+    poolInfo->frameMetadata = block;
+    return RC_OK;
+}
+
+/*
+ * Number of buckets of a page index for up to n pages: the next power of two
+ */
+static int pageIndexBuckets(int n)
+{
+    int numBuckets = 1;
+    while (numBuckets < n) {
+        numBuckets <<= 1;
     }
+    return numBuckets;
+}
 
-    /* Check for pinned pages */
-    for (int i = 0; i < poolInfo->bufferSize; i++) {
-        if (poolInfo->frames[i].accessCount != 0) {
-            return RC_PINNED_PAGES_IN_BUFFER;
-        }
+/*
+ * Empties a page index whose arrays are in place
+ */
+static void initPageIndex(PageIndex *index, int numBuckets)
+{
+    index->bucketMask = numBuckets - 1;
+    for (int b = 0; b < numBuckets; b++) {
+        index->buckets[b] = -1;
     }
+}
 
-    /* Free all frame data */
-    for (int i = 0; i < poolInfo->bufferSize; i++) {
-        if (poolInfo->frames[i].data != NULL) {
-            free(poolInfo->frames[i].data);
+/*
+ * Bucket of a page key (splitmix64 finalizer)
+ */
+static inline int pageIndexBucket(const PageIndex *index, FileId fileId, PageNumber pageNum)
+{
+    uint64_t h = ((uint64_t)(uint32_t)fileId << 32) | (uint32_t)pageNum;
+    h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+    h ^= h >> 31;
+    return (int)(h & (uint64_t)index->bucketMask);
+}
+
+/*
+ * Finds the indexed entry of a page
+ * @param pages - Page of each entry
+ * @param files - File of each entry
+ * @return Entry, -1 if the page is not indexed
+ */
+static int pageIndexFind(const PageIndex *index, const PageNumber *pages, const FileId *files,
+                         FileId fileId, PageNumber pageNum)
+{
+    for (int e = index->buckets[pageIndexBucket(index, fileId, pageNum)]; e != -1;
+         e = index->next[e]) {
+        if (pages[e] == pageNum && files[e] == fileId) {
+            return e;
         }
     }
+    return -1;
+}
 
-    /* Free pool resources */
-    free(poolInfo->frames);
-    free(poolInfo);
-    free(bm->pageFile);
+/* Adds an entry to the index under a page */
+static void pageIndexAdd(PageIndex *index, int e, FileId fileId, PageNumber pageNum)
+{
+    int bucket = pageIndexBucket(index, fileId, pageNum);
+    index->next[e] = index->buckets[bucket];
+    index->buckets[bucket] = e;
+}
 
-    bm->mgmtData = NULL;
+/* Removes an entry indexed under a page */
+static void pageIndexRemove(PageIndex *index, int e, FileId fileId, PageNumber pageNum)
+{
+    int *link = &index->buckets[pageIndexBucket(index, fileId, pageNum)];
+    while (*link != e) {
+        link = &index->next[*link];
+    }
+    *link = index->next[e];
+}
+
+/*
+ * Allocates the CLOCK-Pro ring, with room for one resident and one
+ * non-resident page per frame, and the index of its non-resident pages
+ * @return RC_OK on success, RC_ERROR if out of memory
+ */
+static RC allocClockPro(BufferPoolInfo *poolInfo)
+{
+    ClockPro *cp = (ClockPro*)calloc(1, sizeof(ClockPro));
+    if (cp == NULL) {
+        return RC_ERROR;
+    }
+
+    int n = poolInfo->bufferSize;
+    cp->capacity = 2 * n;
+    size_t cap = (size_t)cp->capacity;
+    int numBuckets = pageIndexBuckets(n);
+    char *block = (char*)malloc(cap * (sizeof(PageNumber) + sizeof(FileId) + 4 * sizeof(int) +
+                                       sizeof(uint8_t)) + (size_t)(n + numBuckets) * sizeof(int));
+    if (block == NULL) {
+        free(cp);
+        return RC_ERROR;
+    }
+
+    cp->pages = (PageNumber*)block;
+    cp->files = (FileId*)(cp->pages + cap);
+    cp->frames = (int*)(cp->files + cap);
+    cp->prev = cp->frames + cap;
+    cp->next = cp->prev + cap;
+    cp->frameEntries = cp->next + cap;
+    cp->nonResident.next = cp->frameEntries + n;
+    cp->nonResident.buckets = cp->nonResident.next + cap;
+    cp->flags = (uint8_t*)(cp->nonResident.buckets + numBuckets);
+    initPageIndex(&cp->nonResident, numBuckets);
+
+    for (int e = 0; e < cp->capacity; e++) {
+        cp->pages[e] = NO_PAGE;
+        cp->next[e] = (e + 1 < cp->capacity) ? e + 1 : -1;
+    }
+    for (int i = 0; i < n; i++) {
+        cp->frameEntries[i] = -1;
+    }
+    cp->freeList = 0;
+    cp->handHot = cp->handCold = cp->handTest = -1;
+    cp->coldTarget = 1;
 
+    poolInfo->clockPro = cp;
     return RC_OK;
 }
 
 /*
- * Writes all dirty pages (not pinned) to disk
- * @param bm - Pointer to buffer pool
- * @return RC_OK on success, error code otherwise
+ * Frees the CLOCK-Pro ring, if any
  */
-extern RC forceFlushPool(BM_BufferPool *const bm)
+static void freeClockPro(BufferPoolInfo *poolInfo)
 {
-    if (bm == NULL) {
-        return RC_BUFF_POOL_NOT_FOUND;
+    if (poolInfo->clockPro != NULL) {
+        free(poolInfo->clockPro->pages);
+        free(poolInfo->clockPro);
+        poolInfo->clockPro = NULL;
     }
+}
 
-    BufferPoolInfo *poolInfo = getPoolInfo(bm);
-    if (poolInfo == NULL) {
+/*
+ * Allocates the LIRS stack and queue, with room for one resident and one
+ * non-resident page per frame, and the index of the non-resident pages;
+ * about 1% of the frames hold HIR pages
+ * @return RC_OK on success, RC_ERROR if out of memory
+ */
+static RC allocLirs(BufferPoolInfo *poolInfo)
+{
+    Lirs *lirs = (Lirs*)calloc(1, sizeof(Lirs));
+    if (lirs == NULL) {
         return RC_ERROR;
     }
 
-    SM_FileHandle fh;
-    if (openPageFile(bm->pageFile, &fh) != RC_OK) {
-        return RC_FILE_NOT_FOUND;
+    int n = poolInfo->bufferSize;
+    lirs->capacity = 2 * n;
+    size_t cap = (size_t)lirs->capacity;
+    int numBuckets = pageIndexBuckets(n);
+    char *block = (char*)malloc(cap * (sizeof(PageNumber) + sizeof(FileId) + 6 * sizeof(int) +
+                                       sizeof(uint8_t)) + (size_t)(n + numBuckets) * sizeof(int));
+    if (block == NULL) {
+        free(lirs);
+        return RC_ERROR;
     }
 
-    /* Write all dirty, unpinned pages */
-    for (int i = 0; i < poolInfo->bufferSize; i++) {
-        if (poolInfo->frames[i].dirtybit && poolInfo->frames[i].accessCount == 0) {
-            if (writeBlock(poolInfo->frames[i].pageNumber, &fh,
-                          poolInfo->frames[i].data) != RC_OK) {
-                closePageFile(&fh);
-                return RC_WRITE_FAILED;
-            }
-            poolInfo->frames[i].dirtybit = 0;
-            poolInfo->writeCount++;
-        }
+    lirs->pages = (PageNumber*)block;
+    lirs->files = (FileId*)(lirs->pages + cap);
+    lirs->frames = (int*)(lirs->files + cap);
+    lirs->stackPrev = lirs->frames + cap;
+    lirs->stackNext = lirs->stackPrev + cap;
+    lirs->queuePrev = lirs->stackNext + cap;
+    lirs->queueNext = lirs->queuePrev + cap;
+    lirs->frameEntries = lirs->queueNext + cap;
+    lirs->nonResident.next = lirs->frameEntries + n;
+    lirs->nonResident.buckets = lirs->nonResident.next + cap;
+    lirs->flags = (uint8_t*)(lirs->nonResident.buckets + numBuckets);
+    initPageIndex(&lirs->nonResident, numBuckets);
+
+    for (int e = 0; e < lirs->capacity; e++) {
+        lirs->pages[e] = NO_PAGE;
+        lirs->stackNext[e] = (e + 1 < lirs->capacity) ? e + 1 : -1;
+    }
+    for (int i = 0; i < n; i++) {
+        lirs->frameEntries[i] = -1;
     }
+    lirs->freeList = 0;
+    lirs->stackBottom = lirs->stackTop = -1;
+    lirs->queueHead = lirs->queueTail = -1;
+    lirs->ghostHead = lirs->ghostTail = -1;
+    lirs->lirTarget = (n > 1) ? n - ((n / 100 > 1) ? n / 100 : 1) : 0;
 
-    closePageFile(&fh);
+    poolInfo->lirs = lirs;
     return RC_OK;
 }
 
 /*
- * Marks a page as dirty
- * @param bm - Pointer to buffer pool
- * @param page - Page handle to mark as dirty
- * @return RC_OK on success, error code otherwise
+ * Frees the LIRS stack and queue, if any
  */
-extern RC markDirty(BM_BufferPool *const bm, BM_PageHandle *const page)
+static void freeLirs(BufferPoolInfo *poolInfo)
 {
-    if (bm == NULL) {
-        return RC_BUFF_POOL_NOT_FOUND;
+    if (poolInfo->lirs != NULL) {
+        free(poolInfo->lirs->pages);
+        free(poolInfo->lirs);
+        poolInfo->lirs = NULL;
     }
+}
 
-    if (page == NULL) {
+/*
+ * Allocates the TinyLFU admission filter and its bypass frames
+ * @return RC_OK on success, RC_ERROR if out of memory
+ */
+static RC allocAdmission(BufferPoolInfo *poolInfo)
+{
+    Admission *admission = (Admission*)calloc(1, sizeof(Admission));
+    if (admission == NULL) {
         return RC_ERROR;
     }
 
-    BufferPoolInfo *poolInfo = getPoolInfo(bm);
-    if (poolInfo == NULL) {
+    admission->bypassData = (char*)malloc((size_t)ADMISSION_BYPASS_FRAMES * PAGE_SIZE);
+    if (admission->bypassData == NULL ||
+        initFrequencySketch(&admission->sketch, poolInfo->bufferSize) != 0) {
+        free(admission->bypassData);
+        free(admission);
         return RC_ERROR;
     }
 
-    /* Find and mark the page as dirty */
-    for (int i = 0; i < poolInfo->bufferSize; i++) {
-        if (poolInfo->frames[i].pageNumber == page->pageNum) {
-            poolInfo->frames[i].dirtybit = 1;
-            return RC_OK;
-        }
+    for (int i = 0; i < ADMISSION_BYPASS_FRAMES; i++) {
+        admission->bypass[i].pageNum = NO_PAGE;
+        admission->bypass[i].data = admission->bypassData + (size_t)i * PAGE_SIZE;
+    }
+
+    poolInfo->admission = admission;
+    return RC_OK;
+}
+
+/*
+ * Frees the admission filter, if any
+ */
+static void freeAdmission(BufferPoolInfo *poolInfo)
+{
+    if (poolInfo->admission != NULL) {
+        freeFrequencySketch(&poolInfo->admission->sketch);
+        free(poolInfo->admission->bypassData);
+        free(poolInfo->admission);
+        poolInfo->admission = NULL;
+    }
+}
+
+/* Sketch key of a page */
+static inline uint64_t pageKey(FileId fileId, PageNumber pageNum) {
+    return ((uint64_t)(uint32_t)fileId << 32) | (uint32_t)pageNum;
+}
+
+/*
+ * Allocates the shadow caches of an adaptive pool
+ * @return RC_OK on success, RC_ERROR if out of memory
+ */
+static RC allocAdaptive(BufferPoolInfo *poolInfo)
+{
+    Adaptive *adaptive = (Adaptive*)calloc(1, sizeof(Adaptive));
+    if (adaptive == NULL) {
+        return RC_ERROR;
+    }
+
+    int sampleRate = 1;
+    while (poolInfo->bufferSize / (sampleRate * 2) >= ADAPTIVE_SHADOW_FRAMES) {
+        sampleRate *= 2;
+    }
+    int shadowFrames = poolInfo->bufferSize / sampleRate;
+
+    for (int c = 0; c < ADAPTIVE_CANDIDATES; c++) {
+        if (initGhostCache(&adaptive->shadows[c], adaptiveCandidates[c], shadowFrames) != 0) {
+            while (--c >= 0) {
+                freeGhostCache(&adaptive->shadows[c]);
+            }
+            free(adaptive);
+            return RC_ERROR;
+        }
+    }
+
+    adaptive->sampleMask = (uint64_t)sampleRate - 1;
+    adaptive->windowSize = shadowFrames * ADAPTIVE_WINDOW_FACTOR;
+    if (adaptive->windowSize < ADAPTIVE_MIN_WINDOW) {
+        adaptive->windowSize = ADAPTIVE_MIN_WINDOW;
+    }
+    adaptive->leader = -1;
+
+    poolInfo->adaptive = adaptive;
+    return RC_OK;
+}
+
+/*
+ * Frees the shadow caches of an adaptive pool, if any
+ */
+static void freeAdaptive(BufferPoolInfo *poolInfo)
+{
+    if (poolInfo->adaptive != NULL) {
+        for (int c = 0; c < ADAPTIVE_CANDIDATES; c++) {
+            freeGhostCache(&poolInfo->adaptive->shadows[c]);
+        }
+        free(poolInfo->adaptive);
+        poolInfo->adaptive = NULL;
+    }
+}
+
+/*
+ * Feeds a sampled access to the shadow caches; at the end of each window,
+ * switches the pool to a candidate that consistently scored more hits than
+ * the active strategy
+ * @param bm - Pointer to buffer pool
+ * @param poolInfo - Pool information of bm
+ * @param fileId - File of the accessed page
+ * @param pageNum - Accessed page
+ */
+static void adaptiveAccess(BM_BufferPool *const bm, BufferPoolInfo *poolInfo,
+                           FileId fileId, PageNumber pageNum)
+{
+    Adaptive *adaptive = poolInfo->adaptive;
+
+    /* Spatial sampling: every access to a sampled page, none to the others */
+    uint64_t h = pageKey(fileId, pageNum);
+    h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+    h ^= h >> 31;
+    if ((h & adaptive->sampleMask) != 0) {
+        return;
+    }
+
+    PageNumber key = (PageNumber)(h >> 33);
+    for (int c = 0; c < ADAPTIVE_CANDIDATES; c++) {
+        if (accessGhostCache(&adaptive->shadows[c], key)) {
+            adaptive->windowHits[c]++;
+        }
+    }
+    if (++adaptive->windowAccesses < adaptive->windowSize) {
+        return;
+    }
+
+    int active = 0;
+    while (adaptiveCandidates[active] != bm->strategy) {
+        active++;
+    }
+    int best = active;
+    for (int c = 0; c < ADAPTIVE_CANDIDATES; c++) {
+        if (adaptive->windowHits[c] > adaptive->windowHits[best]) {
+            best = c;
+        }
+    }
+
+    if (best != active &&
+        adaptive->windowHits[best] - adaptive->windowHits[active] >
+        adaptive->windowSize / ADAPTIVE_MARGIN) {
+        adaptive->leaderWindows = (best == adaptive->leader) ? adaptive->leaderWindows + 1 : 1;
+        adaptive->leader = best;
+    } else {
+        adaptive->leader = -1;
+        adaptive->leaderWindows = 0;
+    }
+
+    if (adaptive->leaderWindows >= ADAPTIVE_SWITCH_WINDOWS) {
+        bm->strategy = adaptiveCandidates[best];
+        adaptive->numSwitches++;
+        adaptive->leader = -1;
+        adaptive->leaderWindows = 0;
+    }
+
+    adaptive->windowAccesses = 0;
+    for (int c = 0; c < ADAPTIVE_CANDIDATES; c++) {
+        adaptive->windowHits[c] = 0;
+    }
+}
+
+/*
+ * Sets up the policy of an RS_CUSTOM pool and its zeroed state
+ * @param policy - Policy passed as stratData
+ * @return RC_OK on success, RC_ERROR if out of memory
+ */
+static RC allocCustomPolicy(BufferPoolInfo *poolInfo, const BM_ReplacementPolicy *policy)
+{
+    CustomPolicy *custom = (CustomPolicy*)calloc(1, sizeof(CustomPolicy));
+    if (custom == NULL) {
+        return RC_ERROR;
+    }
+
+    /* Allocate at least one byte, so NULL always means out of memory */
+    custom->view.frameState = (char*)calloc((size_t)poolInfo->bufferSize * policy->frameStateSize + 1, 1);
+    custom->view.poolState = calloc(policy->poolStateSize + 1, 1);
+    if (custom->view.frameState == NULL || custom->view.poolState == NULL) {
+        free(custom->view.frameState);
+        free(custom->view.poolState);
+        free(custom);
+        return RC_ERROR;
+    }
+
+    custom->policy = *policy;
+    custom->view.numFrames = poolInfo->bufferSize;
+    custom->view.fixCounts = poolInfo->fixCounts;
+    custom->view.pageNumbers = poolInfo->pageNumbers;
+    custom->view.fileIds = poolInfo->fileIds;
+    custom->view.frameStateSize = policy->frameStateSize;
+    custom->view.policyData = policy->policyData;
+
+    poolInfo->custom = custom;
+    return RC_OK;
+}
+
+/*
+ * Frees the policy state of an RS_CUSTOM pool, if any
+ */
+static void freeCustomPolicy(BufferPoolInfo *poolInfo)
+{
+    if (poolInfo->custom != NULL) {
+        free(poolInfo->custom->view.frameState);
+        free(poolInfo->custom->view.poolState);
+        free(poolInfo->custom);
+        poolInfo->custom = NULL;
+    }
+}
+
+/*
+ * Asks the policy of an RS_CUSTOM pool for a victim
+ * @return Index of the victim frame, or -1 if the policy found none or
+ *         returned a frame that cannot be evicted
+ */
+static int customVictim(BufferPoolInfo *poolInfo)
+{
+    CustomPolicy *custom = poolInfo->custom;
+    int idx = custom->policy.pickVictim(&custom->view);
+    if (idx < 0 || idx >= poolInfo->bufferSize || poolInfo->fixCounts[idx] != 0) {
+        return -1;
+    }
+    return idx;
+}
+
+/*
+ * Sets up the lock and condition of bounded pin waits
+ * @param timeoutMs - Longest wait of one pin for an unpin
+ * @return RC_OK on success, RC_ERROR if out of memory
+ */
+static RC allocPinWait(BufferPoolInfo *poolInfo, int timeoutMs)
+{
+    PinWait *pinWait = (PinWait*)malloc(sizeof(PinWait));
+    if (pinWait == NULL) {
+        return RC_ERROR;
+    }
+
+    /* Deadlines are taken from the monotonic clock */
+    pthread_condattr_t attr;
+    if (pthread_condattr_init(&attr) != 0) {
+        free(pinWait);
+        return RC_ERROR;
+    }
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    if (pthread_mutex_init(&pinWait->lock, NULL) != 0) {
+        pthread_condattr_destroy(&attr);
+        free(pinWait);
+        return RC_ERROR;
+    }
+    if (pthread_cond_init(&pinWait->unpinned, &attr) != 0) {
+        pthread_condattr_destroy(&attr);
+        pthread_mutex_destroy(&pinWait->lock);
+        free(pinWait);
+        return RC_ERROR;
+    }
+    pthread_condattr_destroy(&attr);
+
+    pinWait->timeoutMs = timeoutMs;
+    poolInfo->pinWait = pinWait;
+    return RC_OK;
+}
+
+/*
+ * Frees the lock and condition of bounded pin waits, if any
+ */
+static void freePinWait(BufferPoolInfo *poolInfo)
+{
+    if (poolInfo->pinWait != NULL) {
+        pthread_cond_destroy(&poolInfo->pinWait->unpinned);
+        pthread_mutex_destroy(&poolInfo->pinWait->lock);
+        free(poolInfo->pinWait);
+        poolInfo->pinWait = NULL;
+    }
+}
+
+/*
+ * Gives back the pins of processes that left a shared pool without
+ * detaching, i.e. died, and rebuilds the fix counts from the pin rows of
+ * the processes still attached
+ * @param rebuild - Rebuild the fix counts even if no process died
+ * @return Number of dead processes found
+ */
+static int reclaimDeadProcesses(BufferPoolInfo *poolInfo, bool rebuild)
+{
+    SharedPool *shared = poolInfo->shared;
+    SharedHeader *header = shared->header;
+    size_t n = (size_t)poolInfo->bufferSize;
+
+    /* EPERM means the process exists, under another user */
+    int reclaimed = 0;
+    for (int s = 0; s < SHARED_MAX_PROCESSES; s++) {
+        pid_t pid = header->processes[s];
+        if (pid == 0 || s == shared->slot || kill(pid, 0) == 0 || errno != ESRCH) {
+            continue;
+        }
+        memset(&shared->allPins[s * n], 0, n * sizeof(int));
+        header->processes[s] = 0;
+        header->numAttached--;
+        header->reclaimed++;
+        reclaimed++;
+    }
+    if (reclaimed == 0 && !rebuild) {
+        return 0;
+    }
+
+    memset(poolInfo->fixCounts, 0, n * sizeof(int));
+    for (int s = 0; s < SHARED_MAX_PROCESSES; s++) {
+        const int *row = &shared->allPins[s * n];
+        for (size_t i = 0; header->processes[s] != 0 && i < n; i++) {
+            poolInfo->fixCounts[i] += row[i];
+        }
+    }
+    for (size_t i = 0; i < n; i++) {
+        if (poolInfo->fixCounts[i] > 0) {
+            setBit(poolInfo->pinnedBits, (int)i);
+        } else {
+            clearBit(poolInfo->pinnedBits, (int)i);
+        }
+    }
+    pthread_cond_broadcast(&poolInfo->pinWait->unpinned);
+    return reclaimed;
+}
+
+/*
+ * Takes over the lock of a shared pool from a process that died holding it
+ * A miss the process was in the middle of is undone: its frame, whose
+ * victim was already written back, is marked empty. Empty frames lose
+ * their dirty bits, the hands and GCLOCK counts are clamped, the LRU clock
+ * is moved past every frame's last use and the SIEVE queue is rebuilt in
+ * frame order, since the process may have died between two of its links.
+ * The fix counts are rebuilt from the pin rows
+ */
+static void recoverSharedPool(BufferPoolInfo *poolInfo)
+{
+    SharedHeader *header = poolInfo->shared->header;
+    PoolPartition *part = &header->partition;
+    int n = poolInfo->bufferSize;
+
+    pthread_mutex_consistent(&poolInfo->pinWait->lock);
+
+    int miss = header->missFrame;
+    if (miss >= 0 && miss < n) {
+        poolInfo->pageNumbers[miss] = NO_PAGE;
+        poolInfo->generations[miss]++;
+    }
+    header->missFrame = -1;
+
+    part->sieveNewest = part->sieveOldest = part->sieveHand = -1;
+    for (int i = 0; i < n; i++) {
+        if (poolInfo->pageNumbers[i] == NO_PAGE) {
+            clearBit(poolInfo->dirtyBits, i);
+            poolInfo->dirtySectors[i] = 0;
+            continue;
+        }
+        if (poolInfo->usageCounts[i] > header->maxUsageCount) {
+            poolInfo->usageCounts[i] = (uint8_t)header->maxUsageCount;
+        }
+        if (poolInfo->recentHits[i] > header->recentHitCount) {
+            header->recentHitCount = poolInfo->recentHits[i];
+        }
+        if (header->strategy == RS_SIEVE) {
+            sieveInsert(poolInfo, i);
+        }
+    }
+    if (part->frameIndex < 0 || part->frameIndex >= n) {
+        part->frameIndex = 0;
+    }
+    if (part->clockPointer < 0 || part->clockPointer >= n) {
+        part->clockPointer = 0;
+    }
+
+    reclaimDeadProcesses(poolInfo, true);
+}
+
+/*
+ * Records the frame a miss of a shared pool is refilling, or -1 once the
+ * miss is done, so that a process taking over the lock can undo it
+ */
+static inline void markMissFrame(BufferPoolInfo *poolInfo, int idx)
+{
+    if (poolInfo->shared != NULL) {
+        poolInfo->shared->header->missFrame = idx;
+    }
+}
+
+/* Helper functions to serialize page operations of pools with pin waits and
+ * shared pools; a shared pool keeps its LRU clock in the segment */
+static inline void lockPool(BufferPoolInfo *poolInfo) {
+    if (poolInfo->pinWait != NULL) {
+        if (pthread_mutex_lock(&poolInfo->pinWait->lock) == EOWNERDEAD) {
+            recoverSharedPool(poolInfo);
+        }
+        if (poolInfo->shared != NULL) {
+            poolInfo->recentHitCount = poolInfo->shared->header->recentHitCount;
+        }
+    }
+}
+
+static inline void unlockPool(BufferPoolInfo *poolInfo) {
+    if (poolInfo->pinWait != NULL) {
+        if (poolInfo->shared != NULL) {
+            poolInfo->shared->header->recentHitCount = poolInfo->recentHitCount;
+        }
+        pthread_mutex_unlock(&poolInfo->pinWait->lock);
+    }
+}
+
+/*
+ * Waits with the pool lock held until a frame becomes evictable
+ * @param deadline - CLOCK_MONOTONIC time to give up at
+ * @return true if woken by an unpin, false at the deadline
+ */
+static bool waitForUnpin(BufferPoolInfo *poolInfo, const struct timespec *deadline)
+{
+    if (poolInfo->shared != NULL) {
+        poolInfo->shared->header->recentHitCount = poolInfo->recentHitCount;
+    }
+    int result = pthread_cond_timedwait(&poolInfo->pinWait->unpinned, &poolInfo->pinWait->lock,
+                                        deadline);
+    if (result == EOWNERDEAD) {
+        recoverSharedPool(poolInfo);
+        result = 0;
+    }
+    if (poolInfo->shared != NULL) {
+        poolInfo->recentHitCount = poolInfo->shared->header->recentHitCount;
+    }
+    return result == 0;
+}
+
+/*
+ * Allocates the compressed tier of evicted pages
+ * @param byteLimit - Cap on the compressed page images it holds
+ * @return RC_OK on success, RC_ERROR if out of memory
+ */
+static RC allocTier(BufferPoolInfo *poolInfo, long byteLimit)
+{
+    CompressedCache *tier = (CompressedCache*)malloc(sizeof(CompressedCache));
+    if (tier == NULL) {
+        return RC_ERROR;
+    }
+
+    if (initCompressedCache(tier, byteLimit) != 0) {
+        free(tier);
+        return RC_ERROR;
+    }
+
+    poolInfo->tier = tier;
+    return RC_OK;
+}
+
+/*
+ * Frees the compressed tier, if any; modified pages must have been flushed
+ */
+static void freeTier(BufferPoolInfo *poolInfo)
+{
+    if (poolInfo->tier != NULL) {
+        freeCompressedCache(poolInfo->tier);
+        free(poolInfo->tier);
+        poolInfo->tier = NULL;
+    }
+}
+
+/*
+ * Writes back a modified page dropped or flushed by the compressed tier
+ * @param context - BufferPoolInfo of the pool
+ * @return 0 on success, -1 on failure
+ */
+static int writeBackTierPage(void *context, FileId fileId, PageNumber pageNum, const char *page)
+{
+    BufferPoolInfo *poolInfo = (BufferPoolInfo*)context;
+    SM_FileHandle *fh = getFileHandle(poolInfo, fileId);
+    uint64_t start = ioStart(poolInfo);
+    uint64_t traceStart = TRACE_CLOCK();
+    if (fh == NULL || writeBlock(pageNum, fh, (SM_PageHandle)page) != RC_OK) {
+        return -1;
+    }
+
+    TRACE_WRITE_BACK(fileId, pageNum, -1, PAGE_SIZE, TRACE_CLOCK() - traceStart);
+    poolInfo->writeCount++;
+    publishIO(poolInfo, true, start);
+    poolInfo->bytesWritten += PAGE_SIZE;
+    return 0;
+}
+
+/*
+ * Reads a missed page from the compressed tier, the victim cache or,
+ * failing both, from disk
+ * @param data - Receives the PAGE_SIZE bytes of the page
+ * @param dirty - Set if the copy from the tier still has to be written back
+ * @return RC_OK on success, RC_READ_NON_EXISTING_PAGE if the read failed
+ */
+static RC loadPage(BufferPoolInfo *poolInfo, SM_FileHandle *fh, FileId fileId,
+                   PageNumber pageNum, char *data, bool *dirty)
+{
+    *dirty = false;
+    if (poolInfo->tier != NULL &&
+        takeCompressedPage(poolInfo->tier, fileId, pageNum, data, dirty)) {
+        return RC_OK;
+    }
+    if (poolInfo->victim != NULL && readVictimPage(poolInfo->victim, fileId, pageNum, data)) {
+        return RC_OK;
+    }
+
+    refreshPageCount(poolInfo, fh);
+    ensureCapacity(pageNum + 1, fh);
+    uint64_t start = ioStart(poolInfo);
+    if (readBlock(pageNum, fh, data) != RC_OK) {
+        return RC_READ_NON_EXISTING_PAGE;
+    }
+    poolInfo->readCount++;
+    publishIO(poolInfo, false, start);
+    return RC_OK;
+}
+
+/*
+ * Finds the bypass frame holding a page
+ * @return The bypass frame, or NULL if the page is not in one
+ */
+static BypassFrame *findBypassFrame(BufferPoolInfo *poolInfo, FileId fileId, PageNumber pageNum)
+{
+    if (poolInfo->admission == NULL) {
+        return NULL;
+    }
+
+    for (int i = 0; i < ADMISSION_BYPASS_FRAMES; i++) {
+        BypassFrame *frame = &poolInfo->admission->bypass[i];
+        if (frame->pageNum == pageNum && frame->fileId == fileId) {
+            return frame;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Writes a modified bypass frame back to its page file
+ * @return RC_OK on success, error code otherwise
+ */
+static RC writeBackBypassFrame(BufferPoolInfo *poolInfo, BypassFrame *frame)
+{
+    SM_FileHandle *fh = getFileHandle(poolInfo, frame->fileId);
+    if (fh == NULL) {
+        return RC_FILE_HANDLE_NOT_INIT;
+    }
+
+    uint64_t start = ioStart(poolInfo);
+    uint64_t traceStart = TRACE_CLOCK();
+    if (writeBlock(frame->pageNum, fh, frame->data) != RC_OK) {
+        return RC_WRITE_FAILED;
+    }
+
+    TRACE_WRITE_BACK(frame->fileId, frame->pageNum, -1, PAGE_SIZE, TRACE_CLOCK() - traceStart);
+    frame->dirty = 0;
+    poolInfo->writeCount++;
+    publishIO(poolInfo, true, start);
+    poolInfo->bytesWritten += PAGE_SIZE;
+    return RC_OK;
+}
+
+/*
+ * TinyLFU admission: a missed page replaces the victim only if the sketch
+ * saw it more often recently, or if no bypass frame is free
+ * @return true if the page should be cached
+ */
+static bool admitPage(BufferPoolInfo *poolInfo, FileId fileId, PageNumber pageNum, int victim)
+{
+    Admission *admission = poolInfo->admission;
+    int candidate = estimateFrequency(&admission->sketch, pageKey(fileId, pageNum));
+    int resident = estimateFrequency(&admission->sketch,
+                                     pageKey(poolInfo->fileIds[victim], poolInfo->pageNumbers[victim]));
+    if (candidate > resident) {
+        return true;
+    }
+
+    for (int i = 0; i < ADMISSION_BYPASS_FRAMES; i++) {
+        if (admission->bypass[i].pageNum == NO_PAGE) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Reads a page rejected by the admission filter into a free bypass frame
+ * @return RC_OK on success, error code otherwise
+ */
+static RC pinBypassPage(BufferPoolInfo *poolInfo, BM_PageHandle *const page, SM_FileHandle *fh,
+                        FileId fileId, PageNumber pageNum)
+{
+    BypassFrame *bypass = NULL;
+    for (int i = 0; i < ADMISSION_BYPASS_FRAMES && bypass == NULL; i++) {
+        if (poolInfo->admission->bypass[i].pageNum == NO_PAGE) {
+            bypass = &poolInfo->admission->bypass[i];
+        }
+    }
+    if (bypass == NULL) {
+        return RC_ERROR;
+    }
+
+    uint64_t start = TRACE_CLOCK();
+    bool dirty;
+    if (loadPage(poolInfo, fh, fileId, pageNum, bypass->data, &dirty) != RC_OK) {
+        return RC_READ_NON_EXISTING_PAGE;
+    }
+    TRACE_PIN_MISS(fileId, pageNum, -1, TRACE_CLOCK() - start);
+
+    bypass->pageNum = pageNum;
+    bypass->fileId = fileId;
+    bypass->fixCount = 1;
+    bypass->dirty = dirty;
+    poolInfo->admission->numRejected++;
+    publishPin(poolInfo, false);
+
+    page->fileId = fileId;
+    page->pageNum = pageNum;
+    page->data = bypass->data;
+    page->frame = -1;
+    return RC_OK;
+}
+
+/*
+ * Frees the file registry, closing every registered page file
+ */
+static void freeFileRegistry(BufferPoolInfo *poolInfo)
+{
+    for (int i = 0; i < poolInfo->numFiles; i++) {
+        closePageFile(&poolInfo->files[i].fh);
+        free(poolInfo->files[i].fileName);
+    }
+    free(poolInfo->files);
+    poolInfo->files = NULL;
+    poolInfo->numFiles = 0;
+    poolInfo->fileCapacity = 0;
+}
+
+/*
+ * Opens a page file and appends it to the registry
+ * @return RC_OK on success, error code otherwise
+ */
+static RC appendPageFile(BufferPoolInfo *poolInfo, const char *pageFileName)
+{
+    if (poolInfo->numFiles == poolInfo->fileCapacity) {
+        int newCapacity = (poolInfo->fileCapacity == 0) ? 4 : poolInfo->fileCapacity * 2;
+        PageFileEntry *files = (PageFileEntry*)realloc(poolInfo->files,
+                                                       newCapacity * sizeof(PageFileEntry));
+        if (files == NULL) {
+            return RC_ERROR;
+        }
+        poolInfo->files = files;
+        poolInfo->fileCapacity = newCapacity;
+    }
+
+    PageFileEntry *entry = &poolInfo->files[poolInfo->numFiles];
+    entry->fileName = (char*)malloc(strlen(pageFileName) + 1);
+    if (entry->fileName == NULL) {
+        return RC_ERROR;
+    }
+    strcpy(entry->fileName, pageFileName);
+
+    if (openPageFile(entry->fileName, &entry->fh) != RC_OK) {
+        free(entry->fileName);
+        return RC_FILE_NOT_FOUND;
+    }
+
+    poolInfo->numFiles++;
+    return RC_OK;
+}
+
+/*
+ * Opens the page files other processes registered with a shared pool, so
+ * that a file id names the same file in every process
+ * @return RC_OK on success, RC_FILE_NOT_FOUND if a file cannot be opened
+ *         under its registered name
+ */
+static RC syncSharedFiles(BufferPoolInfo *poolInfo)
+{
+    SharedHeader *header = poolInfo->shared->header;
+    while (poolInfo->numFiles < header->numFiles) {
+        RC result = appendPageFile(poolInfo, header->files[poolInfo->numFiles]);
+        if (result != RC_OK) {
+            return result;
+        }
+    }
+    return RC_OK;
+}
+
+/*
+ * Adds a page file to the registry and opens its handle
+ * Shared pools also add it to the registry in the segment
+ * @param poolInfo - Buffer pool info
+ * @param pageFileName - Name of the page file
+ * @param fileId - Receives the id of the registered file
+ * @return RC_OK on success, error code otherwise
+ */
+static RC addPageFile(BufferPoolInfo *poolInfo, const char *pageFileName, FileId *fileId)
+{
+    SharedHeader *header = (poolInfo->shared != NULL) ? poolInfo->shared->header : NULL;
+    if (header != NULL) {
+        RC result = syncSharedFiles(poolInfo);
+        if (result != RC_OK) {
+            return result;
+        }
+    }
+
+    /* A file that is already registered keeps its id */
+    for (int i = 0; i < poolInfo->numFiles; i++) {
+        if (strcmp(poolInfo->files[i].fileName, pageFileName) == 0) {
+            *fileId = i;
+            return RC_OK;
+        }
+    }
+
+    if (header != NULL && (header->numFiles == SHARED_MAX_FILES ||
+                           strlen(pageFileName) >= SHARED_FILE_NAME_MAX)) {
+        return RC_ERROR;
+    }
+    RC result = appendPageFile(poolInfo, pageFileName);
+    if (result != RC_OK) {
+        return result;
+    }
+    if (header != NULL) {
+        strcpy(header->files[header->numFiles], pageFileName);
+        header->numFiles++;
+    }
+
+    *fileId = poolInfo->numFiles - 1;
+    return RC_OK;
+}
+
+/*
+ * Registers a page file named in the victim cache's saved index
+ * @param context - BufferPoolInfo of the pool
+ * @return Id of the file, -1 if it cannot be opened
+ */
+static FileId resolveVictimFile(void *context, const char *fileName)
+{
+    FileId fileId;
+    if (addPageFile((BufferPoolInfo*)context, fileName, &fileId) != RC_OK) {
+        return -1;
+    }
+    return fileId;
+}
+
+/*
+ * Name of a page file of the pool, for the victim cache's saved index
+ * @param context - BufferPoolInfo of the pool
+ */
+static const char *victimFileName(void *context, FileId fileId)
+{
+    return ((BufferPoolInfo*)context)->files[fileId].fileName;
+}
+
+/*
+ * Opens the victim cache file and restores the entries of its saved index
+ * @return RC_OK on success, RC_ERROR if the cache file cannot be used
+ */
+static RC allocVictim(BufferPoolInfo *poolInfo, const char *fileName, int numPages)
+{
+    VictimCache *victim = (VictimCache*)malloc(sizeof(VictimCache));
+    if (victim == NULL) {
+        return RC_ERROR;
+    }
+
+    if (openVictimCache(victim, fileName, numPages, resolveVictimFile, poolInfo) != 0) {
+        free(victim);
+        return RC_ERROR;
+    }
+
+    poolInfo->victim = victim;
+    return RC_OK;
+}
+
+/*
+ * Closes the victim cache, if any
+ * @param saveIndex - Whether to save the index for the next run
+ */
+static void freeVictim(BufferPoolInfo *poolInfo, bool saveIndex)
+{
+    if (poolInfo->victim != NULL) {
+        closeVictimCache(poolInfo->victim, saveIndex ? victimFileName : NULL, poolInfo);
+        free(poolInfo->victim);
+        poolInfo->victim = NULL;
+    }
+}
+
+/*
+ * Creates the statistics segment monitors read
+ * @return RC_OK on success, RC_ERROR if the segment cannot be created
+ */
+static RC allocStats(BufferPoolInfo *poolInfo, const char *name, const char *pageFileName,
+                     int numPages, ReplacementStrategy strategy)
+{
+    poolInfo->stats = createPoolStats(name, pageFileName, numPages, (int)strategy);
+    return (poolInfo->stats != NULL) ? RC_OK : RC_ERROR;
+}
+
+/*
+ * Removes the statistics segment, if any; monitors still mapping it see
+ * the pool closed
+ */
+static void freeStats(BufferPoolInfo *poolInfo)
+{
+    if (poolInfo->stats != NULL) {
+        destroyPoolStats(poolInfo->stats);
+        poolInfo->stats = NULL;
+    }
+}
+
+/*
+ * Allocates the frame area, trying the preferred memory mode first and
+ * falling back to transparent huge pages and then the heap
+ * @return RC_OK on success, RC_ERROR if no memory could be allocated
+ */
+static RC allocFrameArea(BufferPoolInfo *poolInfo, FrameMemoryMode preferred)
+{
+    size_t size = (size_t)poolInfo->bufferSize * PAGE_SIZE;
+    size_t hugeSize = (size + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+
+    if (preferred == FM_AUTO) {
+        /* A huge page for a small pool would mostly be wasted */
+        preferred = (size >= HUGE_PAGE_SIZE) ? FM_HUGETLB : FM_HEAP;
+    }
+
+#ifdef MAP_HUGETLB
+    if (preferred == FM_HUGETLB) {
+        void *area = mmap(NULL, hugeSize, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (area != MAP_FAILED) {
+            poolInfo->frameArea = (char*)area;
+            poolInfo->frameAreaSize = hugeSize;
+            poolInfo->frameMemory = FM_HUGETLB;
+            return RC_OK;
+        }
+    }
+#endif
+
+#ifdef MADV_HUGEPAGE
+    if (preferred == FM_HUGETLB || preferred == FM_TRANSPARENT_HUGE) {
+        /* Over-allocate so the area can start on a huge page boundary */
+        size_t mapSize = hugeSize + HUGE_PAGE_SIZE;
+        char *map = (char*)mmap(NULL, mapSize, PROT_READ | PROT_WRITE,
+                                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (map != MAP_FAILED) {
+            char *area = (char*)(((size_t)map + HUGE_PAGE_SIZE - 1) &
+                                 ~(size_t)(HUGE_PAGE_SIZE - 1));
+            size_t head = area - map;
+            if (head > 0) {
+                munmap(map, head);
+            }
+            if (mapSize - head > hugeSize) {
+                munmap(area + hugeSize, mapSize - head - hugeSize);
+            }
+
+            if (madvise(area, hugeSize, MADV_HUGEPAGE) == 0) {
+                poolInfo->frameArea = area;
+                poolInfo->frameAreaSize = hugeSize;
+                poolInfo->frameMemory = FM_TRANSPARENT_HUGE;
+                return RC_OK;
+            }
+            munmap(area, hugeSize);
+        }
+    }
+#endif
+
+    void *area = NULL;
+    if (posix_memalign(&area, PAGE_SIZE, size) != 0) {
+        return RC_ERROR;
+    }
+    poolInfo->frameArea = (char*)area;
+    poolInfo->frameAreaSize = size;
+    poolInfo->frameMemory = FM_HEAP;
+    return RC_OK;
+}
+
+/*
+ * Frees the frame area, if any, with the allocator that provided it; the
+ * frames of a shared pool go with its segment
+ */
+static void freeFrameArea(BufferPoolInfo *poolInfo)
+{
+    if (poolInfo->frameArea == NULL) {
+        return;
+    }
+    if (poolInfo->frameMemory == FM_HEAP) {
+        free(poolInfo->frameArea);
+    } else if (poolInfo->frameMemory != FM_SHARED) {
+        munmap(poolInfo->frameArea, poolInfo->frameAreaSize);
+    }
+    poolInfo->frameArea = NULL;
+}
+
+/*
+ * Writes all dirty, unpinned pages with the pool lock held, skipping clean
+ * words of the bitmap, and the modified pages of the compressed tier
+ * @return RC_OK on success, error code of the first failed write otherwise
+ */
+static RC flushFramesLocked(BufferPoolInfo *poolInfo)
+{
+    RC result = RC_OK;
+    for (int w = 0; w < BITMAP_WORDS(poolInfo->bufferSize) && result == RC_OK; w++) {
+        uint64_t pending = poolInfo->dirtyBits[w] & ~poolInfo->pinnedBits[w];
+        while (pending != 0 && result == RC_OK) {
+            int idx = w * 64 + lowestBit(pending);
+            pending &= pending - 1;
+            result = writeBackFrame(poolInfo, idx);
+        }
+    }
+
+    if (result == RC_OK && poolInfo->tier != NULL &&
+        flushCompressedCache(poolInfo->tier, writeBackTierPage, poolInfo) != 0) {
+        result = RC_WRITE_FAILED;
+    }
+    publishGauges(poolInfo);
+    return result;
+}
+
+/* Publishes and reads the ready flag of a shared pool segment */
+static inline void publishReady(int *ready) {
+#if defined(__GNUC__)
+    __atomic_store_n(ready, 1, __ATOMIC_RELEASE);
+#else
+    *(volatile int*)ready = 1;
+#endif
+}
+
+static inline int loadReady(int *ready) {
+#if defined(__GNUC__)
+    return __atomic_load_n(ready, __ATOMIC_ACQUIRE);
+#else
+    return *(volatile int*)ready;
+#endif
+}
+
+/* Sleeps between attempts to attach to a shared pool */
+static void sharedBackoff(void)
+{
+    struct timespec delay = { 0, 1000000L };
+    nanosleep(&delay, NULL);
+}
+
+/*
+ * Maps the segment of a shared pool, creating it if the name is free
+ * @param size - Size of the segment for the pool's number of frames
+ * @param created - Set if this call created the segment
+ * @return 1 if mapped, 0 if another process is creating the segment (try
+ *         again), -1 on failure or if the segment has another size
+ */
+static int mapSharedSegment(const char *name, size_t size, SharedHeader **header, bool *created)
+{
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    *created = (fd != -1);
+    if (fd == -1) {
+        if (errno != EEXIST) {
+            return -1;
+        }
+        fd = shm_open(name, O_RDWR, 0);
+        if (fd == -1) {
+            return (errno == ENOENT) ? 0 : -1;
+        }
+    } else if (ftruncate(fd, (off_t)size) != 0) {
+        close(fd);
+        shm_unlink(name);
+        return -1;
+    }
+
+    /* The creator sizes the segment right after creating it */
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (st.st_size != 0 && (size_t)st.st_size != size)) {
+        close(fd);
+        return -1;
+    }
+    if (st.st_size == 0) {
+        close(fd);
+        return 0;
+    }
+
+    void *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        if (*created) {
+            shm_unlink(name);
+        }
+        return -1;
+    }
+    *header = (SharedHeader*)map;
+    return 1;
+}
+
+/*
+ * Initializes the header of a segment this process created: the
+ * process-shared robust lock, the replacement hand and the file registry
+ * @return 0 on success, -1 if the lock cannot be created
+ */
+static int initSharedHeader(SharedHeader *header, int numFrames, ReplacementStrategy strategy,
+                            int maxUsageCount, int pinWaitMs, const char *pageFileName)
+{
+    pthread_mutexattr_t mutexAttr;
+    if (pthread_mutexattr_init(&mutexAttr) != 0) {
+        return -1;
+    }
+    int failed = pthread_mutexattr_setpshared(&mutexAttr, PTHREAD_PROCESS_SHARED) != 0 ||
+                 pthread_mutexattr_setrobust(&mutexAttr, PTHREAD_MUTEX_ROBUST) != 0 ||
+                 pthread_mutex_init(&header->pinWait.lock, &mutexAttr) != 0;
+    pthread_mutexattr_destroy(&mutexAttr);
+    if (failed) {
+        return -1;
+    }
+
+    /* Deadlines are taken from the monotonic clock */
+    pthread_condattr_t condAttr;
+    if (pthread_condattr_init(&condAttr) != 0) {
+        pthread_mutex_destroy(&header->pinWait.lock);
+        return -1;
+    }
+    failed = pthread_condattr_setpshared(&condAttr, PTHREAD_PROCESS_SHARED) != 0 ||
+             pthread_condattr_setclock(&condAttr, CLOCK_MONOTONIC) != 0 ||
+             pthread_cond_init(&header->pinWait.unpinned, &condAttr) != 0;
+    pthread_condattr_destroy(&condAttr);
+    if (failed) {
+        pthread_mutex_destroy(&header->pinWait.lock);
+        return -1;
+    }
+
+    header->magic = SHARED_MAGIC;
+    header->numFrames = numFrames;
+    header->strategy = strategy;
+    header->maxUsageCount = maxUsageCount;
+    header->pinWait.timeoutMs = pinWaitMs;
+    header->partition.numFrames = numFrames;
+    header->partition.sieveNewest = header->partition.sieveOldest = header->partition.sieveHand = -1;
+    header->missFrame = -1;
+    strcpy(header->files[0], pageFileName);
+    header->numFiles = 1;
+    return 0;
+}
+
+/*
+ * Takes a process slot in a mapped segment, unless the last process is
+ * removing it
+ * @return 1 on success, 0 if the segment is closing (try again), -1 if
+ *         every slot is taken
+ */
+static int joinSharedSegment(BufferPoolInfo *poolInfo)
+{
+    SharedPool *shared = poolInfo->shared;
+    SharedHeader *header = shared->header;
+
+    lockPool(poolInfo);
+    if (header->closed) {
+        unlockPool(poolInfo);
+        return 0;
+    }
+    reclaimDeadProcesses(poolInfo, false);
+
+    int slot = 0;
+    while (slot < SHARED_MAX_PROCESSES && header->processes[slot] != 0) {
+        slot++;
+    }
+    if (slot == SHARED_MAX_PROCESSES) {
+        unlockPool(poolInfo);
+        return -1;
+    }
+    header->processes[slot] = getpid();
+    header->numAttached++;
+    shared->slot = slot;
+    shared->pins = &shared->allPins[(size_t)slot * poolInfo->bufferSize];
+    unlockPool(poolInfo);
+    return 1;
+}
+
+/*
+ * Creates the shared memory segment of a shared pool, or attaches to the
+ * one another process created under the same name, and takes a process
+ * slot; the frame metadata, frames, replacement hand and pool lock of the
+ * pool are the ones in the segment
+ * @param name - POSIX shared memory name
+ * @param pinWaitMs - Pin wait of the pool if this process creates it
+ * @return RC_OK on success, RC_ERROR if the segment cannot be created,
+ *         belongs to a pool with another page file, size, strategy or GCLOCK
+ *         count, or has no free process slot
+ */
+static RC attachShared(BufferPoolInfo *poolInfo, const char *name, const char *pageFileName,
+                       ReplacementStrategy strategy, int maxUsageCount, int pinWaitMs)
+{
+    size_t n = (size_t)poolInfo->bufferSize;
+    size_t metadataOffset = alignMetadata(sizeof(SharedHeader));
+    size_t pinsOffset = metadataOffset + frameMetadataSize(n);
+    size_t frameOffset = (pinsOffset + SHARED_MAX_PROCESSES * n * sizeof(int) + PAGE_SIZE - 1) /
+                         PAGE_SIZE * PAGE_SIZE;
+    size_t size = frameOffset + n * PAGE_SIZE;
+    if (strlen(pageFileName) >= SHARED_FILE_NAME_MAX) {
+        return RC_ERROR;
+    }
+
+    SharedPool *shared = (SharedPool*)malloc(sizeof(SharedPool));
+    if (shared == NULL) {
+        return RC_ERROR;
+    }
+    shared->name = (char*)malloc(strlen(name) + 1);
+    if (shared->name == NULL) {
+        free(shared);
+        return RC_ERROR;
+    }
+    strcpy(shared->name, name);
+    shared->size = size;
+    shared->slot = -1;
+
+    for (int attempt = 0; attempt < SHARED_ATTACH_ATTEMPTS; attempt++) {
+        SharedHeader *header;
+        bool created;
+        int mapped = mapSharedSegment(name, size, &header, &created);
+        if (mapped < 0) {
+            break;
+        }
+        if (mapped == 0) {
+            sharedBackoff();
+            continue;
+        }
+
+        char *base = (char*)header;
+        placeFrameMetadata(poolInfo, base + metadataOffset);
+        if (created) {
+            if (initSharedHeader(header, (int)n, strategy, maxUsageCount, pinWaitMs,
+                                 pageFileName) != 0) {
+                munmap(header, size);
+                shm_unlink(name);
+                break;
+            }
+            markFramesEmpty(poolInfo);
+            publishReady(&header->ready);
+        } else {
+            /* Wait for the creator to finish, then check the pool matches */
+            for (int wait = 0; !loadReady(&header->ready) && wait < SHARED_ATTACH_ATTEMPTS; wait++) {
+                sharedBackoff();
+            }
+            if (!loadReady(&header->ready) || header->magic != SHARED_MAGIC ||
+                header->numFrames != (int)n || header->strategy != strategy ||
+                header->maxUsageCount != maxUsageCount ||
+                strcmp(header->files[0], pageFileName) != 0) {
+                munmap(header, size);
+                break;
+            }
+        }
+
+        shared->header = header;
+        shared->allPins = (int*)(base + pinsOffset);
+        poolInfo->shared = shared;
+        poolInfo->frameArea = base + frameOffset;
+        poolInfo->frameAreaSize = n * PAGE_SIZE;
+        poolInfo->frameMemory = FM_SHARED;
+        poolInfo->partitions = &header->partition;
+        poolInfo->numPartitions = 1;
+        poolInfo->pinWait = &header->pinWait;
+
+        int joined = joinSharedSegment(poolInfo);
+        if (joined == 1) {
+            return RC_OK;
+        }
+        poolInfo->shared = NULL;
+        poolInfo->pinWait = NULL;
+        poolInfo->partitions = NULL;
+        munmap(header, size);
+        if (joined < 0) {
+            break;
+        }
+    }
+
+    free(shared->name);
+    free(shared);
+    return RC_ERROR;
+}
+
+/*
+ * Detaches this process from a shared pool; the segment stays mapped
+ * The last process writes back every modified page and removes the name,
+ * so the next pool created under it starts empty
+ * @return RC_OK on success, RC_PINNED_PAGES_IN_BUFFER if this process
+ *         still holds pins, error code of a failed write-back otherwise (the
+ *         process stays attached in both cases)
+ */
+static RC leaveSharedPool(BufferPoolInfo *poolInfo)
+{
+    SharedPool *shared = poolInfo->shared;
+    SharedHeader *header = shared->header;
+    RC result = RC_OK;
+
+    lockPool(poolInfo);
+    for (int i = 0; i < poolInfo->bufferSize && result == RC_OK; i++) {
+        if (shared->pins[i] != 0) {
+            result = RC_PINNED_PAGES_IN_BUFFER;
+        }
+    }
+    if (result == RC_OK) {
+        reclaimDeadProcesses(poolInfo, false);
+        if (header->numAttached == 1) {
+            result = flushFramesLocked(poolInfo);
+            if (result == RC_OK) {
+                header->closed = 1;
+                shm_unlink(shared->name);
+            }
+        }
+    }
+    if (result == RC_OK) {
+        header->processes[shared->slot] = 0;
+        header->numAttached--;
+        shared->slot = -1;
+    }
+    unlockPool(poolInfo);
+    return result;
+}
+
+/*
+ * Unmaps the segment of a shared pool, first leaving it without write-backs
+ * if this process is still attached; the last process removes the name
+ * unless modified pages are left in the segment
+ */
+static void freeShared(BufferPoolInfo *poolInfo)
+{
+    SharedPool *shared = poolInfo->shared;
+    if (shared == NULL) {
+        return;
+    }
+
+    if (shared->slot != -1) {
+        SharedHeader *header = shared->header;
+        lockPool(poolInfo);
+        header->processes[shared->slot] = 0;
+        header->numAttached--;
+        bool dirty = false;
+        for (int w = 0; w < BITMAP_WORDS(poolInfo->bufferSize); w++) {
+            dirty = dirty || poolInfo->dirtyBits[w] != 0;
+        }
+        if (header->numAttached == 0 && !dirty) {
+            header->closed = 1;
+            shm_unlink(shared->name);
+        }
+        unlockPool(poolInfo);
+    }
+
+    munmap(shared->header, shared->size);
+    free(shared->name);
+    free(shared);
+    poolInfo->shared = NULL;
+    poolInfo->pinWait = NULL;
+    poolInfo->partitions = NULL;
+    poolInfo->frameArea = NULL;
+}
+
+/*
+ * Reads the ids of the online NUMA nodes
+ * @return Number of nodes; 1 with node 0 where NUMA is not available
+ */
+static int getNumaNodes(int *nodes)
+{
+    int numNodes = 0;
+
+#ifdef __linux__
+    FILE *filePtr = fopen("/sys/devices/system/node/online", "r");
+    if (filePtr != NULL) {
+        /* Ranges list such as "0" or "0-1,4" */
+        int first;
+        int last;
+        char sep;
+        while (numNodes < MAX_NUMA_NODES && fscanf(filePtr, "%d", &first) == 1) {
+            last = first;
+            if (fscanf(filePtr, "%c", &sep) == 1 && sep == '-') {
+                if (fscanf(filePtr, "%d", &last) != 1) {
+                    break;
+                }
+                if (fscanf(filePtr, "%c", &sep) != 1) {
+                    sep = '\n';
+                }
+            }
+            for (int node = first; node <= last && numNodes < MAX_NUMA_NODES; node++) {
+                if (node >= 0 && node < MAX_NUMA_NODES) {
+                    nodes[numNodes++] = node;
+                }
+            }
+            if (sep != ',') {
+                break;
+            }
+        }
+        fclose(filePtr);
+    }
+#endif
+
+    if (numNodes == 0) {
+        nodes[0] = 0;
+        numNodes = 1;
+    }
+    return numNodes;
+}
+
+/*
+ * Returns the NUMA node of the CPU the calling thread runs on
+ * The node is cached per thread and asked again every NUMA_NODE_REFRESH
+ * calls, so hits do not pay a getcpu system call; a thread the scheduler
+ * moved to another node is noticed on the next refresh
+ */
+static int currentNumaNode(void)
+{
+#if defined(__linux__) && defined(SYS_getcpu)
+    static __thread int cachedNode = 0;
+    static __thread unsigned int callsLeft = 0;
+    if (callsLeft == 0) {
+        unsigned int cpu;
+        unsigned int node;
+        cachedNode = (syscall(SYS_getcpu, &cpu, &node, NULL) == 0) ? (int)node : 0;
+        callsLeft = NUMA_NODE_REFRESH;
+    }
+    callsLeft--;
+    return cachedNode;
+#else
+    return 0;
+#endif
+}
+
+/*
+ * Asks the kernel to place a partition's frames on its node; where mbind
+ * is unavailable the pages land on the node of the thread touching them
+ */
+static void bindPartitionMemory(BufferPoolInfo *poolInfo, PoolPartition *part)
+{
+#if defined(__linux__) && defined(SYS_mbind)
+    unsigned long nodeMask = 1UL << part->node;
+    syscall(SYS_mbind, poolInfo->frameArea + (size_t)part->firstFrame * PAGE_SIZE,
+            (size_t)part->numFrames * PAGE_SIZE, NUMA_MPOL_PREFERRED,
+            &nodeMask, sizeof(nodeMask) * 8, 0);
+#else
+    (void)poolInfo;
+    (void)part;
+#endif
+}
+
+/*
+ * Splits the frames into one partition per NUMA node, or a single
+ * partition when NUMA placement is off or the machine has one node
+ * @return RC_OK on success, RC_ERROR if memory allocation fails
+ */
+static RC initPartitions(BufferPoolInfo *poolInfo, bool numaAware)
+{
+    int nodes[MAX_NUMA_NODES];
+    int numNodes = 1;
+    nodes[0] = 0;
+    if (numaAware) {
+        numNodes = getNumaNodes(nodes);
+    }
+
+    /* Huge pages must not be split between nodes */
+    int unit = (poolInfo->frameMemory == FM_HEAP) ? 1 : HUGE_PAGE_SIZE / PAGE_SIZE;
+    if (numNodes > 1 && poolInfo->bufferSize / unit < numNodes) {
+        numNodes = 1;
+    }
+
+    poolInfo->partitions = (PoolPartition*)calloc(numNodes, sizeof(PoolPartition));
+    if (poolInfo->partitions == NULL) {
+        return RC_ERROR;
+    }
+    poolInfo->numPartitions = numNodes;
+
+    int perNode = poolInfo->bufferSize / unit / numNodes * unit;
+    for (int p = 0; p < numNodes; p++) {
+        PoolPartition *part = &poolInfo->partitions[p];
+        part->node = nodes[p];
+        part->firstFrame = p * perNode;
+        part->numFrames = (p == numNodes - 1) ? poolInfo->bufferSize - part->firstFrame : perNode;
+        part->frameIndex = 0;
+        part->clockPointer = 0;
+        part->sieveNewest = part->sieveOldest = part->sieveHand = -1;
+        if (numNodes > 1) {
+            bindPartitionMemory(poolInfo, part);
+        }
+    }
+    return RC_OK;
+}
+
+/*
+ * Returns the partition holding a frame
+ */
+static PoolPartition *partitionOfFrame(BufferPoolInfo *poolInfo, int idx)
+{
+    int p = poolInfo->numPartitions - 1;
+    while (p > 0 && idx < poolInfo->partitions[p].firstFrame) {
+        p--;
+    }
+    return &poolInfo->partitions[p];
+}
+
+/*
+ * Returns the partition on the calling thread's NUMA node
+ */
+static PoolPartition *localPartition(BufferPoolInfo *poolInfo)
+{
+    if (poolInfo->numPartitions > 1) {
+        int node = currentNumaNode();
+        for (int p = 0; p < poolInfo->numPartitions; p++) {
+            if (poolInfo->partitions[p].node == node) {
+                return &poolInfo->partitions[p];
+            }
+        }
+    }
+    return &poolInfo->partitions[0];
+}
+
+/*
+ * Rank of a frame in the order of replacement: frames with a higher rank
+ * are evicted later by the pool's strategy
+ */
+static int evictionRank(BM_BufferPool *const bm, BufferPoolInfo *poolInfo, int idx)
+{
+    PoolPartition *part = partitionOfFrame(poolInfo, idx);
+    int n = part->numFrames;
+    int pos = idx - part->firstFrame;
+
+    switch (bm->strategy) {
+        case RS_LRU:
+            return poolInfo->recentHits[idx];
+        case RS_CLOCK:
+            return testBit(poolInfo->refBits, idx) * n +
+                   (pos - part->clockPointer + n) % n;
+        case RS_GCLOCK:
+            return poolInfo->usageCounts[idx] * n + (pos - part->clockPointer + n) % n;
+        case RS_CLOCK_PRO:
+            return ((poolInfo->clockPro->flags[poolInfo->clockPro->frameEntries[idx]] & CP_HOT) ?
+                    2 : 0) + testBit(poolInfo->refBits, idx);
+        case RS_LIRS:
+            return poolInfo->lirs->flags[poolInfo->lirs->frameEntries[idx]];
+        case RS_SIEVE:
+            return testBit(poolInfo->refBits, idx);
+        default:
+            return (pos - part->frameIndex + n) % n;
+    }
+}
+
+/* Frame index paired with its eviction rank, for sorting */
+typedef struct RankedFrame {
+    int idx;
+    int rank;
+} RankedFrame;
+
+static int compareRankDescending(const void *a, const void *b)
+{
+    const RankedFrame *x = (const RankedFrame*)a;
+    const RankedFrame *y = (const RankedFrame*)b;
+    if (x->rank != y->rank) {
+        return (x->rank > y->rank) ? -1 : 1;
+    }
+    return x->idx - y->idx;
+}
+
+static int compareWarmEntries(const void *a, const void *b)
+{
+    const WarmEntry *x = (const WarmEntry*)a;
+    const WarmEntry *y = (const WarmEntry*)b;
+    if (x->fileId != y->fileId) {
+        return (x->fileId < y->fileId) ? -1 : 1;
+    }
+    if (x->pageNum != y->pageNum) {
+        return (x->pageNum < y->pageNum) ? -1 : 1;
+    }
+    return 0;
+}
+
+/*
+ * Writes the resident pages to the warm file, most valuable page first
+ * The file is written next to its final name and renamed, so a crash
+ * during a periodic dump leaves the previous list intact
+ * @return RC_OK on success, error code otherwise
+ */
+static RC writeWarmFile(BM_BufferPool *const bm, BufferPoolInfo *poolInfo)
+{
+    RankedFrame *ranked = (RankedFrame*)malloc(sizeof(RankedFrame) * poolInfo->bufferSize);
+    if (ranked == NULL) {
+        return RC_ERROR;
+    }
+
+    int numResident = 0;
+    for (int i = 0; i < poolInfo->bufferSize; i++) {
+        if (poolInfo->pageNumbers[i] != NO_PAGE) {
+            ranked[numResident].idx = i;
+            ranked[numResident].rank = evictionRank(bm, poolInfo, i);
+            numResident++;
+        }
+    }
+    qsort(ranked, numResident, sizeof(RankedFrame), compareRankDescending);
+
+    char *tmpName = (char*)malloc(strlen(poolInfo->warmFile) + 5);
+    if (tmpName == NULL) {
+        free(ranked);
+        return RC_ERROR;
+    }
+    sprintf(tmpName, "%s.tmp", poolInfo->warmFile);
+
+    FILE *filePtr = fopen(tmpName, "w");
+    if (filePtr == NULL) {
+        free(tmpName);
+        free(ranked);
+        return RC_WRITE_FAILED;
+    }
+
+    fprintf(filePtr, "%s\n%d\n", WARM_FILE_MAGIC, poolInfo->numFiles);
+    for (int i = 0; i < poolInfo->numFiles; i++) {
+        fprintf(filePtr, "%s\n", poolInfo->files[i].fileName);
+    }
+    fprintf(filePtr, "%d\n", numResident);
+    for (int i = 0; i < numResident; i++) {
+        fprintf(filePtr, "%d %d\n", poolInfo->fileIds[ranked[i].idx],
+                poolInfo->pageNumbers[ranked[i].idx]);
+    }
+
+    int failed = ferror(filePtr);
+    failed |= (fclose(filePtr) != 0);
+    if (!failed) {
+        failed = (rename(tmpName, poolInfo->warmFile) != 0);
+    }
+    if (failed) {
+        remove(tmpName);
+    }
+
+    free(tmpName);
+    free(ranked);
+    return failed ? RC_WRITE_FAILED : RC_OK;
+}
+
+/*
+ * Reads one line of a warm file without the trailing newline
+ * @return 1 on success, 0 at end of file or on overlong lines
+ */
+static int readWarmLine(FILE *filePtr, char *line, int size)
+{
+    if (fgets(line, size, filePtr) == NULL) {
+        return 0;
+    }
+    size_t len = strlen(line);
+    if (len == 0 || line[len - 1] != '\n') {
+        return 0;
+    }
+    line[len - 1] = '\0';
+    return 1;
+}
+
+/*
+ * Preload thread: reads the scheduled pages into the staging area using
+ * one read per run of consecutive pages
+ */
+static void *preloadThread(void *arg)
+{
+    WarmLoader *loader = (WarmLoader*)arg;
+    SM_FileHandle fh;
+    FileId openFile = -1;
+    int fileOpen = 0;
+
+    int i = 0;
+    while (i < loader->numEntries) {
+        pthread_mutex_lock(&loader->lock);
+        int stop = loader->stop;
+        pthread_mutex_unlock(&loader->lock);
+        if (stop) {
+            break;
+        }
+
+        /* Collect a run of nearby pages of the same file */
+        PageNumber first = loader->entries[i].pageNum;
+        int runEnd = i + 1;
+        while (runEnd < loader->numEntries &&
+               loader->entries[runEnd].fileId == loader->entries[i].fileId &&
+               loader->entries[runEnd].pageNum - loader->entries[runEnd - 1].pageNum <=
+                   PRELOAD_MAX_GAP + 1 &&
+               loader->entries[runEnd].pageNum - first < PRELOAD_RUN_PAGES) {
+            runEnd++;
+        }
+        int span = loader->entries[runEnd - 1].pageNum - first + 1;
+
+        if (loader->entries[i].fileId != openFile) {
+            openFile = loader->entries[i].fileId;
+            fileOpen = (openPageFile(loader->fileNames[openFile], &fh) == RC_OK);
+        }
+
+        /* Without gaps the run is read straight into its staging slots */
+        int runOk;
+        if (span == runEnd - i) {
+            runOk = fileOpen &&
+                    readBlocks(first, span, &fh, loader->staging + (size_t)i * PAGE_SIZE) == RC_OK;
+        } else {
+            runOk = fileOpen && readBlocks(first, span, &fh, loader->runBuffer) == RC_OK;
+            for (int j = i; runOk && j < runEnd; j++) {
+                memcpy(loader->staging + (size_t)j * PAGE_SIZE,
+                       loader->runBuffer + (size_t)(loader->entries[j].pageNum - first) * PAGE_SIZE,
+                       PAGE_SIZE);
+            }
+        }
+        for (int j = i; j < runEnd; j++) {
+            loader->entries[j].loaded = runOk;
+        }
+
+        pthread_mutex_lock(&loader->lock);
+        loader->numLoaded = runEnd;
+        pthread_mutex_unlock(&loader->lock);
+
+        i = runEnd;
+    }
+
+    pthread_mutex_lock(&loader->lock);
+    loader->numLoaded = loader->numEntries;
+    pthread_mutex_unlock(&loader->lock);
+
+    return NULL;
+}
+
+/*
+ * Stops the preload thread and frees all preload state
+ */
+static void stopPreload(BufferPoolInfo *poolInfo)
+{
+    WarmLoader *loader = poolInfo->warmLoader;
+    if (loader == NULL) {
+        return;
+    }
+
+    if (!loader->joined) {
+        pthread_mutex_lock(&loader->lock);
+        loader->stop = 1;
+        pthread_mutex_unlock(&loader->lock);
+        pthread_join(loader->thread, NULL);
+    }
+
+    pthread_mutex_destroy(&loader->lock);
+    for (int i = 0; i < loader->numFiles; i++) {
+        free(loader->fileNames[i]);
+    }
+    free(loader->fileNames);
+    free(loader->entries);
+    free(loader->staging);
+    free(loader->runBuffer);
+    free(loader);
+    poolInfo->warmLoader = NULL;
+}
+
+/*
+ * Moves pages read by the preload thread into empty frames
+ * Preloaded pages start with the lowest replacement priority, so pages the
+ * workload actually touches are protected ahead of them
+ */
+static void installPreloadedPages(BM_BufferPool *const bm, BufferPoolInfo *poolInfo)
+{
+    WarmLoader *loader = poolInfo->warmLoader;
+
+    pthread_mutex_lock(&loader->lock);
+    int numLoaded = loader->numLoaded;
+    pthread_mutex_unlock(&loader->lock);
+
+    int freeIdx = loader->freeHint;
+    for (; loader->numInstalled < numLoaded; loader->numInstalled++) {
+        WarmEntry *entry = &loader->entries[loader->numInstalled];
+        if (!entry->loaded || entry->skipped ||
+            findFrame(poolInfo, entry->fileId, entry->pageNum) != -1) {
+            continue;
+        }
+
+        while (freeIdx < poolInfo->bufferSize &&
+               poolInfo->pageNumbers[freeIdx] != NO_PAGE) {
+            freeIdx++;
+        }
+        if (freeIdx == poolInfo->bufferSize) {
+            /* The workload filled the pool first */
+            loader->numInstalled = loader->numEntries;
+            break;
+        }
+
+        memcpy(frameData(poolInfo, freeIdx),
+               loader->staging + (size_t)loader->numInstalled * PAGE_SIZE, PAGE_SIZE);
+
+        poolInfo->fileIds[freeIdx] = entry->fileId;
+        poolInfo->pageNumbers[freeIdx] = entry->pageNum;
+        poolInfo->generations[freeIdx]++;
+        poolInfo->recentHits[freeIdx] = 0;
+        clearBit(poolInfo->refBits, freeIdx);
+        poolInfo->usageCounts[freeIdx] = 0;
+        if (poolInfo->clockPro != NULL) {
+            clockProInsert(poolInfo, freeIdx, false);
+        } else if (poolInfo->lirs != NULL) {
+            lirsInsert(poolInfo, freeIdx, false);
+        } else if (bm->strategy == RS_SIEVE) {
+            sieveInsert(poolInfo, freeIdx);
+        } else if (poolInfo->custom != NULL && poolInfo->custom->policy.onInsert != NULL) {
+            poolInfo->custom->policy.onInsert(&poolInfo->custom->view, freeIdx);
+        }
+        if (poolInfo->victim != NULL) {
+            dropVictimPage(poolInfo->victim, entry->fileId, entry->pageNum);
+        }
+        poolInfo->readCount++;
+        poolInfo->preloadCount++;
+        if (poolInfo->stats != NULL) {
+            statAdd(&poolInfo->stats->reads, 1);
+        }
+    }
+
+    loader->freeHint = freeIdx;
+
+    if (loader->numInstalled == loader->numEntries) {
+        stopPreload(poolInfo);
+    }
+}
+
+/*
+ * Excludes a page from preloading because it was read by a regular miss;
+ * the preloaded copy could otherwise overwrite later modifications
+ */
+static void skipPreloadedPage(BufferPoolInfo *poolInfo, FileId fileId, PageNumber pageNum)
+{
+    WarmLoader *loader = poolInfo->warmLoader;
+    WarmEntry key;
+    key.fileId = fileId;
+    key.pageNum = pageNum;
+
+    WarmEntry *entry = (WarmEntry*)bsearch(&key, loader->entries, loader->numEntries,
+                                           sizeof(WarmEntry), compareWarmEntries);
+    if (entry != NULL) {
+        entry->skipped = 1;
+    }
+}
+
+/*
+ * Reads the warm file and starts preloading its most valuable pages
+ * Page files named in the warm file are registered with the pool; a
+ * missing or malformed warm file just leaves the pool cold
+ */
+static void startPreload(BufferPoolInfo *poolInfo)
+{
+    FILE *filePtr = fopen(poolInfo->warmFile, "r");
+    if (filePtr == NULL) {
+        return;
+    }
+
+    char line[1024];
+    int numFiles = 0;
+    int numPages = 0;
+    FileId *fileMap = NULL;
+    WarmLoader *loader = NULL;
+
+    if (!readWarmLine(filePtr, line, sizeof(line)) || strcmp(line, WARM_FILE_MAGIC) != 0 ||
+        !readWarmLine(filePtr, line, sizeof(line)) || sscanf(line, "%d", &numFiles) != 1 ||
+        numFiles < 0) {
+        goto cleanup;
+    }
+
+    fileMap = (FileId*)malloc(sizeof(FileId) * (numFiles + 1));
+    if (fileMap == NULL) {
+        goto cleanup;
+    }
+    for (int i = 0; i < numFiles; i++) {
+        if (!readWarmLine(filePtr, line, sizeof(line))) {
+            goto cleanup;
+        }
+        if (addPageFile(poolInfo, line, &fileMap[i]) != RC_OK) {
+            fileMap[i] = -1;
+        }
+    }
+
+    if (!readWarmLine(filePtr, line, sizeof(line)) || sscanf(line, "%d", &numPages) != 1 ||
+        numPages <= 0) {
+        goto cleanup;
+    }
+    if (numPages > poolInfo->bufferSize) {
+        numPages = poolInfo->bufferSize;
+    }
+
+    loader = (WarmLoader*)calloc(1, sizeof(WarmLoader));
+    if (loader == NULL) {
+        goto cleanup;
+    }
+    loader->entries = (WarmEntry*)calloc(numPages, sizeof(WarmEntry));
+    if (loader->entries == NULL) {
+        goto cleanup;
+    }
+
+    /* Keep the most valuable pages that still exist */
+    for (int i = 0; i < numPages && readWarmLine(filePtr, line, sizeof(line)); i++) {
+        int fileIdx;
+        int pageNum;
+        if (sscanf(line, "%d %d", &fileIdx, &pageNum) != 2 ||
+            fileIdx < 0 || fileIdx >= numFiles || fileMap[fileIdx] == -1 || pageNum < 0 ||
+            pageNum >= poolInfo->files[fileMap[fileIdx]].fh.totalNumPages) {
+            continue;
+        }
+        loader->entries[loader->numEntries].fileId = fileMap[fileIdx];
+        loader->entries[loader->numEntries].pageNum = pageNum;
+        loader->numEntries++;
+    }
+    if (loader->numEntries == 0) {
+        goto cleanup;
+    }
+    qsort(loader->entries, loader->numEntries, sizeof(WarmEntry), compareWarmEntries);
+
+    loader->staging = (char*)malloc((size_t)loader->numEntries * PAGE_SIZE);
+    loader->runBuffer = (char*)malloc((size_t)PRELOAD_RUN_PAGES * PAGE_SIZE);
+    loader->fileNames = (char**)calloc(poolInfo->numFiles, sizeof(char*));
+    if (loader->staging == NULL || loader->runBuffer == NULL || loader->fileNames == NULL) {
+        goto cleanup;
+    }
+    loader->numFiles = poolInfo->numFiles;
+    for (int i = 0; i < poolInfo->numFiles; i++) {
+        loader->fileNames[i] = (char*)malloc(strlen(poolInfo->files[i].fileName) + 1);
+        if (loader->fileNames[i] == NULL) {
+            goto cleanup;
+        }
+        strcpy(loader->fileNames[i], poolInfo->files[i].fileName);
+    }
+
+    if (pthread_mutex_init(&loader->lock, NULL) != 0) {
+        goto cleanup;
+    }
+    if (pthread_create(&loader->thread, NULL, preloadThread, loader) != 0) {
+        pthread_mutex_destroy(&loader->lock);
+        goto cleanup;
+    }
+
+    poolInfo->warmLoader = loader;
+    loader = NULL;
+
+cleanup:
+    if (loader != NULL) {
+        if (loader->fileNames != NULL) {
+            for (int i = 0; i < loader->numFiles; i++) {
+                free(loader->fileNames[i]);
+            }
+        }
+        free(loader->fileNames);
+        free(loader->staging);
+        free(loader->runBuffer);
+        free(loader->entries);
+        free(loader);
+    }
+    free(fileMap);
+    fclose(filePtr);
+}
+
+/*
+ * Frees a pool's resources and its pool information. Every free function
+ * skips parts that were never allocated, so this also undoes a pool whose
+ * initialization failed half way
+ */
+static void freePoolInfo(BufferPoolInfo *poolInfo)
+{
+    freeVictim(poolInfo, false);
+    freeStats(poolInfo);
+    freeShared(poolInfo);
+    freeClockPro(poolInfo);
+    freeLirs(poolInfo);
+    freeAdmission(poolInfo);
+    freeAdaptive(poolInfo);
+    freeCustomPolicy(poolInfo);
+    freePinWait(poolInfo);
+    freeTier(poolInfo);
+    free(poolInfo->partitions);
+    freeFrameArea(poolInfo);
+    freeFileRegistry(poolInfo);
+    free(poolInfo->frameMetadata);
+    free(poolInfo->warmFile);
+    free(poolInfo);
+}
+
+/*
+ * Initializes a new buffer pool
+ * Creates a buffer pool with the specified number of page frames
+ * @param bm - Pointer to buffer pool structure
+ * @param pageFileName - Name of the page file to manage
+ * @param numPages - Number of page frames in the buffer pool
+ * @param strategy - Page replacement strategy to use
+ * @param stratData - Strategy-specific data: for RS_GCLOCK an optional int *
+ *                    holding the maximum usage count (1 to GCLOCK_MAX_COUNT),
+ *                    for RS_CUSTOM the BM_ReplacementPolicy to use
+ * @return RC_OK on success, error code otherwise
+ */
+extern RC initBufferPool(BM_BufferPool *const bm, const char *const pageFileName,
+                         const int numPages, ReplacementStrategy strategy, void *stratData)
+{
+    return initBufferPoolWithOptions(bm, pageFileName, numPages, strategy, stratData, NULL);
+}
+
+/*
+ * Initializes a new buffer pool with optional features
+ * @param bm - Pointer to buffer pool structure
+ * @param pageFileName - Name of the page file to manage
+ * @param numPages - Number of page frames in the buffer pool
+ * @param strategy - Page replacement strategy to use
+ * @param stratData - Strategy-specific data: for RS_GCLOCK an optional int *
+ *                    holding the maximum usage count (1 to GCLOCK_MAX_COUNT),
+ *                    for RS_CUSTOM the BM_ReplacementPolicy to use
+ * @param options - Optional features, NULL for the defaults
+ * @return RC_OK on success, error code otherwise
+ */
+extern RC initBufferPoolWithOptions(BM_BufferPool *const bm, const char *const pageFileName,
+                                    const int numPages, ReplacementStrategy strategy,
+                                    void *stratData, const BM_PoolOptions *const options)
+{
+    if (bm == NULL) {
+        return RC_BUFF_POOL_NOT_FOUND;
+    }
+
+    if (pageFileName == NULL) {
+        return RC_FILE_NOT_FOUND;
+    }
+
+    if (numPages <= 0) {
+        return RC_ERROR;
+    }
+
+    /* Custom policies need at least a victim selection */
+    const BM_ReplacementPolicy *policy = (const BM_ReplacementPolicy*)stratData;
+    if (strategy == RS_CUSTOM && (policy == NULL || policy->pickVictim == NULL)) {
+        return RC_ERROR;
+    }
+
+    int maxUsageCount = GCLOCK_DEFAULT_MAX_COUNT;
+    if (strategy == RS_GCLOCK && stratData != NULL) {
+        maxUsageCount = *(const int*)stratData;
+        if (maxUsageCount < 1 || maxUsageCount > GCLOCK_MAX_COUNT) {
+            return RC_ERROR;
+        }
+    }
+
+    /* Adaptive pools switch between FIFO, LRU and CLOCK only */
+    if (options != NULL && options->adaptiveStrategy &&
+        strategy != RS_FIFO && strategy != RS_LRU && strategy != RS_CLOCK) {
+        return RC_ERROR;
+    }
+
+    if (options != NULL && (options->pinWaitMs < 0 || options->compressedTierBytes < 0 ||
+                            (options->victimCacheFile != NULL && options->victimCachePages <= 0))) {
+        return RC_ERROR;
+    }
+
+    /* Shared pools keep all their state in the segment: strategies whose
+     * state is the frame metadata and the hands, and no per-process features */
+    const char *sharedName = (options != NULL) ? options->sharedPoolName : NULL;
+    if (sharedName != NULL &&
+        ((strategy != RS_FIFO && strategy != RS_LRU && strategy != RS_CLOCK &&
+          strategy != RS_GCLOCK && strategy != RS_SIEVE) ||
+         options->warmFile != NULL || options->numaAware || options->admissionFilter ||
+         options->adaptiveStrategy || options->compressedTierBytes > 0 ||
+         options->victimCacheFile != NULL)) {
+        return RC_ERROR;
+    }
+
+    /* Allocate and initialize buffer pool info structure; every part is
+     * NULL until allocated, so a failure at any step frees what exists */
+    BufferPoolInfo *poolInfo = (BufferPoolInfo*)malloc(sizeof(BufferPoolInfo));
+    if (poolInfo == NULL) {
+        return RC_ERROR;
+    }
+    poolInfo->clockPro = NULL;
+    poolInfo->lirs = NULL;
+    poolInfo->admission = NULL;
+    poolInfo->adaptive = NULL;
+    poolInfo->custom = NULL;
+    poolInfo->pinWait = NULL;
+    poolInfo->tier = NULL;
+    poolInfo->victim = NULL;
+    poolInfo->shared = NULL;
+    poolInfo->stats = NULL;
+    poolInfo->frameMetadata = NULL;
+    poolInfo->frameArea = NULL;
+    poolInfo->frameMemory = FM_HEAP;
+    poolInfo->partitions = NULL;
+    poolInfo->files = NULL;
+    poolInfo->numFiles = 0;
+    poolInfo->fileCapacity = 0;
+    poolInfo->warmFile = NULL;
+
+    RC result = RC_ERROR;
+    char *pageFile = NULL;
+
+    poolInfo->bufferSize = numPages;
+    if (sharedName != NULL) {
+        /* Frames, metadata, hands and lock come from the shared segment */
+        if (attachShared(poolInfo, sharedName, pageFileName, strategy, maxUsageCount,
+                         options->pinWaitMs) != RC_OK) {
+            goto cleanup;
+        }
+    } else {
+        /* Allocate page frames */
+        if (allocFrameMetadata(poolInfo) != RC_OK) {
+            goto cleanup;
+        }
+
+        /* Allocate the memory of all frames at once */
+        if (allocFrameArea(poolInfo, (options != NULL) ? options->frameMemory : FM_AUTO) != RC_OK) {
+            goto cleanup;
+        }
+
+        /* Partition the frames over the NUMA nodes; CLOCK-Pro, LIRS and custom
+         * policies keep their state for the whole pool */
+        bool numaAware = options != NULL && options->numaAware &&
+                         strategy != RS_CLOCK_PRO && strategy != RS_LIRS && strategy != RS_CUSTOM;
+        if (initPartitions(poolInfo, numaAware) != RC_OK) {
+            goto cleanup;
+        }
+    }
+
+    if ((strategy == RS_CLOCK_PRO && allocClockPro(poolInfo) != RC_OK) ||
+        (strategy == RS_CUSTOM && allocCustomPolicy(poolInfo, policy) != RC_OK) ||
+        (strategy == RS_LIRS && allocLirs(poolInfo) != RC_OK) ||
+        (options != NULL && options->admissionFilter && allocAdmission(poolInfo) != RC_OK) ||
+        (options != NULL && options->adaptiveStrategy && allocAdaptive(poolInfo) != RC_OK) ||
+        (options != NULL && options->pinWaitMs > 0 && sharedName == NULL &&
+         allocPinWait(poolInfo, options->pinWaitMs) != RC_OK) ||
+        (options != NULL && options->compressedTierBytes > 0 &&
+         allocTier(poolInfo, options->compressedTierBytes) != RC_OK)) {
+        goto cleanup;
+    }
+
+    /* Initialize buffer pool metadata */
+    poolInfo->readCount = 0;
+    poolInfo->writeCount = 0;
+    poolInfo->bytesWritten = 0;
+    poolInfo->bytesSaved = 0;
+    poolInfo->recentHitCount = 0;
+    poolInfo->maxUsageCount = maxUsageCount;
+    poolInfo->localHits = 0;
+    poolInfo->remoteHits = 0;
+    poolInfo->pinStalls = 0;
+    poolInfo->pinTimeouts = 0;
+    poolInfo->warmSaveInterval = 0;
+    poolInfo->pinsSinceWarmSave = 0;
+    poolInfo->preloadCount = 0;
+    poolInfo->warmLoader = NULL;
+
+    /* Register the pool's own page file as file 0 */
+    FileId defaultFile;
+    lockPool(poolInfo);
+    RC fileResult = addPageFile(poolInfo, pageFileName, &defaultFile);
+    unlockPool(poolInfo);
+    if (fileResult != RC_OK) {
+        result = fileResult;
+        goto cleanup;
+    }
+
+    pageFile = (char*)malloc(strlen(pageFileName) + 1);
+    if (pageFile == NULL) {
+        goto cleanup;
+    }
+    strcpy(pageFile, pageFileName);
+
+    /* Publish live statistics for monitors such as bmtop */
+    if (options != NULL && options->statsName != NULL &&
+        allocStats(poolInfo, options->statsName, pageFileName, numPages, strategy) != RC_OK) {
+        goto cleanup;
+    }
+
+    /* Open the victim cache; its index may register more page files */
+    if (options != NULL && options->victimCacheFile != NULL &&
+        allocVictim(poolInfo, options->victimCacheFile, options->victimCachePages) != RC_OK) {
+        goto cleanup;
+    }
+
+    /* Preload the hot page set of the previous run in the background */
+    if (options != NULL && options->warmFile != NULL) {
+        poolInfo->warmFile = (char*)malloc(strlen(options->warmFile) + 1);
+        if (poolInfo->warmFile == NULL) {
+            goto cleanup;
+        }
+        strcpy(poolInfo->warmFile, options->warmFile);
+        poolInfo->warmSaveInterval = options->warmSaveInterval;
+        startPreload(poolInfo);
+    }
+
+    /* Set buffer pool attributes */
+    bm->pageFile = pageFile;
+    bm->numPages = numPages;
+    bm->strategy = strategy;
+    bm->mgmtData = poolInfo;
+
+    return RC_OK;
+
+cleanup:
+    free(pageFile);
+    freePoolInfo(poolInfo);
+    return result;
+}
+
+/*
+ * Shuts down the buffer pool
+ * Writes all dirty pages to disk and frees all resources
+ * @param bm - Pointer to buffer pool
+ * @return RC_OK on success, error code otherwise
+ */
+extern RC shutdownBufferPool(BM_BufferPool *const bm)
+{
+    if (bm == NULL) {
+        return RC_BUFF_POOL_NOT_FOUND;
+    }
+
+    BufferPoolInfo *poolInfo = getPoolInfo(bm);
+    if (poolInfo == NULL) {
+        return RC_ERROR;
+    }
+
+    /* Flush all dirty pages; a process leaving a shared pool leaves them to
+     * the processes still attached, the last one flushes */
+    RC result = (poolInfo->shared != NULL) ? leaveSharedPool(poolInfo) : forceFlushPool(bm);
+    if (result != RC_OK) {
+        return result;
+    }
+
+    /* Check for pinned pages */
+    for (int i = 0; poolInfo->admission != NULL && i < ADMISSION_BYPASS_FRAMES; i++) {
+        if (poolInfo->admission->bypass[i].fixCount != 0) {
+            return RC_PINNED_PAGES_IN_BUFFER;
+        }
+    }
+    for (int i = 0; poolInfo->shared == NULL && i < poolInfo->bufferSize; i++) {
+        if (poolInfo->fixCounts[i] != 0) {
+            return RC_PINNED_PAGES_IN_BUFFER;
+        }
+    }
+
+    /* Remember the hot page set for the next run */
+    stopPreload(poolInfo);
+    if (poolInfo->warmFile != NULL) {
+        writeWarmFile(bm, poolInfo);
+    }
+    freeVictim(poolInfo, true);
+
+    /* Free pool resources */
+    freePoolInfo(poolInfo);
+    free(bm->pageFile);
+
+    bm->mgmtData = NULL;
+
+    return RC_OK;
+}
+
+/*
+ * Writes all dirty pages (not pinned) to disk
+ * The warm file is rewritten too once warmSaveInterval pins went by
+ * @param bm - Pointer to buffer pool
+ * @return RC_OK on success, error code otherwise
+ */
+extern RC forceFlushPool(BM_BufferPool *const bm)
+{
+    if (bm == NULL) {
+        return RC_BUFF_POOL_NOT_FOUND;
+    }
+
+    BufferPoolInfo *poolInfo = getPoolInfo(bm);
+    if (poolInfo == NULL) {
+        return RC_ERROR;
+    }
+
+    lockPool(poolInfo);
+    RC result = flushFramesLocked(poolInfo);
+    if (result == RC_OK && poolInfo->warmFile != NULL && poolInfo->warmSaveInterval > 0 &&
+        poolInfo->pinsSinceWarmSave >= poolInfo->warmSaveInterval) {
+        poolInfo->pinsSinceWarmSave = 0;
+        writeWarmFile(bm, poolInfo);
+    }
+    unlockPool(poolInfo);
+
+    return result;
+}
+
+/*
+ * Marks sectors of a pinned page as modified
+ * Pages in bypass frames are always written back whole
+ * @param sectors - Sector mask to add to the frame's dirty sectors
+ * @return RC_OK on success, RC_ERROR if the page is not in the buffer,
+ *         RC_PAGE_NOT_PINNED for a stale handle
+ */
+static RC markSectorsDirty(BufferPoolInfo *poolInfo, BM_PageHandle *const page,
+                           unsigned int sectors)
+{
+    RC result = RC_OK;
+    lockPool(poolInfo);
+    int idx = handleFrame(poolInfo, page);
+    if (idx == STALE_HANDLE) {
+        result = RC_PAGE_NOT_PINNED;
+    } else if (idx != -1) {
+        setBit(poolInfo->dirtyBits, idx);
+        poolInfo->dirtySectors[idx] |= sectors;
+    } else {
+        BypassFrame *bypass = findBypassFrame(poolInfo, page->fileId, page->pageNum);
+        if (bypass != NULL) {
+            bypass->dirty = 1;
+        } else {
+            result = RC_ERROR;
+        }
+    }
+    unlockPool(poolInfo);
+
+    return result;
+}
+
+/*
+ * Marks a page as dirty
+ * @param bm - Pointer to buffer pool
+ * @param page - Page handle to mark as dirty
+ * @return RC_OK on success, RC_PAGE_NOT_PINNED for a stale handle,
+ *         error code otherwise
+ */
+extern RC markDirty(BM_BufferPool *const bm, BM_PageHandle *const page)
+{
+    if (bm == NULL) {
+        return RC_BUFF_POOL_NOT_FOUND;
+    }
+
+    if (page == NULL) {
+        return RC_ERROR;
+    }
+
+    BufferPoolInfo *poolInfo = getPoolInfo(bm);
+    if (poolInfo == NULL) {
+        return RC_ERROR;
+    }
+
+    return markSectorsDirty(poolInfo, page, ALL_SECTORS);
+}
+
+/*
+ * Marks a byte range of a page as dirty
+ * Write-back of a page modified only through ranges writes just the
+ * SECTOR_SIZE sectors they touch
+ * @param bm - Pointer to buffer pool
+ * @param page - Page handle to mark as dirty
+ * @param offset - First modified byte of the page
+ * @param length - Number of modified bytes, at least 1
+ * @return RC_OK on success, RC_ERROR if the range is outside the page,
+ *         error code otherwise
+ */
+extern RC markDirtyRange(BM_BufferPool *const bm, BM_PageHandle *const page,
+                         const int offset, const int length)
+{
+    if (bm == NULL) {
+        return RC_BUFF_POOL_NOT_FOUND;
+    }
+
+    if (page == NULL || offset < 0 || length <= 0 || length > PAGE_SIZE - offset) {
+        return RC_ERROR;
+    }
+
+    BufferPoolInfo *poolInfo = getPoolInfo(bm);
+    if (poolInfo == NULL) {
+        return RC_ERROR;
+    }
+
+    int first = offset / SECTOR_SIZE;
+    int last = (offset + length - 1) / SECTOR_SIZE;
+    unsigned int sectors = ((ALL_SECTORS >> first) << first) &
+                           (ALL_SECTORS >> (SECTORS_PER_PAGE - 1 - last));
+    return markSectorsDirty(poolInfo, page, sectors);
+}
+
+/*
+ * Unpins a page with the pool lock held, if the pool has one
+ * @return RC_OK on success, error code otherwise
+ */
+static RC unpinPageLocked(BufferPoolInfo *poolInfo, BM_PageHandle *const page)
+{
+    /* Find and unpin the page; a second unpin of a pin is an error */
+    int idx = handleFrame(poolInfo, page);
+    if (idx == STALE_HANDLE) {
+        return RC_PAGE_NOT_PINNED;
+    }
+    if (idx != -1) {
+        /* Pins of a shared pool belong to the process that took them */
+        if (poolInfo->fixCounts[idx] == 0 ||
+            (poolInfo->shared != NULL && poolInfo->shared->pins[idx] == 0)) {
+            return RC_PAGE_NOT_PINNED;
+        }
+        unpinFrame(poolInfo, idx);
+        if (poolInfo->custom != NULL && poolInfo->custom->policy.onUnpin != NULL) {
+            poolInfo->custom->policy.onUnpin(&poolInfo->custom->view, idx);
+        }
+        /* Wake pins waiting for an evictable frame */
+        if (poolInfo->pinWait != NULL && poolInfo->fixCounts[idx] == 0) {
+            pthread_cond_broadcast(&poolInfo->pinWait->unpinned);
+        }
+        return RC_OK;
+    }
+
+    /* A page rejected by the admission filter leaves with its last pin */
+    BypassFrame *bypass = findBypassFrame(poolInfo, page->fileId, page->pageNum);
+    if (bypass != NULL && --bypass->fixCount == 0) {
+        RC result = bypass->dirty ? writeBackBypassFrame(poolInfo, bypass) : RC_OK;
+        bypass->pageNum = NO_PAGE;
+        return result;
+    }
+
+    return RC_OK;
+}
+
+/*
+ * Unpins a page, decrementing its pin count
+ * @param bm - Pointer to buffer pool
+ * @param page - Page handle to unpin
+ * @return RC_OK on success, RC_PAGE_NOT_PINNED if the page is cached but
+ *         has no pin left or the handle's pin ended with an eviction
+ */
+extern RC unpinPage(BM_BufferPool *const bm, BM_PageHandle *const page)
+{
+    if (bm == NULL) {
+        return RC_BUFF_POOL_NOT_FOUND;
+    }
+
+    if (page == NULL) {
+        return RC_ERROR;
+    }
+
+    BufferPoolInfo *poolInfo = getPoolInfo(bm);
+    if (poolInfo == NULL) {
+        return RC_ERROR;
+    }
+
+    lockPool(poolInfo);
+    RC result = unpinPageLocked(poolInfo, page);
+    unlockPool(poolInfo);
+    return result;
+}
+
+/*
+ * Forces a specific page to be written to disk
+ * @param bm - Pointer to buffer pool
+ * @param page - Page handle to write
+ * @return RC_OK on success, RC_PAGE_NOT_PINNED for a stale handle,
+ *         error code otherwise
+ */
+extern RC forcePage(BM_BufferPool *const bm, BM_PageHandle *const page)
+{
+    if (bm == NULL) {
+        return RC_BUFF_POOL_NOT_FOUND;
+    }
+
+    if (page == NULL) {
+        return RC_ERROR;
+    }
+
+    BufferPoolInfo *poolInfo = getPoolInfo(bm);
+    if (poolInfo == NULL) {
+        return RC_ERROR;
+    }
+
+    /* Find and write the page */
+    RC result = RC_OK;
+    lockPool(poolInfo);
+    int idx = handleFrame(poolInfo, page);
+    if (getFileHandle(poolInfo, page->fileId) == NULL) {
+        result = RC_FILE_NOT_FOUND;
+    } else if (idx == STALE_HANDLE) {
+        result = RC_PAGE_NOT_PINNED;
+    } else if (idx != -1) {
+        result = writeBackFrame(poolInfo, idx);
+    } else {
+        BypassFrame *bypass = findBypassFrame(poolInfo, page->fileId, page->pageNum);
+        if (bypass != NULL) {
+            result = writeBackBypassFrame(poolInfo, bypass);
+        }
+    }
+    unlockPool(poolInfo);
+
+    return result;
+}
+
+/*
+ * Pins a page of the pool's own page file in the buffer pool
+ * Loads the page from disk if not already in buffer
+ * @param bm - Pointer to buffer pool
+ * @param page - Page handle to populate
+ * @param pageNum - Page number to pin
+ * @return RC_OK on success, error code otherwise
+ */
+extern RC pinPage(BM_BufferPool *const bm, BM_PageHandle *const page, const PageNumber pageNum)
+{
+    return pinFilePage(bm, page, DEFAULT_FILE_ID, pageNum);
+}
+
+/*
+ * Pins a page of the pool's own page file with a replacement hint
+ * @param hint - PH_KEEP to protect the page, PH_EVICT_SOON for a page that
+ *               will not be used again, PH_NORMAL for the plain pinPage
+ * @return RC_OK on success, RC_ERROR for an unknown hint, error code otherwise
+ */
+extern RC pinPageWithHint(BM_BufferPool *const bm, BM_PageHandle *const page,
+                          const PageNumber pageNum, const PinHint hint)
+{
+    return pinFilePageWithHint(bm, page, DEFAULT_FILE_ID, pageNum, hint);
+}
+
+/*
+ * Registers an additional page file with the buffer pool
+ * The file is opened once and cached pages of all registered files share
+ * the pool's frames and replacement strategy
+ * @param bm - Pointer to buffer pool
+ * @param pageFileName - Name of the page file to register
+ * @param fileId - Receives the id used to pin pages of this file
+ * @return RC_OK on success, error code otherwise
+ */
+extern RC registerPageFile(BM_BufferPool *const bm, const char *const pageFileName,
+                           FileId *fileId)
+{
+    if (bm == NULL) {
+        return RC_BUFF_POOL_NOT_FOUND;
+    }
+
+    if (pageFileName == NULL) {
+        return RC_FILE_NOT_FOUND;
+    }
+
+    if (fileId == NULL) {
+        return RC_ERROR;
+    }
+
+    BufferPoolInfo *poolInfo = getPoolInfo(bm);
+    if (poolInfo == NULL) {
+        return RC_ERROR;
+    }
+
+    lockPool(poolInfo);
+    RC result = addPageFile(poolInfo, pageFileName, fileId);
+    unlockPool(poolInfo);
+    return result;
+}
+
+/*
+ * Maps a pin hint to the replacement metadata of a frame just hit or loaded
+ * PH_KEEP gives LRU a timestamp one pool turnover ahead, sets the CLOCK
+ * reference bit, lets the FIFO hand skip the frame once and saturates the
+ * GCLOCK count. PH_EVICT_SOON makes the frame the least recently used or
+ * clears its bit or count; a victim frame reloaded with it is put under the
+ * FIFO or CLOCK hand again, so one-shot pages recycle a single frame
+ * @param reused - Whether the frame was just taken from an evicted page
+ */
+static void applyPinHint(BM_BufferPool *const bm, BufferPoolInfo *poolInfo, int idx,
+                         PinHint hint, bool reused)
+{
+    if (hint == PH_NORMAL) {
+        return;
+    }
+
+    bool keep = hint == PH_KEEP;
+    bool adaptive = poolInfo->adaptive != NULL;
+    if (bm->strategy == RS_LRU || adaptive) {
+        poolInfo->recentHits[idx] = keep ? poolInfo->recentHitCount + poolInfo->bufferSize : 0;
+    }
+    if (bm->strategy == RS_CLOCK || adaptive) {
+        if (keep) {
+            setBit(poolInfo->refBits, idx);
+        } else {
+            clearBit(poolInfo->refBits, idx);
+        }
+    }
+    if (bm->strategy == RS_FIFO || adaptive) {
+        if (keep) {
+            setBit(poolInfo->keepBits, idx);
+        } else {
+            clearBit(poolInfo->keepBits, idx);
+        }
+    }
+    if (bm->strategy == RS_GCLOCK) {
+        poolInfo->usageCounts[idx] = keep ? poolInfo->maxUsageCount : 0;
+    }
+
+    if (reused && !keep) {
+        PoolPartition *part = partitionOfFrame(poolInfo, idx);
+        if (bm->strategy == RS_FIFO) {
+            part->frameIndex = idx - part->firstFrame;
+        } else if (bm->strategy == RS_CLOCK || bm->strategy == RS_GCLOCK) {
+            part->clockPointer = idx - part->firstFrame;
+        }
+    }
+}
+
+/*
+ * Pins a page with the pool lock held, if the pool has one
+ * Loads the page into an empty frame or the strategy's victim on a miss
+ * @param fh - Open handle of the page's file
+ * @return RC_OK on success, RC_ALL_FRAMES_PINNED if no frame can be
+ *         evicted, error code otherwise
+ */
+static RC pinPageLocked(BM_BufferPool *const bm, BufferPoolInfo *poolInfo,
+                        BM_PageHandle *const page, SM_FileHandle *fh,
+                        const FileId fileId, const PageNumber pageNum, const PinHint hint)
+{
+    uint64_t pinStart = TRACE_CLOCK();
+
+    /* Check if page is already in buffer */
+    int hitIdx = findFrame(poolInfo, fileId, pageNum);
+    if (hitIdx != -1) {
+        pinFrame(poolInfo, hitIdx);
+        poolInfo->recentHitCount++;
+        publishPin(poolInfo, true);
+        TRACE_PIN_HIT(fileId, pageNum, hitIdx, TRACE_CLOCK() - pinStart);
+
+        if (poolInfo->numPartitions == 1 ||
+            partitionOfFrame(poolInfo, hitIdx) == localPartition(poolInfo)) {
+            poolInfo->localHits++;
+        } else {
+            poolInfo->remoteHits++;
+        }
+
+        /* Adaptive pools keep the metadata of every candidate current */
+        bool adaptive = poolInfo->adaptive != NULL;
+        if (bm->strategy == RS_CLOCK || bm->strategy == RS_CLOCK_PRO ||
+            bm->strategy == RS_SIEVE || adaptive) {
+            setBit(poolInfo->refBits, hitIdx);
+        } else if (bm->strategy == RS_GCLOCK) {
+            if (poolInfo->usageCounts[hitIdx] < poolInfo->maxUsageCount) {
+                poolInfo->usageCounts[hitIdx]++;
+            }
+        } else if (bm->strategy == RS_LIRS) {
+            lirsHit(poolInfo, hitIdx);
+        }
+        if (bm->strategy == RS_LRU || adaptive) {
+            poolInfo->recentHits[hitIdx] = poolInfo->recentHitCount;
+        }
+        if (poolInfo->custom != NULL && poolInfo->custom->policy.onHit != NULL) {
+            poolInfo->custom->policy.onHit(&poolInfo->custom->view, hitIdx);
+        }
+        applyPinHint(bm, poolInfo, hitIdx, hint, false);
+
+        page->fileId = fileId;
+        page->pageNum = pageNum;
+        page->data = frameData(poolInfo, hitIdx);
+        page->frame = hitIdx;
+        page->generation = poolInfo->generations[hitIdx];
+        page->pinnedPageNum = pageNum;
+        page->pinnedFileId = fileId;
+        return RC_OK;
+    }
+
+    BypassFrame *bypass = findBypassFrame(poolInfo, fileId, pageNum);
+    if (bypass != NULL) {
+        bypass->fixCount++;
+        publishPin(poolInfo, true);
+        TRACE_PIN_HIT(fileId, pageNum, -1, TRACE_CLOCK() - pinStart);
+        page->fileId = fileId;
+        page->pageNum = pageNum;
+        page->data = bypass->data;
+        page->frame = -1;
+        return RC_OK;
+    }
+
+    if (poolInfo->warmLoader != NULL) {
+        skipPreloadedPage(poolInfo, fileId, pageNum);
+    }
+
+    /* Page not in buffer - find empty frame or use replacement strategy,
+     * starting with the partition on the caller's NUMA node */
+    PoolPartition *local = localPartition(poolInfo);
+    int idx = -1;
+    bool filling = true;
+    for (int p = 0; p < poolInfo->numPartitions && idx == -1; p++) {
+        PoolPartition *part = &poolInfo->partitions[(local - poolInfo->partitions + p) %
+                                                    poolInfo->numPartitions];
+        idx = scanFindPage(poolInfo->pageNumbers, part->firstFrame,
+                           part->firstFrame + part->numFrames, NO_PAGE);
+    }
+
+    if (idx == -1) {
+        for (int p = 0; p < poolInfo->numPartitions && idx == -1; p++) {
+            PoolPartition *part = &poolInfo->partitions[(local - poolInfo->partitions + p) %
+                                                        poolInfo->numPartitions];
+            switch (bm->strategy) {
+                case RS_FIFO:
+                    idx = FIFO(bm, part);
+                    break;
+                case RS_LRU:
+                    idx = LRU(bm, part);
+                    break;
+                case RS_CLOCK:
+                    idx = CLOCK(bm, part);
+                    break;
+                case RS_GCLOCK:
+                    idx = GCLOCK(bm, part);
+                    break;
+                case RS_CLOCK_PRO:
+                    idx = CLOCK_PRO(bm, part);
+                    break;
+                case RS_LIRS:
+                    idx = LIRS(bm, part);
+                    break;
+                case RS_SIEVE:
+                    idx = SIEVE(bm, part);
+                    break;
+                case RS_CUSTOM:
+                    idx = customVictim(poolInfo);
+                    break;
+                default:
+                    return RC_ERROR;
+            }
+        }
+
+        if (idx == -1) {
+            return RC_ALL_FRAMES_PINNED;
+        }
+
+        /* Serve a page less popular than the victim without caching it */
+        if (poolInfo->admission != NULL &&
+            !admitPage(poolInfo, fileId, pageNum, idx)) {
+            return pinBypassPage(poolInfo, page, fh, fileId, pageNum);
+        }
+
+        TRACE_EVICT(poolInfo->fileIds[idx], poolInfo->pageNumbers[idx], idx,
+                    testBit(poolInfo->dirtyBits, idx));
+
+        /* Evict the victim into the compressed tier, where it stays modified,
+         * or write it back if it was modified */
+        int stored = 0;
+        if (poolInfo->tier != NULL) {
+            stored = storeCompressedPage(poolInfo->tier, poolInfo->fileIds[idx],
+                                             poolInfo->pageNumbers[idx], frameData(poolInfo, idx),
+                                             testBit(poolInfo->dirtyBits, idx),
+                                             writeBackTierPage, poolInfo);
+            if (stored < 0) {
+                return RC_WRITE_BACK_FAILED;
+            }
+            if (stored == 1) {
+                clearBit(poolInfo->dirtyBits, idx);
+                poolInfo->dirtySectors[idx] = 0;
+            }
+        }
+        if (testBit(poolInfo->dirtyBits, idx) && writeBackFrame(poolInfo, idx) != RC_OK) {
+            return RC_WRITE_BACK_FAILED;
+        }
+
+        /* Pages the tier did not keep are clean now: copy them to the victim cache */
+        if (poolInfo->victim != NULL && (poolInfo->tier == NULL || stored != 1)) {
+            storeVictimPage(poolInfo->victim, poolInfo->fileIds[idx], poolInfo->pageNumbers[idx],
+                            frameData(poolInfo, idx));
+        }
+        if (poolInfo->custom != NULL && poolInfo->custom->policy.onEvict != NULL) {
+            poolInfo->custom->policy.onEvict(&poolInfo->custom->view, idx);
+        }
+        markMissFrame(poolInfo, idx);
+        poolInfo->pageNumbers[idx] = NO_PAGE;
+        if (poolInfo->clockPro != NULL) {
+            clockProEvict(poolInfo, idx);
+        } else if (poolInfo->lirs != NULL) {
+            lirsEvict(poolInfo, idx);
+        } else if (bm->strategy == RS_SIEVE) {
+            sieveEvict(poolInfo, idx);
+        }
+        if (poolInfo->stats != NULL) {
+            statAdd(&poolInfo->stats->evictions, 1);
+        }
+        filling = false;
+    }
+
+    bool dirty;
+    markMissFrame(poolInfo, idx);
+    if (loadPage(poolInfo, fh, fileId, pageNum, frameData(poolInfo, idx), &dirty) != RC_OK) {
+        markMissFrame(poolInfo, -1);
+        return RC_READ_NON_EXISTING_PAGE;
+    }
+
+    poolInfo->fileIds[idx] = fileId;
+    poolInfo->pageNumbers[idx] = pageNum;
+    poolInfo->generations[idx]++;
+    poolInfo->fixCounts[idx] = 0;
+    pinFrame(poolInfo, idx);
+    if (dirty) {
+        setBit(poolInfo->dirtyBits, idx);
+        poolInfo->dirtySectors[idx] = ALL_SECTORS;
+    } else {
+        clearBit(poolInfo->dirtyBits, idx);
+        poolInfo->dirtySectors[idx] = 0;
+    }
+    poolInfo->recentHitCount++;
+    publishPin(poolInfo, false);
+    TRACE_PIN_MISS(fileId, pageNum, idx, TRACE_CLOCK() - pinStart);
+
+    bool adaptive = poolInfo->adaptive != NULL;
+    if (bm->strategy == RS_CLOCK || adaptive) {
+        clearBit(poolInfo->refBits, idx);
+    } else if (bm->strategy == RS_GCLOCK) {
+        poolInfo->usageCounts[idx] = 0;
+    } else if (bm->strategy == RS_CLOCK_PRO) {
+        clearBit(poolInfo->refBits, idx);
+        clockProInsert(poolInfo, idx, filling);
+    } else if (bm->strategy == RS_LIRS) {
+        lirsInsert(poolInfo, idx, true);
+    } else if (bm->strategy == RS_SIEVE) {
+        clearBit(poolInfo->refBits, idx);
+        sieveInsert(poolInfo, idx);
+    }
+    if (bm->strategy == RS_LRU || adaptive) {
+        poolInfo->recentHits[idx] = poolInfo->recentHitCount;
+    }
+    if (poolInfo->custom != NULL && poolInfo->custom->policy.onInsert != NULL) {
+        poolInfo->custom->policy.onInsert(&poolInfo->custom->view, idx);
+    }
+    clearBit(poolInfo->keepBits, idx);
+    applyPinHint(bm, poolInfo, idx, hint, !filling);
+    markMissFrame(poolInfo, -1);
+
+    page->fileId = fileId;
+    page->pageNum = pageNum;
+    page->data = frameData(poolInfo, idx);
+    page->frame = idx;
+    page->generation = poolInfo->generations[idx];
+    page->pinnedPageNum = pageNum;
+    page->pinnedFileId = fileId;
+    return RC_OK;
+}
+
+/*
+ * Pins a page of a registered page file in the buffer pool
+ * Loads the page from disk if not already in buffer
+ * @param bm - Pointer to buffer pool
+ * @param page - Page handle to populate
+ * @param fileId - Id of the page file, as returned by registerPageFile
+ * @param pageNum - Page number to pin
+ * @return RC_OK on success, RC_ALL_FRAMES_PINNED if every frame stayed
+ *         pinned (for up to pinWaitMs), error code otherwise
+ */
+extern RC pinFilePage(BM_BufferPool *const bm, BM_PageHandle *const page,
+                      const FileId fileId, const PageNumber pageNum)
+{
+    return pinFilePageWithHint(bm, page, fileId, pageNum, PH_NORMAL);
+}
+
+/*
+ * Pins a page of a registered page file with a replacement hint
+ * FIFO, LRU, CLOCK and GCLOCK place the frame by the hint, both on a hit
+ * and on a miss; the other strategies ignore it
+ * @param hint - PH_KEEP to protect the page, PH_EVICT_SOON for a page that
+ *               will not be used again, PH_NORMAL for the plain pinFilePage
+ * @return RC_OK on success, RC_ERROR for an unknown hint, error code otherwise
+ */
+extern RC pinFilePageWithHint(BM_BufferPool *const bm, BM_PageHandle *const page,
+                              const FileId fileId, const PageNumber pageNum,
+                              const PinHint hint)
+{
+    if (bm == NULL) {
+        return RC_BUFF_POOL_NOT_FOUND;
+    }
+
+    if (page == NULL || hint < PH_NORMAL || hint > PH_EVICT_SOON) {
+        return RC_ERROR;
+    }
+
+    BufferPoolInfo *poolInfo = getPoolInfo(bm);
+    if (poolInfo == NULL) {
+        return RC_ERROR;
+    }
+
+    lockPool(poolInfo);
+    SM_FileHandle *fh = getFileHandle(poolInfo, fileId);
+    if (fh == NULL) {
+        unlockPool(poolInfo);
+        return RC_FILE_NOT_FOUND;
+    }
+
+    /* forceFlushPool() rewrites the warm file once enough pins went by */
+    poolInfo->pinsSinceWarmSave++;
+
+    if (poolInfo->warmLoader != NULL) {
+        installPreloadedPages(bm, poolInfo);
+    }
+
+    if (poolInfo->admission != NULL) {
+        incrementFrequency(&poolInfo->admission->sketch, pageKey(fileId, pageNum));
+    }
+
+    if (poolInfo->adaptive != NULL) {
+        adaptiveAccess(bm, poolInfo, fileId, pageNum);
+    }
+
+    RC result = pinPageLocked(bm, poolInfo, page, fh, fileId, pageNum, hint);
+
+    /* Pins of processes that died are given back before anyone waits */
+    if (result == RC_ALL_FRAMES_PINNED && poolInfo->shared != NULL &&
+        reclaimDeadProcesses(poolInfo, false) > 0) {
+        result = pinPageLocked(bm, poolInfo, page, fh, fileId, pageNum, hint);
+    }
+
+    /* Every frame is pinned: wait for an unpin if the pool allows it */
+    if (result == RC_ALL_FRAMES_PINNED) {
+        poolInfo->pinStalls++;
+        PinWait *pinWait = poolInfo->pinWait;
+        if (pinWait != NULL) {
+            struct timespec deadline;
+            clock_gettime(CLOCK_MONOTONIC, &deadline);
+            deadline.tv_sec += pinWait->timeoutMs / 1000;
+            deadline.tv_nsec += (long)(pinWait->timeoutMs % 1000) * 1000000L;
+            if (deadline.tv_nsec >= 1000000000L) {
+                deadline.tv_sec++;
+                deadline.tv_nsec -= 1000000000L;
+            }
+            while (result == RC_ALL_FRAMES_PINNED && waitForUnpin(poolInfo, &deadline)) {
+                /* Registering a file while we waited may have moved the handle */
+                fh = getFileHandle(poolInfo, fileId);
+                result = pinPageLocked(bm, poolInfo, page, fh, fileId, pageNum, hint);
+            }
+        }
+        if (result == RC_ALL_FRAMES_PINNED) {
+            poolInfo->pinTimeouts++;
+        }
+    }
+
+    unlockPool(poolInfo);
+    return result;
+}
+
+/*
+ * Writes the list of resident pages to the pool's warm file now
+ * Pages are listed most valuable first according to the replacement strategy
+ * @param bm - Pointer to buffer pool
+ * @return RC_OK on success, RC_ERROR if the pool has no warm file
+ */
+extern RC saveWarmFile(BM_BufferPool *const bm)
+{
+    if (bm == NULL) {
+        return RC_BUFF_POOL_NOT_FOUND;
+    }
+
+    BufferPoolInfo *poolInfo = getPoolInfo(bm);
+    if (poolInfo == NULL || poolInfo->warmFile == NULL) {
+        return RC_ERROR;
+    }
+
+    poolInfo->pinsSinceWarmSave = 0;
+    return writeWarmFile(bm, poolInfo);
+}
+
+/*
+ * Waits for the background preload to finish and installs its pages
+ * @param bm - Pointer to buffer pool
+ * @return RC_OK on success, error code otherwise
+ */
+extern RC finishPreload(BM_BufferPool *const bm)
+{
+    if (bm == NULL) {
+        return RC_BUFF_POOL_NOT_FOUND;
+    }
+
+    BufferPoolInfo *poolInfo = getPoolInfo(bm);
+    if (poolInfo == NULL) {
+        return RC_ERROR;
+    }
+
+    if (poolInfo->warmLoader != NULL) {
+        pthread_join(poolInfo->warmLoader->thread, NULL);
+        poolInfo->warmLoader->joined = 1;
+        installPreloadedPages(bm, poolInfo);
+    }
+
+    return RC_OK;
+}
+
+/*
+ * FIFO page replacement strategy
+ * Selects the oldest unpinned page in a partition, testing the pinned
+ * bitmap 64 frames at a time
+ * @param bm - Pointer to buffer pool
+ * @param part - Partition to select the victim from
+ * @return Index of the victim frame, or -1 if all frames are pinned
+ */
+static int FIFO(BM_BufferPool *const bm, PoolPartition *part)
+{
+    BufferPoolInfo *poolInfo = getPoolInfo(bm);
+    if (poolInfo == NULL) {
+        return -1;
+    }
+
+    int end = part->firstFrame + part->numFrames;
+    int maxScan = part->numFrames * 2; /* Kept frames are skipped once */
+
+    /* Find next frame to replace */
+    for (int scanned = 0; scanned < maxScan; ) {
+        int idx = part->firstFrame + part->frameIndex;
+        int base = idx & ~63;
+        int segEnd = wordSegmentEnd(idx, end);
+        uint64_t *keepWord = &poolInfo->keepBits[idx >> 6];
+        uint64_t unpinned = ~poolInfo->pinnedBits[idx >> 6] &
+                            rangeMask(idx - base, segEnd - base);
+        uint64_t candidates = unpinned & ~*keepWord;
+
+        if (candidates != 0) {
+            /* Kept frames passed on the way lose their protection */
+            int victim = base + lowestBit(candidates);
+            *keepWord &= ~(unpinned & rangeMask(idx - base, victim - base));
+            part->frameIndex = (victim + 1 - part->firstFrame) % part->numFrames;
+            return victim;
+        }
+
+        *keepWord &= ~unpinned;
+        scanned += segEnd - idx;
+        part->frameIndex = (segEnd - part->firstFrame) % part->numFrames;
+    }
+
+    return -1;
+}
+
+/*
+ * LRU page replacement strategy
+ * Selects the least recently used unpinned page in a partition
+ * @param bm - Pointer to buffer pool
+ * @param part - Partition to select the victim from
+ * @return Index of the victim frame, or -1 if all frames are pinned
+ */
+static int LRU(BM_BufferPool *const bm, PoolPartition *part)
+{
+    BufferPoolInfo *poolInfo = getPoolInfo(bm);
+    if (poolInfo == NULL) {
+        return -1;
+    }
+
+    /* Find least recently used unpinned frame */
+    int replaceIdx = scanMinUnpinned(poolInfo->recentHits + part->firstFrame,
+                                     poolInfo->fixCounts + part->firstFrame,
+                                     part->numFrames);
+
+    return replaceIdx == -1 ? -1 : part->firstFrame + replaceIdx;
+}
+
+/*
+ * CLOCK page replacement strategy
+ * Uses second-chance algorithm to select victim page in a partition; the
+ * hand tests and clears reference bits of 64 frames per bitmap word
+ * @param bm - Pointer to buffer pool
+ * @param part - Partition to select the victim from
+ * @return Index of the victim frame, or -1 if all frames are pinned
+ */
+static int CLOCK(BM_BufferPool *const bm, PoolPartition *part)
+{
+    BufferPoolInfo *poolInfo = getPoolInfo(bm);
+    if (poolInfo == NULL) {
+        return -1;
+    }
+
+    int end = part->firstFrame + part->numFrames;
+    int maxScan = part->numFrames * 2; /* Prevent infinite loop */
+
+    /* Sweep through frames looking for victim */
+    for (int scanned = 0; scanned < maxScan; ) {
+        int idx = part->firstFrame + part->clockPointer;
+        int base = idx & ~63;
+        int segEnd = wordSegmentEnd(idx, end);
+        uint64_t *refWord = &poolInfo->refBits[idx >> 6];
+        uint64_t unpinned = ~poolInfo->pinnedBits[idx >> 6] &
+                            rangeMask(idx - base, segEnd - base);
+        uint64_t candidates = unpinned & ~*refWord;
+
+        if (candidates != 0) {
+            /* Found victim; unpinned frames passed on the way lose their second chance */
+            int victim = base + lowestBit(candidates);
+            *refWord &= ~(unpinned & rangeMask(idx - base, victim - base));
+            part->clockPointer = (victim + 1 - part->firstFrame) % part->numFrames;
+            return victim;
+        }
+
+        /* Give second chance */
+        *refWord &= ~unpinned;
+        scanned += segEnd - idx;
+        part->clockPointer = (segEnd - part->firstFrame) % part->numFrames;
+    }
+
+    return -1;
+}
+
+/*
+ * GCLOCK page replacement strategy
+ * Like CLOCK, but every frame has a saturating usage count incremented by
+ * hits; the hand decrements the count of each unpinned frame it passes and
+ * evicts the first one found at zero
+ * @param bm - Pointer to buffer pool
+ * @param part - Partition to select the victim from
+ * @return Index of the victim frame, or -1 if all frames are pinned
+ */
+static int GCLOCK(BM_BufferPool *const bm, PoolPartition *part)
+{
+    BufferPoolInfo *poolInfo = getPoolInfo(bm);
+    if (poolInfo == NULL) {
+        return -1;
+    }
+
+    /* Every count reaches zero within maxUsageCount + 1 rotations */
+    int maxScan = part->numFrames * (poolInfo->maxUsageCount + 1);
+
+    for (int scanned = 0; scanned < maxScan; scanned++) {
+        int idx = part->firstFrame + part->clockPointer;
+        part->clockPointer = (part->clockPointer + 1) % part->numFrames;
+
+        if (testBit(poolInfo->pinnedBits, idx)) {
+            continue;
+        }
+        if (poolInfo->usageCounts[idx] == 0) {
+            return idx;
+        }
+        poolInfo->usageCounts[idx]--;
+    }
+
+    return -1;
+}
+
+/* Largest share of resident cold pages CLOCK-Pro adapts to */
+static inline int clockProMaxCold(BufferPoolInfo *poolInfo) {
+    return (poolInfo->bufferSize > 1) ? poolInfo->bufferSize - 1 : 1;
+}
+
+/* A cold page was re-accessed in its test period: favour cold pages */
+static inline void clockProGrowCold(BufferPoolInfo *poolInfo) {
+    if (poolInfo->clockPro->coldTarget < clockProMaxCold(poolInfo)) {
+        poolInfo->clockPro->coldTarget++;
+    }
+}
+
+/* A test period expired without a re-access: favour hot pages */
+static inline void clockProShrinkCold(ClockPro *cp) {
+    if (cp->coldTarget > 1) {
+        cp->coldTarget--;
+    }
+}
+
+/*
+ * Takes an entry out of the ring, moving hands that point at it forward
+ */
+static void clockProUnlink(ClockPro *cp, int e)
+{
+    int next = (cp->next[e] == e) ? -1 : cp->next[e];
+    if (cp->handHot == e) {
+        cp->handHot = next;
+    }
+    if (cp->handCold == e) {
+        cp->handCold = next;
+    }
+    if (cp->handTest == e) {
+        cp->handTest = next;
+    }
+    cp->next[cp->prev[e]] = cp->next[e];
+    cp->prev[cp->next[e]] = cp->prev[e];
+}
+
+/*
+ * Inserts an entry at the head of the ring, right behind the hot hand,
+ * so every hand reaches it last
+ */
+static void clockProLinkHead(ClockPro *cp, int e)
+{
+    if (cp->handHot == -1) {
+        cp->prev[e] = cp->next[e] = e;
+        cp->handHot = cp->handCold = cp->handTest = e;
+        return;
+    }
+    int head = cp->handHot;
+    cp->prev[e] = cp->prev[head];
+    cp->next[e] = head;
+    cp->next[cp->prev[head]] = e;
+    cp->prev[head] = e;
+}
+
+/*
+ * Removes an entry from the ring and returns it to the free list
+ */
+static void clockProRemove(ClockPro *cp, int e)
+{
+    clockProUnlink(cp, e);
+    if (cp->frames[e] == -1) {
+        pageIndexRemove(&cp->nonResident, e, cp->files[e], cp->pages[e]);
+    }
+    cp->pages[e] = NO_PAGE;
+    cp->next[e] = cp->freeList;
+    cp->freeList = e;
+}
+
+/*
+ * Runs the hot hand until it turns one hot page cold; test periods of the
+ * cold pages it passes end on the way
+ * @return 1 if a hot page was demoted, 0 if all hot pages are pinned
+ */
+static int clockProRunHot(BufferPoolInfo *poolInfo)
+{
+    ClockPro *cp = poolInfo->clockPro;
+    int maxScan = 2 * (cp->numHot + cp->numCold + cp->numNonResident);
+
+    for (int scanned = 0; scanned < maxScan && cp->handHot != -1; scanned++) {
+        int e = cp->handHot;
+        cp->handHot = cp->next[e];
+
+        if (cp->frames[e] == -1) {
+            clockProRemove(cp, e);
+            cp->numNonResident--;
+            clockProShrinkCold(cp);
+        } else if (cp->flags[e] & CP_HOT) {
+            int frame = cp->frames[e];
+            if (testBit(poolInfo->pinnedBits, frame)) {
+                continue;
+            }
+            if (testBit(poolInfo->refBits, frame)) {
+                clearBit(poolInfo->refBits, frame);
+                continue;
+            }
+            cp->flags[e] = 0;
+            cp->numHot--;
+            cp->numCold++;
+            return 1;
+        } else if (cp->flags[e] & CP_TEST) {
+            cp->flags[e] &= ~CP_TEST;
+            clockProShrinkCold(cp);
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Runs the test hand until at most one non-resident page per frame is
+ * remembered, ending the test periods it passes
+ */
+static void clockProRunTest(BufferPoolInfo *poolInfo)
+{
+    ClockPro *cp = poolInfo->clockPro;
+
+    while (cp->numNonResident > poolInfo->bufferSize && cp->handTest != -1) {
+        int e = cp->handTest;
+        cp->handTest = cp->next[e];
+
+        if (cp->frames[e] == -1) {
+            clockProRemove(cp, e);
+            cp->numNonResident--;
+            clockProShrinkCold(cp);
+        } else if (cp->flags[e] == CP_TEST) {
+            cp->flags[e] = 0;
+            clockProShrinkCold(cp);
+        }
+    }
+}
+
+/*
+ * CLOCK-Pro page replacement strategy
+ * Pages are hot or cold; only cold pages are evicted. The cold hand gives
+ * a referenced cold page a test period, or promotes it to hot if it was
+ * already in one; the hot hand demotes unreferenced hot pages, and the
+ * test hand bounds the number of remembered non-resident pages. Cold pages
+ * re-accessed in their test period grow the share of cold pages
+ * @param bm - Pointer to buffer pool
+ * @param part - Unused, the ring covers the whole pool
+ * @return Index of the victim frame, or -1 if all frames are pinned
+ */
+static int CLOCK_PRO(BM_BufferPool *const bm, PoolPartition *part)
+{
+    (void)part;
+
+    BufferPoolInfo *poolInfo = getPoolInfo(bm);
+    if (poolInfo == NULL) {
+        return -1;
+    }
+    ClockPro *cp = poolInfo->clockPro;
+
+    for (int attempt = 0; attempt <= poolInfo->bufferSize; attempt++) {
+        /* Two laps clear every reference bit on the way */
+        int maxScan = 2 * (cp->numHot + cp->numCold + cp->numNonResident);
+
+        for (int scanned = 0; scanned < maxScan && cp->handCold != -1; scanned++) {
+            int e = cp->handCold;
+            cp->handCold = cp->next[e];
+
+            int frame = cp->frames[e];
+            if (frame == -1 || (cp->flags[e] & CP_HOT) ||
+                testBit(poolInfo->pinnedBits, frame)) {
+                continue;
+            }
+            if (!testBit(poolInfo->refBits, frame)) {
+                return frame;
+            }
+
+            clearBit(poolInfo->refBits, frame);
+            clockProUnlink(cp, e);
+            if (cp->flags[e] & CP_TEST) {
+                /* Re-accessed in its test period: the page becomes hot */
+                cp->flags[e] = CP_HOT;
+                cp->numCold--;
+                cp->numHot++;
+                clockProGrowCold(poolInfo);
+                clockProLinkHead(cp, e);
+                while (cp->numHot > poolInfo->bufferSize - cp->coldTarget &&
+                       clockProRunHot(poolInfo)) {
+                }
+            } else {
+                cp->flags[e] = CP_TEST;
+                clockProLinkHead(cp, e);
+            }
+        }
+
+        /* No unpinned cold page left: demote a hot page and look again */
+        if (!clockProRunHot(poolInfo)) {
+            return -1;
+        }
+    }
+
+    return -1;
+}
+
+/*
+ * Records the eviction of a frame's page; a page in its test period stays
+ * in the ring as a non-resident page
+ */
+static void clockProEvict(BufferPoolInfo *poolInfo, int idx)
+{
+    ClockPro *cp = poolInfo->clockPro;
+    int e = cp->frameEntries[idx];
+    if (e == -1) {
+        return;
+    }
+    cp->frameEntries[idx] = -1;
+
+    if (cp->flags[e] & CP_HOT) {
+        cp->numHot--;
+    } else {
+        cp->numCold--;
+    }
+
+    if (cp->flags[e] == CP_TEST) {
+        cp->frames[e] = -1;
+        pageIndexAdd(&cp->nonResident, e, cp->files[e], cp->pages[e]);
+        cp->numNonResident++;
+        clockProRunTest(poolInfo);
+    } else {
+        clockProRemove(cp, e);
+    }
+}
+
+/*
+ * Adds the page just read into a frame to the ring. A page remembered as
+ * non-resident proved a short reuse distance and becomes hot, as do pages
+ * filling an empty pool until the hot share is reached; all others start
+ * cold in a test period
+ * @param filling - The page was read into a never used frame
+ */
+static void clockProInsert(BufferPoolInfo *poolInfo, int idx, bool filling)
+{
+    ClockPro *cp = poolInfo->clockPro;
+    PageNumber pageNum = poolInfo->pageNumbers[idx];
+    FileId fileId = poolInfo->fileIds[idx];
+
+    int ghost = pageIndexFind(&cp->nonResident, cp->pages, cp->files, fileId, pageNum);
+
+    bool hot = filling && cp->numHot < poolInfo->bufferSize - cp->coldTarget;
+    if (ghost != -1) {
+        clockProRemove(cp, ghost);
+        cp->numNonResident--;
+        clockProGrowCold(poolInfo);
+        hot = true;
+    }
+
+    int e = cp->freeList;
+    cp->freeList = cp->next[e];
+    cp->pages[e] = pageNum;
+    cp->files[e] = fileId;
+    cp->frames[e] = idx;
+    cp->flags[e] = hot ? CP_HOT : CP_TEST;
+    cp->frameEntries[idx] = e;
+    clockProLinkHead(cp, e);
+
+    if (hot) {
+        cp->numHot++;
+        while (cp->numHot > poolInfo->bufferSize - cp->coldTarget && clockProRunHot(poolInfo)) {
+        }
+    } else {
+        cp->numCold++;
+    }
+}
+
+/* Doubly linked lists of entries, threaded through index arrays */
+static void listUnlink(int *prev, int *next, int *head, int *tail, int e)
+{
+    if (prev[e] != -1) {
+        next[prev[e]] = next[e];
+    } else {
+        *head = next[e];
+    }
+    if (next[e] != -1) {
+        prev[next[e]] = prev[e];
+    } else {
+        *tail = prev[e];
+    }
+}
+
+static void listPushBack(int *prev, int *next, int *head, int *tail, int e)
+{
+    prev[e] = *tail;
+    next[e] = -1;
+    if (*tail != -1) {
+        next[*tail] = e;
+    } else {
+        *head = e;
+    }
+    *tail = e;
+}
+
+/* LIRS stack, queue and eviction order operations */
+static inline void lirsStackRemove(Lirs *lirs, int e) {
+    listUnlink(lirs->stackPrev, lirs->stackNext, &lirs->stackBottom, &lirs->stackTop, e);
+    lirs->flags[e] &= ~LIRS_STACKED;
+}
+
+static inline void lirsStackPush(Lirs *lirs, int e) {
+    listPushBack(lirs->stackPrev, lirs->stackNext, &lirs->stackBottom, &lirs->stackTop, e);
+    lirs->flags[e] |= LIRS_STACKED;
+}
+
+static inline void lirsQueueRemove(Lirs *lirs, int e) {
+    listUnlink(lirs->queuePrev, lirs->queueNext, &lirs->queueHead, &lirs->queueTail, e);
+}
+
+static inline void lirsQueuePush(Lirs *lirs, int e) {
+    listPushBack(lirs->queuePrev, lirs->queueNext, &lirs->queueHead, &lirs->queueTail, e);
+}
+
+static inline void lirsGhostPush(Lirs *lirs, int e) {
+    listPushBack(lirs->queuePrev, lirs->queueNext, &lirs->ghostHead, &lirs->ghostTail, e);
+    pageIndexAdd(&lirs->nonResident, e, lirs->files[e], lirs->pages[e]);
+    lirs->numNonResident++;
+}
+
+static inline void lirsGhostRemove(Lirs *lirs, int e) {
+    listUnlink(lirs->queuePrev, lirs->queueNext, &lirs->ghostHead, &lirs->ghostTail, e);
+    pageIndexRemove(&lirs->nonResident, e, lirs->files[e], lirs->pages[e]);
+    lirs->numNonResident--;
+}
+
+static inline void lirsFree(Lirs *lirs, int e) {
+    lirs->pages[e] = NO_PAGE;
+    lirs->flags[e] = 0;
+    lirs->stackNext[e] = lirs->freeList;
+    lirs->freeList = e;
+}
+
+/*
+ * Removes HIR pages from the bottom of the stack until a LIR page is at
+ * the bottom; non-resident pages removed this way are forgotten
+ */
+static void lirsPrune(Lirs *lirs)
+{
+    while (lirs->stackBottom != -1 && !(lirs->flags[lirs->stackBottom] & LIRS_LIR)) {
+        int e = lirs->stackBottom;
+        lirsStackRemove(lirs, e);
+        if (lirs->frames[e] == -1) {
+            lirsGhostRemove(lirs, e);
+            lirsFree(lirs, e);
+        }
+    }
+}
+
+/*
+ * Turns the least recent LIR page into a resident HIR page
+ */
+static void lirsDemoteBottom(Lirs *lirs)
+{
+    lirsPrune(lirs);
+    int e = lirs->stackBottom;
+    if (e == -1) {
+        return;
+    }
+
+    lirs->flags[e] &= ~LIRS_LIR;
+    lirs->numLir--;
+    lirsStackRemove(lirs, e);
+    lirsQueuePush(lirs, e);
+    lirsPrune(lirs);
+}
+
+/*
+ * Records a hit on a frame: the page moves to the top of the stack, and
+ * a HIR page still in the stack has a smaller inter-reference recency
+ * than the least recent LIR page, so the two swap status
+ */
+static void lirsHit(BufferPoolInfo *poolInfo, int idx)
+{
+    Lirs *lirs = poolInfo->lirs;
+    int e = lirs->frameEntries[idx];
+    if (e == -1) {
+        return;
+    }
+
+    bool stacked = (lirs->flags[e] & LIRS_STACKED) != 0;
+    if (stacked) {
+        lirsStackRemove(lirs, e);
+    }
+    lirsStackPush(lirs, e);
+
+    if (!(lirs->flags[e] & LIRS_LIR)) {
+        lirsQueueRemove(lirs, e);
+        if (stacked && lirs->lirTarget > 0) {
+            lirs->flags[e] |= LIRS_LIR;
+            lirs->numLir++;
+            if (lirs->numLir > lirs->lirTarget) {
+                lirsDemoteBottom(lirs);
+            }
+        } else {
+            lirsQueuePush(lirs, e);
+        }
+    }
+
+    lirsPrune(lirs);
+}
+
+/*
+ * LIRS page replacement strategy
+ * Evicts the oldest resident HIR page of the queue; pages keep LIR status
+ * while their inter-reference recency is among the smallest, so loops
+ * slightly larger than the pool still hit on the LIR pages
+ * @param bm - Pointer to buffer pool
+ * @param part - Unused, the stack covers the whole pool
+ * @return Index of the victim frame, or -1 if all frames are pinned
+ */
+static int LIRS(BM_BufferPool *const bm, PoolPartition *part)
+{
+    (void)part;
+
+    BufferPoolInfo *poolInfo = getPoolInfo(bm);
+    if (poolInfo == NULL) {
+        return -1;
+    }
+    Lirs *lirs = poolInfo->lirs;
+
+    for (int e = lirs->queueHead; e != -1; e = lirs->queueNext[e]) {
+        if (!testBit(poolInfo->pinnedBits, lirs->frames[e])) {
+            return lirs->frames[e];
+        }
+    }
+
+    /* Every HIR page is pinned: fall back to the least recent LIR page */
+    for (int e = lirs->stackBottom; e != -1; e = lirs->stackNext[e]) {
+        if ((lirs->flags[e] & LIRS_LIR) && !testBit(poolInfo->pinnedBits, lirs->frames[e])) {
+            return lirs->frames[e];
+        }
+    }
+
+    return -1;
+}
+
+/*
+ * Records the eviction of a frame's page; a HIR page still in the stack
+ * stays there as a non-resident page, at most one per frame
+ */
+static void lirsEvict(BufferPoolInfo *poolInfo, int idx)
+{
+    Lirs *lirs = poolInfo->lirs;
+    int e = lirs->frameEntries[idx];
+    if (e == -1) {
+        return;
+    }
+    lirs->frameEntries[idx] = -1;
+
+    if (lirs->flags[e] & LIRS_LIR) {
+        lirs->numLir--;
+        lirsStackRemove(lirs, e);
+        lirsFree(lirs, e);
+        lirsPrune(lirs);
+        return;
+    }
+
+    lirsQueueRemove(lirs, e);
+    if (!(lirs->flags[e] & LIRS_STACKED)) {
+        lirsFree(lirs, e);
+        return;
+    }
+
+    lirs->frames[e] = -1;
+    lirsGhostPush(lirs, e);
+
+    /* Bound the stack by forgetting the oldest non-resident pages */
+    while (lirs->numNonResident > poolInfo->bufferSize) {
+        int ghost = lirs->ghostHead;
+        lirsGhostRemove(lirs, ghost);
+        lirsStackRemove(lirs, ghost);
+        lirsFree(lirs, ghost);
+    }
+}
+
+/*
+ * Adds the page just read into a frame. A non-resident page still in the
+ * stack becomes LIR; other pages are LIR while LIR frames are free and
+ * resident HIR pages otherwise
+ * @param mayBeLir - False for preloaded pages, which always start as HIR
+ */
+static void lirsInsert(BufferPoolInfo *poolInfo, int idx, bool mayBeLir)
+{
+    Lirs *lirs = poolInfo->lirs;
+    PageNumber pageNum = poolInfo->pageNumbers[idx];
+    FileId fileId = poolInfo->fileIds[idx];
+
+    int e = pageIndexFind(&lirs->nonResident, lirs->pages, lirs->files, fileId, pageNum);
+
+    if (e != -1) {
+        lirsGhostRemove(lirs, e);
+        lirsStackRemove(lirs, e);
+        if (!mayBeLir || lirs->lirTarget == 0) {
+            lirsFree(lirs, e);
+            e = -1;
+        }
+    }
+
+    bool lir = mayBeLir && lirs->lirTarget > 0 && (e != -1 || lirs->numLir < lirs->lirTarget);
+    if (e == -1) {
+        e = lirs->freeList;
+        lirs->freeList = lirs->stackNext[e];
+        lirs->pages[e] = pageNum;
+        lirs->files[e] = fileId;
+        lirs->flags[e] = 0;
+    }
+    lirs->frames[e] = idx;
+    lirs->frameEntries[idx] = e;
+    lirsStackPush(lirs, e);
+
+    if (lir) {
+        lirs->flags[e] |= LIRS_LIR;
+        lirs->numLir++;
+        if (lirs->numLir > lirs->lirTarget) {
+            lirsDemoteBottom(lirs);
+        }
+    } else {
+        lirsQueuePush(lirs, e);
+    }
+
+    lirsPrune(lirs);
+}
+
+/*
+ * Adds a frame as the newest of its partition's SIEVE queue
+ */
+static void sieveInsert(BufferPoolInfo *poolInfo, int idx)
+{
+    PoolPartition *part = partitionOfFrame(poolInfo, idx);
+    listPushBack(poolInfo->olderFrames, poolInfo->newerFrames,
+                 &part->sieveOldest, &part->sieveNewest, idx);
+}
+
+/*
+ * Removes an evicted frame from its partition's SIEVE queue
+ */
+static void sieveEvict(BufferPoolInfo *poolInfo, int idx)
+{
+    PoolPartition *part = partitionOfFrame(poolInfo, idx);
+    if (part->sieveHand == idx) {
+        part->sieveHand = poolInfo->newerFrames[idx];
+    }
+    listUnlink(poolInfo->olderFrames, poolInfo->newerFrames,
+               &part->sieveOldest, &part->sieveNewest, idx);
+}
+
+/*
+ * SIEVE page replacement strategy
+ * Pages stay in insertion order; hits only set the visited bit. The hand
+ * moves from the oldest page towards the newest, clearing visited bits,
+ * and evicts the first unvisited page, leaving survivors in place
+ * @param bm - Pointer to buffer pool
+ * @param part - Partition to select the victim from
+ * @return Index of the victim frame, or -1 if all frames are pinned
+ */
+static int SIEVE(BM_BufferPool *const bm, PoolPartition *part)
+{
+    BufferPoolInfo *poolInfo = getPoolInfo(bm);
+    if (poolInfo == NULL) {
+        return -1;
+    }
+
+    int maxScan = part->numFrames * 2; /* Prevent infinite loop */
+
+    for (int scanned = 0; scanned < maxScan; scanned++) {
+        int idx = (part->sieveHand != -1) ? part->sieveHand : part->sieveOldest;
+        if (idx == -1) {
+            return -1;
+        }
+        part->sieveHand = poolInfo->newerFrames[idx];
+
+        if (testBit(poolInfo->pinnedBits, idx)) {
+            continue;
+        }
+        if (!testBit(poolInfo->refBits, idx)) {
+            return idx;
+        }
+        clearBit(poolInfo->refBits, idx);
+    }
+
+    return -1;
+}
+
+/*
+ * Returns array of page numbers currently in buffer pool
+ * @param bm - Pointer to buffer pool
+ * @return Array of page numbers (NO_PAGE for empty frames)
+ */
+extern PageNumber *getFrameContents(BM_BufferPool *const bm)
+{
+    if (bm == NULL) {
+        return NULL;
+    }
+
+    BufferPoolInfo *poolInfo = getPoolInfo(bm);
+    if (poolInfo == NULL) {
+        return NULL;
+    }
+
+    PageNumber *contents = (PageNumber*)malloc(sizeof(PageNumber) * poolInfo->bufferSize);
+    if (contents == NULL) {
+        return NULL;
+    }
+
+    memcpy(contents, poolInfo->pageNumbers, sizeof(PageNumber) * poolInfo->bufferSize);
+
+    return contents;
+}
+
+/*
+ * Returns array of dirty flags for all frames
+ * @param bm - Pointer to buffer pool
+ * @return Array of boolean dirty flags
+ */
+extern bool *getDirtyFlags(BM_BufferPool *const bm)
+{
+    if (bm == NULL) {
+        return NULL;
+    }
+
+    BufferPoolInfo *poolInfo = getPoolInfo(bm);
+    if (poolInfo == NULL) {
+        return NULL;
+    }
+
+    bool *dirtyFlags = (bool*)malloc(sizeof(bool) * poolInfo->bufferSize);
+    if (dirtyFlags == NULL) {
+        return NULL;
+    }
+
+    for (int i = 0; i < poolInfo->bufferSize; i++) {
+        dirtyFlags[i] = testBit(poolInfo->dirtyBits, i);
+    }
+
+    return dirtyFlags;
+}
+
+/*
+ * Returns array of fix counts (pin counts) for all frames
+ * @param bm - Pointer to buffer pool
+ * @return Array of fix counts
+ */
+extern int *getFixCounts(BM_BufferPool *const bm)
+{
+    if (bm == NULL) {
+        return NULL;
+    }
+
+    BufferPoolInfo *poolInfo = getPoolInfo(bm);
+    if (poolInfo == NULL) {
+        return NULL;
+    }
+
+    int *fixCounts = (int*)malloc(sizeof(int) * poolInfo->bufferSize);
+    if (fixCounts == NULL) {
+        return NULL;
+    }
+
+    memcpy(fixCounts, poolInfo->fixCounts, sizeof(int) * poolInfo->bufferSize);
+
+    return fixCounts;
+}
+
+/*
+ * Returns array of page file ids for all frames
+ * @param bm - Pointer to buffer pool
+ * @return Array of file ids (meaningless for empty frames)
+ */
+extern FileId *getFrameFileIds(BM_BufferPool *const bm)
+{
+    if (bm == NULL) {
+        return NULL;
+    }
+
+    BufferPoolInfo *poolInfo = getPoolInfo(bm);
+    if (poolInfo == NULL) {
+        return NULL;
+    }
+
+    FileId *fileIds = (FileId*)malloc(sizeof(FileId) * poolInfo->bufferSize);
+    if (fileIds == NULL) {
+        return NULL;
+    }
+
+    memcpy(fileIds, poolInfo->fileIds, sizeof(FileId) * poolInfo->bufferSize);
+
+    return fileIds;
+}
+
+/*
+ * Returns the number of pages read from disk since initialization
+ * @param bm - Pointer to buffer pool
+ * @return Number of read I/O operations
+ */
+extern int getNumReadIO(BM_BufferPool *const bm)
+{
+    if (bm == NULL) {
+        return 0;
+    }
+
+    BufferPoolInfo *poolInfo = getPoolInfo(bm);
+    if (poolInfo == NULL) {
+        return 0;
+    }
+
+    return poolInfo->readCount;
+}
+
+/*
+ * Returns the kind of memory backing the pool's frames
+ * @param bm - Pointer to buffer pool
+ * @return Memory mode obtained at initialization
+ */
+extern FrameMemoryMode getFrameMemoryMode(BM_BufferPool *const bm)
+{
+    if (bm == NULL) {
+        return FM_HEAP;
+    }
+
+    BufferPoolInfo *poolInfo = getPoolInfo(bm);
+    if (poolInfo == NULL) {
+        return FM_HEAP;
     }
 
-    return RC_ERROR;
+    return poolInfo->frameMemory;
 }
 
 /*
- * Unpins a page, decrementing its pin count
+ * Returns the number of NUMA partitions of the pool
  * @param bm - Pointer to buffer pool
- * @param page - Page handle to unpin
- * @return RC_OK on success
+ * @return Number of partitions (1 without NUMA placement)
  */
-extern RC unpinPage(BM_BufferPool *const bm, BM_PageHandle *const page)
+extern int getNumPartitions(BM_BufferPool *const bm)
 {
     if (bm == NULL) {
-        return RC_BUFF_POOL_NOT_FOUND;
-    }
-
-    if (page == NULL) {
-        return RC_ERROR;
+        return 0;
     }
 
     BufferPoolInfo *poolInfo = getPoolInfo(bm);
     if (poolInfo == NULL) {
-        return RC_ERROR;
-    }
-
-    /* Find and unpin the page */
-    for (int i = 0; i < poolInfo->bufferSize; i++) {
-        if (poolInfo->frames[i].pageNumber == page->pageNum) {
-            if (poolInfo->frames[i].accessCount > 0) {
-                poolInfo->frames[i].accessCount--;
-            }
-            break;
-        }
+        return 0;
     }
 
-    return RC_OK;
+    return poolInfo->numPartitions;
 }
 
 /*
- * Forces a specific page to be written to disk
+ * Returns the number of hits on frames of the caller's NUMA node
  * @param bm - Pointer to buffer pool
- * @param page - Page handle to write
- * @return RC_OK on success, error code otherwise
+ * @return Number of local hits
  */
-extern RC forcePage(BM_BufferPool *const bm, BM_PageHandle *const page)
+extern int getNumLocalHits(BM_BufferPool *const bm)
 {
     if (bm == NULL) {
-        return RC_BUFF_POOL_NOT_FOUND;
-    }
-
-    if (page == NULL) {
-        return RC_ERROR;
+        return 0;
     }
 
     BufferPoolInfo *poolInfo = getPoolInfo(bm);
     if (poolInfo == NULL) {
-        return RC_ERROR;
-    }
-
-    SM_FileHandle fh;
-    if (openPageFile(bm->pageFile, &fh) != RC_OK) {
-        return RC_FILE_NOT_FOUND;
-    }
-
-    /* Find and write the page */
-    for (int i = 0; i < poolInfo->bufferSize; i++) {
-        if (poolInfo->frames[i].pageNumber == page->pageNum) {
-            if (writeBlock(poolInfo->frames[i].pageNumber, &fh,
-                          poolInfo->frames[i].data) != RC_OK) {
-                closePageFile(&fh);
-                return RC_WRITE_FAILED;
-            }
-            poolInfo->frames[i].dirtybit = 0;
-            poolInfo->writeCount++;
-            break;
-        }
+        return 0;
     }
 
-    closePageFile(&fh);
-    return RC_OK;
+    return poolInfo->localHits;
 }
 
 /*
- * Pins a page in the buffer pool
- * Loads the page from disk if not already in buffer
+ * Returns the number of hits on frames of another NUMA node
  * @param bm - Pointer to buffer pool
- * @param page - Page handle to populate
- * @param pageNum - Page number to pin
- * @return RC_OK on success, error code otherwise
+ * @return Number of remote hits
  */
-extern RC pinPage(BM_BufferPool *const bm, BM_PageHandle *const page, const PageNumber pageNum)
+extern int getNumRemoteHits(BM_BufferPool *const bm)
 {
     if (bm == NULL) {
-        return RC_BUFF_POOL_NOT_FOUND;
-    }
-
-    if (page == NULL) {
-        return RC_ERROR;
+        return 0;
     }
 
     BufferPoolInfo *poolInfo = getPoolInfo(bm);
     if (poolInfo == NULL) {
-        return RC_ERROR;
-    }
-
-    SM_FileHandle fh;
-    if (openPageFile(bm->pageFile, &fh) != RC_OK) {
-        return RC_FILE_NOT_FOUND;
+        return 0;
     }
 
-    /* Check if page is already in buffer */
-    for (int i = 0; i < poolInfo->bufferSize; i++) {
-        if (poolInfo->frames[i].pageNumber == pageNum) {
-            poolInfo->frames[i].accessCount++;
-            poolInfo->recentHitCount++;
-
-            if (bm->strategy == RS_CLOCK) {
-                poolInfo->frames[i].secondChance = 1;
-            } else if (bm->strategy == RS_LRU) {
-                poolInfo->frames[i].recentHit = poolInfo->recentHitCount;
-            }
+    return poolInfo->remoteHits;
+}
 
-            page->pageNum = pageNum;
-            page->data = poolInfo->frames[i].data;
-            closePageFile(&fh);
-            return RC_OK;
-        }
+/*
+ * Returns the number of missed pages the admission filter served from a
+ * bypass frame instead of caching them
+ * @param bm - Pointer to buffer pool
+ * @return Number of rejected pages, 0 without an admission filter
+ */
+extern int getNumRejectedPages(BM_BufferPool *const bm)
+{
+    if (bm == NULL) {
+        return 0;
     }
 
-    /* Page not in buffer - find empty frame or use replacement strategy */
-    for (int i = 0; i < poolInfo->bufferSize; i++) {
-        if (poolInfo->frames[i].pageNumber == NO_PAGE) {
-            /* Found empty frame */
-            poolInfo->frames[i].data = (char*)malloc(PAGE_SIZE);
-            if (poolInfo->frames[i].data == NULL) {
-                closePageFile(&fh);
-                return RC_ERROR;
-            }
-
-            ensureCapacity(pageNum + 1, &fh);
-            if (readBlock(pageNum, &fh, poolInfo->frames[i].data) != RC_OK) {
-                free(poolInfo->frames[i].data);
-                poolInfo->frames[i].data = NULL;
-                closePageFile(&fh);
-                return RC_READ_NON_EXISTING_PAGE;
-            }
-
-            poolInfo->frames[i].pageNumber = pageNum;
-            poolInfo->frames[i].accessCount = 1;
-            poolInfo->frames[i].dirtybit = 0;
-            poolInfo->frames[i].index = 0;
-            poolInfo->readCount++;
-            poolInfo->recentHitCount++;
-
-            if (bm->strategy == RS_CLOCK) {
-                poolInfo->frames[i].secondChance = 0;
-            } else if (bm->strategy == RS_LRU) {
-                poolInfo->frames[i].recentHit = poolInfo->recentHitCount;
-            }
-
-            page->pageNum = pageNum;
-            page->data = poolInfo->frames[i].data;
-            closePageFile(&fh);
-            return RC_OK;
-        }
+    BufferPoolInfo *poolInfo = getPoolInfo(bm);
+    if (poolInfo == NULL || poolInfo->admission == NULL) {
+        return 0;
     }
 
-    /* No empty frame - use replacement strategy */
-    FrameInfo *newFrame = (FrameInfo*)malloc(sizeof(FrameInfo));
-    if (newFrame == NULL) {
-        closePageFile(&fh);
-        return RC_ERROR;
-    }
+    return poolInfo->admission->numRejected;
+}
 
-    newFrame->data = (char*)malloc(PAGE_SIZE);
-    if (newFrame->data == NULL) {
-        free(newFrame);
-        closePageFile(&fh);
-        return RC_ERROR;
+/*
+ * Returns the number of times an adaptive pool switched its replacement
+ * strategy; the active one is bm->strategy
+ * @param bm - Pointer to buffer pool
+ * @return Number of strategy switches, 0 for pools that are not adaptive
+ */
+extern int getNumStrategySwitches(BM_BufferPool *const bm)
+{
+    if (bm == NULL) {
+        return 0;
     }
 
-    ensureCapacity(pageNum + 1, &fh);
-    if (readBlock(pageNum, &fh, newFrame->data) != RC_OK) {
-        free(newFrame->data);
-        free(newFrame);
-        closePageFile(&fh);
-        return RC_READ_NON_EXISTING_PAGE;
+    BufferPoolInfo *poolInfo = getPoolInfo(bm);
+    if (poolInfo == NULL || poolInfo->adaptive == NULL) {
+        return 0;
     }
 
-    newFrame->pageNumber = pageNum;
-    newFrame->accessCount = 1;
-    newFrame->dirtybit = 0;
-    newFrame->index = 0;
-    poolInfo->readCount++;
-    poolInfo->recentHitCount++;
+    return poolInfo->adaptive->numSwitches;
+}
 
-    if (bm->strategy == RS_CLOCK) {
-        newFrame->secondChance = 0;
-    } else if (bm->strategy == RS_LRU) {
-        newFrame->recentHit = poolInfo->recentHitCount;
+/*
+ * Returns the number of pins that found every frame pinned
+ * Each is counted once, whether it then waited or failed
+ * @param bm - Pointer to buffer pool
+ * @return Number of stalled pins
+ */
+extern int getNumPinStalls(BM_BufferPool *const bm)
+{
+    if (bm == NULL) {
+        return 0;
     }
 
-    page->pageNum = pageNum;
-    page->data = newFrame->data;
-
-    /* Apply replacement strategy */
-    switch (bm->strategy) {
-        case RS_FIFO:
-            FIFO(bm, newFrame);
-            break;
-        case RS_LRU:
-            LRU(bm, newFrame);
-            break;
-        case RS_CLOCK:
-            CLOCK(bm, newFrame);
-            break;
-        default:
-            free(newFrame->data);
-            free(newFrame);
-            closePageFile(&fh);
-            return RC_ERROR;
+    BufferPoolInfo *poolInfo = getPoolInfo(bm);
+    if (poolInfo == NULL) {
+        return 0;
     }
 
-    free(newFrame);
-    closePageFile(&fh);
-    return RC_OK;
+    return poolInfo->pinStalls;
 }
 
 /*
- * FIFO page replacement strategy
- * Replaces the oldest page in the buffer
+ * Returns the number of stalled pins that failed with RC_ALL_FRAMES_PINNED
+ * Without pin waits every stall fails
  * @param bm - Pointer to buffer pool
- * @param page - New page to insert
+ * @return Number of failed stalled pins
  */
-static void FIFO(BM_BufferPool *const bm, FrameInfo *page)
+extern int getNumPinTimeouts(BM_BufferPool *const bm)
 {
+    if (bm == NULL) {
+        return 0;
+    }
+
     BufferPoolInfo *poolInfo = getPoolInfo(bm);
     if (poolInfo == NULL) {
-        return;
+        return 0;
     }
 
-    /* Find next frame to replace */
-    for (int attempts = 0; attempts < poolInfo->bufferSize; attempts++) {
-        int idx = poolInfo->frameIndex;
-
-        if (poolInfo->frames[idx].accessCount == 0) {
-            /* Frame can be replaced */
-            if (poolInfo->frames[idx].dirtybit) {
-                SM_FileHandle fh;
-                if (openPageFile(bm->pageFile, &fh) == RC_OK) {
-                    writeBlock(poolInfo->frames[idx].pageNumber, &fh,
-                              poolInfo->frames[idx].data);
-                    closePageFile(&fh);
-                    poolInfo->writeCount++;
-                }
-            }
-
-            /* Replace frame */
-            free(poolInfo->frames[idx].data);
-            poolInfo->frames[idx].data = page->data;
-            poolInfo->frames[idx].pageNumber = page->pageNumber;
-            poolInfo->frames[idx].dirtybit = page->dirtybit;
-            poolInfo->frames[idx].accessCount = page->accessCount;
-
-            poolInfo->frameIndex = (poolInfo->frameIndex + 1) % poolInfo->bufferSize;
-            return;
-        }
-
-        poolInfo->frameIndex = (poolInfo->frameIndex + 1) % poolInfo->bufferSize;
-    }
+    return poolInfo->pinTimeouts;
 }
 
 /*
- * LRU page replacement strategy
- * Replaces the least recently used unpinned page
+ * Returns the number of page bytes written back
  * @param bm - Pointer to buffer pool
- * @param page - New page to insert
+ * @return Bytes written by write-backs, whole pages and dirty sectors
  */
-static void LRU(BM_BufferPool *const bm, FrameInfo *page)
+extern long getNumBytesWritten(BM_BufferPool *const bm)
 {
+    if (bm == NULL) {
+        return 0;
+    }
+
     BufferPoolInfo *poolInfo = getPoolInfo(bm);
     if (poolInfo == NULL) {
-        return;
+        return 0;
     }
 
-    int replaceIdx = -1;
-    int leastRecentHit = poolInfo->recentHitCount + 1;
-
-    /* Find least recently used unpinned frame */
-    for (int i = 0; i < poolInfo->bufferSize; i++) {
-        if (poolInfo->frames[i].accessCount == 0) {
-            if (poolInfo->frames[i].recentHit < leastRecentHit) {
-                leastRecentHit = poolInfo->frames[i].recentHit;
-                replaceIdx = i;
-            }
-        }
-    }
+    return poolInfo->bytesWritten;
+}
 
-    if (replaceIdx == -1) {
-        return; /* All frames are pinned */
+/*
+ * Returns the number of bytes partial write-backs saved
+ * @param bm - Pointer to buffer pool
+ * @return Bytes of clean sectors not written with their page
+ */
+extern long getNumBytesSaved(BM_BufferPool *const bm)
+{
+    if (bm == NULL) {
+        return 0;
     }
 
-    /* Write dirty page if needed */
-    if (poolInfo->frames[replaceIdx].dirtybit) {
-        SM_FileHandle fh;
-        if (openPageFile(bm->pageFile, &fh) == RC_OK) {
-            writeBlock(poolInfo->frames[replaceIdx].pageNumber, &fh,
-                      poolInfo->frames[replaceIdx].data);
-            closePageFile(&fh);
-            poolInfo->writeCount++;
-        }
+    BufferPoolInfo *poolInfo = getPoolInfo(bm);
+    if (poolInfo == NULL) {
+        return 0;
     }
 
-    /* Replace frame */
-    free(poolInfo->frames[replaceIdx].data);
-    poolInfo->frames[replaceIdx].data = page->data;
-    poolInfo->frames[replaceIdx].pageNumber = page->pageNumber;
-    poolInfo->frames[replaceIdx].dirtybit = page->dirtybit;
-    poolInfo->frames[replaceIdx].accessCount = page->accessCount;
-    poolInfo->frames[replaceIdx].recentHit = page->recentHit;
+    return poolInfo->bytesSaved;
 }
 
 /*
- * CLOCK page replacement strategy
- * Uses second-chance algorithm to select victim page
+ * Returns the number of misses served by the compressed tier
  * @param bm - Pointer to buffer pool
- * @param page - New page to insert
+ * @return Number of tier hits, 0 without a compressed tier
  */
-static void CLOCK(BM_BufferPool *const bm, FrameInfo *page)
+extern int getNumTierHits(BM_BufferPool *const bm)
 {
-    BufferPoolInfo *poolInfo = getPoolInfo(bm);
-    if (poolInfo == NULL) {
-        return;
+    if (bm == NULL) {
+        return 0;
     }
 
-    /* Sweep through frames looking for victim */
-    int attempts = 0;
-    int maxAttempts = poolInfo->bufferSize * 2; /* Prevent infinite loop */
-
-    while (attempts < maxAttempts) {
-        int idx = poolInfo->clockPointer;
-
-        if (poolInfo->frames[idx].accessCount == 0) {
-            if (poolInfo->frames[idx].secondChance == 0) {
-                /* Found victim */
-                if (poolInfo->frames[idx].dirtybit) {
-                    SM_FileHandle fh;
-                    if (openPageFile(bm->pageFile, &fh) == RC_OK) {
-                        writeBlock(poolInfo->frames[idx].pageNumber, &fh,
-                                  poolInfo->frames[idx].data);
-                        closePageFile(&fh);
-                        poolInfo->writeCount++;
-                    }
-                }
+    BufferPoolInfo *poolInfo = getPoolInfo(bm);
+    if (poolInfo == NULL || poolInfo->tier == NULL) {
+        return 0;
+    }
 
-                /* Replace frame */
-                free(poolInfo->frames[idx].data);
-                poolInfo->frames[idx].data = page->data;
-                poolInfo->frames[idx].pageNumber = page->pageNumber;
-                poolInfo->frames[idx].dirtybit = page->dirtybit;
-                poolInfo->frames[idx].accessCount = page->accessCount;
-                poolInfo->frames[idx].secondChance = 0;
+    return poolInfo->tier->hits;
+}
 
-                poolInfo->clockPointer = (poolInfo->clockPointer + 1) % poolInfo->bufferSize;
-                return;
-            } else {
-                /* Give second chance */
-                poolInfo->frames[idx].secondChance = 0;
-            }
-        }
+/*
+ * Returns the number of misses the compressed tier sent to disk
+ * @param bm - Pointer to buffer pool
+ * @return Number of tier misses, 0 without a compressed tier
+ */
+extern int getNumTierMisses(BM_BufferPool *const bm)
+{
+    if (bm == NULL) {
+        return 0;
+    }
 
-        poolInfo->clockPointer = (poolInfo->clockPointer + 1) % poolInfo->bufferSize;
-        attempts++;
+    BufferPoolInfo *poolInfo = getPoolInfo(bm);
+    if (poolInfo == NULL || poolInfo->tier == NULL) {
+        return 0;
     }
+
+    return poolInfo->tier->misses;
 }
 
 /*
- * Returns array of page numbers currently in buffer pool
+ * Returns the number of bytes of compressed pages in the tier
  * @param bm - Pointer to buffer pool
- * @return Array of page numbers (NO_PAGE for empty frames)
+ * @return Bytes held, at most compressedTierBytes, 0 without a compressed tier
  */
-extern PageNumber *getFrameContents(BM_BufferPool *const bm)
+extern long getTierBytesUsed(BM_BufferPool *const bm)
 {
     if (bm == NULL) {
-        return NULL;
+        return 0;
     }
 
     BufferPoolInfo *poolInfo = getPoolInfo(bm);
-    if (poolInfo == NULL) {
-        return NULL;
+    if (poolInfo == NULL || poolInfo->tier == NULL) {
+        return 0;
     }
 
-    PageNumber *contents = (PageNumber*)malloc(sizeof(PageNumber) * poolInfo->bufferSize);
-    if (contents == NULL) {
-        return NULL;
+    return poolInfo->tier->bytesUsed;
+}
+
+/*
+ * Returns the number of misses served by the victim cache file
+ * @param bm - Pointer to buffer pool
+ * @return Number of victim cache hits, 0 without a victim cache
+ */
+extern int getNumVictimHits(BM_BufferPool *const bm)
+{
+    if (bm == NULL) {
+        return 0;
     }
 
-    for (int i = 0; i < poolInfo->bufferSize; i++) {
-        contents[i] = (poolInfo->frames[i].pageNumber == NO_PAGE) ?
-                      NO_PAGE : poolInfo->frames[i].pageNumber;
+    BufferPoolInfo *poolInfo = getPoolInfo(bm);
+    if (poolInfo == NULL || poolInfo->victim == NULL) {
+        return 0;
     }
 
-    return contents;
+    return poolInfo->victim->hits;
 }
 
 /*
- * Returns array of dirty flags for all frames
+ * Returns the number of evicted pages copied to the victim cache file
  * @param bm - Pointer to buffer pool
- * @return Array of boolean dirty flags
+ * @return Number of victim cache writes, 0 without a victim cache
  */
-extern bool *getDirtyFlags(BM_BufferPool *const bm)
+extern int getNumVictimWrites(BM_BufferPool *const bm)
 {
     if (bm == NULL) {
-        return NULL;
+        return 0;
     }
 
     BufferPoolInfo *poolInfo = getPoolInfo(bm);
-    if (poolInfo == NULL) {
-        return NULL;
+    if (poolInfo == NULL || poolInfo->victim == NULL) {
+        return 0;
     }
 
-    bool *dirtyFlags = (bool*)malloc(sizeof(bool) * poolInfo->bufferSize);
-    if (dirtyFlags == NULL) {
-        return NULL;
+    return poolInfo->victim->writes;
+}
+
+/*
+ * Returns the number of victim cache entries restored from the previous run
+ * @param bm - Pointer to buffer pool
+ * @return Number of restored entries, 0 without a victim cache
+ */
+extern int getNumVictimRestored(BM_BufferPool *const bm)
+{
+    if (bm == NULL) {
+        return 0;
     }
 
-    for (int i = 0; i < poolInfo->bufferSize; i++) {
-        dirtyFlags[i] = (poolInfo->frames[i].dirtybit == 1);
+    BufferPoolInfo *poolInfo = getPoolInfo(bm);
+    if (poolInfo == NULL || poolInfo->victim == NULL) {
+        return 0;
     }
 
-    return dirtyFlags;
+    return poolInfo->victim->restored;
 }
 
 /*
- * Returns array of fix counts (pin counts) for all frames
+ * Returns the number of processes attached to a shared pool
  * @param bm - Pointer to buffer pool
- * @return Array of fix counts
+ * @return Attached processes, 0 for a private pool
  */
-extern int *getFixCounts(BM_BufferPool *const bm)
+extern int getNumSharedProcesses(BM_BufferPool *const bm)
 {
     if (bm == NULL) {
-        return NULL;
+        return 0;
     }
 
     BufferPoolInfo *poolInfo = getPoolInfo(bm);
-    if (poolInfo == NULL) {
-        return NULL;
+    if (poolInfo == NULL || poolInfo->shared == NULL) {
+        return 0;
     }
 
-    int *fixCounts = (int*)malloc(sizeof(int) * poolInfo->bufferSize);
-    if (fixCounts == NULL) {
-        return NULL;
+    return poolInfo->shared->header->numAttached;
+}
+
+/*
+ * Returns the number of processes that died attached to a shared pool and
+ * had their pins given back
+ * @param bm - Pointer to buffer pool
+ * @return Reclaimed processes over the segment's lifetime, 0 for a private pool
+ */
+extern int getNumReclaimedProcesses(BM_BufferPool *const bm)
+{
+    if (bm == NULL) {
+        return 0;
     }
 
-    for (int i = 0; i < poolInfo->bufferSize; i++) {
-        fixCounts[i] = (poolInfo->frames[i].accessCount > 0) ?
-                       poolInfo->frames[i].accessCount : 0;
+    BufferPoolInfo *poolInfo = getPoolInfo(bm);
+    if (poolInfo == NULL || poolInfo->shared == NULL) {
+        return 0;
     }
 
-    return fixCounts;
+    return poolInfo->shared->header->reclaimed;
 }
 
 /*
- * Returns the number of pages read from disk since initialization
+ * Returns the number of pages installed from the warm file
  * @param bm - Pointer to buffer pool
- * @return Number of read I/O operations
+ * @return Number of preloaded pages
  */
-extern int getNumReadIO(BM_BufferPool *const bm)
+extern int getNumPreloadedPages(BM_BufferPool *const bm)
 {
     if (bm == NULL) {
         return 0;
@@ -678,7 +4873,7 @@ extern int getNumReadIO(BM_BufferPool *const bm)
         return 0;
     }
 
-    return poolInfo->readCount;
+    return poolInfo->preloadCount;
 }
 
 /*
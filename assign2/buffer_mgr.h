@@ -7,39 +7,130 @@
 // Include bool DT
 #include "dt.h"
 
+// Include SM_FileHandle for the page file registry
+#include "storage_mgr.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
 // Replacement Strategies
 typedef enum ReplacementStrategy {
 	RS_FIFO = 0,
 	RS_LRU = 1,
 	RS_CLOCK = 2,
 	RS_LFU = 3,
-	RS_LRU_K = 4
+	RS_LRU_K = 4,
+	RS_GCLOCK = 5,       // stratData: optional int *, maximum usage count
+	RS_CLOCK_PRO = 6,
+	RS_LIRS = 7,
+	RS_SIEVE = 8,
+	RS_CUSTOM = 9        // stratData: const BM_ReplacementPolicy *, see replacement_policy.h
 } ReplacementStrategy;
 
+// Usage count limits of RS_GCLOCK
+#define GCLOCK_DEFAULT_MAX_COUNT 3
+#define GCLOCK_MAX_COUNT 255
+
+// Replacement hints of pinPageWithHint; strategies without a mapping treat
+// every hint as PH_NORMAL
+typedef enum PinHint {
+	PH_NORMAL = 0,
+	PH_KEEP = 1,         // Protect the page, e.g. an index root
+	PH_EVICT_SOON = 2    // One-shot page, e.g. of a bulk scan: evict it first
+} PinHint;
+
+// Memory backing the frame area of a buffer pool
+typedef enum FrameMemoryMode {
+	FM_AUTO = 0,             // Huge pages for pools of at least one huge page
+	FM_HEAP = 1,             // Regular heap allocation
+	FM_TRANSPARENT_HUGE = 2, // Aligned mapping with madvise(MADV_HUGEPAGE)
+	FM_HUGETLB = 3,          // Explicit 2 MB huge pages (MAP_HUGETLB)
+	FM_SHARED = 4            // POSIX shared memory of a multi-process pool
+} FrameMemoryMode;
+
 // Data Types and Structures
 typedef int PageNumber;
 #define NO_PAGE -1
 
-// Frame information structure for buffer pool management
-typedef struct FrameInfo {
-	PageNumber pageNumber;
-	int dirtybit;
-	int accessCount;
-	int secondChance;    // Used for CLOCK algorithm
-	int recentHit;       // Used for LRU algorithm
-	int index;
-	char *data;
-} FrameInfo;
+// Identifies a page file registered with a buffer pool; the pool's own
+// pageFile is always registered as file 0
+typedef int FileId;
+#define DEFAULT_FILE_ID 0
+
+// Contiguous range of frames placed on one NUMA node, with its own
+// replacement hands
+typedef struct PoolPartition {
+	int node;
+	int firstFrame;
+	int numFrames;
+	int frameIndex;      // Used for FIFO algorithm, relative to firstFrame
+	int clockPointer;    // Used for CLOCK algorithm, relative to firstFrame
+	int sieveNewest;     // SIEVE insertion order: frame indices, -1 if none
+	int sieveOldest;
+	int sieveHand;       // Next frame the SIEVE hand looks at
+} PoolPartition;
+
+// Page file registered with a buffer pool, kept open for the pool's lifetime
+typedef struct PageFileEntry {
+	char *fileName;
+	SM_FileHandle fh;
+} PageFileEntry;
 
 // Buffer pool management information structure
+// Frame metadata is kept in dense arrays indexed by frame, so replacement
+// scans only touch the fields they test; per-frame flags are bitmaps with
+// 64 frames per word
 typedef struct BufferPoolInfo {
-	FrameInfo *frames;
+	PageNumber *pageNumbers;  // NO_PAGE for empty frames
+	FileId *fileIds;
+	int *fixCounts;
+	unsigned int *generations;  // Bumped whenever a frame receives a page
+	int *recentHits;     // Used for LRU algorithm
+	uint64_t *refBits;   // Used for CLOCK algorithm (second chance)
+	uint64_t *keepBits;  // Used for FIFO algorithm: PH_KEEP frames the hand skips once
+	uint8_t *usageCounts;  // Used for GCLOCK algorithm
+	int *newerFrames;    // Used for SIEVE algorithm: insertion order
+	int *olderFrames;    // within each partition, -1 at the ends
+	uint64_t *dirtyBits;
+	unsigned int *dirtySectors;  // Sectors modified since the last write-back,
+	                             // bit i for bytes [i * SECTOR_SIZE, (i + 1) * SECTOR_SIZE)
+	uint64_t *pinnedBits;  // Set while a frame's fix count is positive
+	void *frameMetadata;   // Single allocation holding the arrays above
+	char *frameArea;     // PAGE_SIZE bytes per frame, allocated at init
+	size_t frameAreaSize;
+	FrameMemoryMode frameMemory;  // Mode actually obtained for frameArea
+	PageFileEntry *files;  // File registry indexed by FileId
+	int numFiles;
+	int fileCapacity;
 	int readCount;
 	int writeCount;
+	long bytesWritten;   // Bytes of page data written back
+	long bytesSaved;     // Bytes partial write-backs did not have to write
 	int recentHitCount;
-	int frameIndex;      // Used for FIFO algorithm
-	int clockPointer;    // Used for CLOCK algorithm
+	int maxUsageCount;   // Saturation point of usageCounts
+	PoolPartition *partitions;  // One per NUMA node, or a single one
+	int numPartitions;
+	int localHits;       // Hits on frames of the caller's NUMA node
+	int remoteHits;
 	int bufferSize;
+	char *warmFile;      // Sidecar file for the hot page set, NULL if disabled
+	int warmSaveInterval;
+	int pinsSinceWarmSave;
+	int preloadCount;    // Pages installed from the warm file
+	struct WarmLoader *warmLoader;  // Background preload, NULL when finished
+	struct ClockPro *clockPro;      // CLOCK-Pro page ring, NULL for other strategies
+	struct Lirs *lirs;              // LIRS stack and queue, NULL for other strategies
+	struct Admission *admission;    // TinyLFU filter and bypass frames, NULL if disabled
+	struct Adaptive *adaptive;      // Shadow caches for runtime strategy selection, NULL if disabled
+	struct CustomPolicy *custom;    // Callbacks and state of an RS_CUSTOM pool, NULL otherwise
+	struct PinWait *pinWait;        // Lock and condition of bounded pin waits, NULL if disabled
+	struct CompressedCache *tier;   // Compressed second tier of evicted pages, NULL if disabled
+	struct VictimCache *victim;     // Local cache file of clean evicted pages, NULL if disabled
+	struct SharedPool *shared;      // Segment of a multi-process pool, NULL for a private pool
+	struct PoolStats *stats;        // Statistics segment read by monitors, NULL if disabled
+	int pinStalls;       // Pins that found every frame pinned
+	int pinTimeouts;     // Stalled pins that gave up with RC_ALL_FRAMES_PINNED
 } BufferPoolInfo;
 
 typedef struct BM_BufferPool {
@@ -50,37 +141,124 @@ typedef struct BM_BufferPool {
 	// manager needs for a buffer pool
 } BM_BufferPool;
 
+// Optional buffer pool features; a zero-initialized struct selects the defaults
+typedef struct BM_PoolOptions {
+	const char *warmFile;      // Sidecar file listing hot pages across restarts
+	int warmSaveInterval;      // Pins before forceFlushPool() also dumps (0 = only at shutdown)
+	FrameMemoryMode frameMemory;  // Preferred frame memory; falls back to
+	                              // transparent huge pages, then the heap
+	bool numaAware;            // Partition frames per NUMA node
+	bool admissionFilter;      // TinyLFU: cache a missed page only if it is
+	                           // more popular than the victim
+	bool adaptiveStrategy;     // Switch between FIFO, LRU and CLOCK at runtime
+	                           // when another one scores more hits
+	int pinWaitMs;             // When every frame is pinned, wait up to this long
+	                           // for an unpin before failing (0 = fail at once);
+	                           // page operations then take a pool lock
+	long compressedTierBytes;  // Keep evicted pages compressed in up to this many
+	                           // bytes of RAM and check them on misses (0 = disabled)
+	const char *victimCacheFile;  // Local page file caching clean evicted pages
+	                              // across restarts, NULL if disabled
+	int victimCachePages;      // Pages the victim cache file holds
+	const char *sharedPoolName;   // POSIX shared memory name ("/name") of a pool
+	                              // shared by processes, NULL for a private pool
+	const char *statsName;     // POSIX shared memory name ("/name") under which the
+	                           // pool publishes live statistics, NULL if disabled
+} BM_PoolOptions;
+
+// Callers may set pageNum and fileId to name the page unpin, markDirty and
+// forcePage act on; the other fields belong to pinPage
 typedef struct BM_PageHandle {
 	PageNumber pageNum;
 	char *data;
+	FileId fileId;
+	int frame;                // Set by pinPage: the page that was pinned, its
+	unsigned int generation;  // frame and the frame's generation; while pageNum
+	PageNumber pinnedPageNum; // and fileId still name that page, unpin,
+	FileId pinnedFileId;      // markDirty and forcePage skip the lookup
 } BM_PageHandle;
 
+// A handle that names no page and has no frame recorded
+static inline BM_PageHandle *makePageHandle(void)
+{
+	BM_PageHandle *page = (BM_PageHandle *) malloc(sizeof(BM_PageHandle));
+	if (page != NULL) {
+		page->pageNum = NO_PAGE;
+		page->data = NULL;
+		page->fileId = DEFAULT_FILE_ID;
+		page->frame = -1;
+		page->generation = 0;
+		page->pinnedPageNum = NO_PAGE;
+		page->pinnedFileId = DEFAULT_FILE_ID;
+	}
+	return page;
+}
+
 // convenience macros
 #define MAKE_POOL()					\
 		((BM_BufferPool *) malloc (sizeof(BM_BufferPool)))
 
 #define MAKE_PAGE_HANDLE()				\
-		((BM_PageHandle *) malloc (sizeof(BM_PageHandle)))
+		makePageHandle()
 
 // Buffer Manager Interface Pool Handling
 RC initBufferPool(BM_BufferPool *const bm, const char *const pageFileName, 
 		const int numPages, ReplacementStrategy strategy,
 		void *stratData);
+RC initBufferPoolWithOptions(BM_BufferPool *const bm, const char *const pageFileName,
+		const int numPages, ReplacementStrategy strategy,
+		void *stratData, const BM_PoolOptions *const options);
 RC shutdownBufferPool(BM_BufferPool *const bm);
 RC forceFlushPool(BM_BufferPool *const bm);
 
 // Buffer Manager Interface Access Pages
 RC markDirty (BM_BufferPool *const bm, BM_PageHandle *const page);
+RC markDirtyRange (BM_BufferPool *const bm, BM_PageHandle *const page,
+		const int offset, const int length);
 RC unpinPage (BM_BufferPool *const bm, BM_PageHandle *const page);
 RC forcePage (BM_BufferPool *const bm, BM_PageHandle *const page);
 RC pinPage (BM_BufferPool *const bm, BM_PageHandle *const page, 
 		const PageNumber pageNum);
+RC pinPageWithHint (BM_BufferPool *const bm, BM_PageHandle *const page,
+		const PageNumber pageNum, const PinHint hint);
+
+// Buffer Manager Interface Multiple Page Files
+RC registerPageFile (BM_BufferPool *const bm, const char *const pageFileName,
+		FileId *fileId);
+RC pinFilePage (BM_BufferPool *const bm, BM_PageHandle *const page,
+		const FileId fileId, const PageNumber pageNum);
+RC pinFilePageWithHint (BM_BufferPool *const bm, BM_PageHandle *const page,
+		const FileId fileId, const PageNumber pageNum, const PinHint hint);
 
 // Statistics Interface
 PageNumber *getFrameContents (BM_BufferPool *const bm);
 bool *getDirtyFlags (BM_BufferPool *const bm);
 int *getFixCounts (BM_BufferPool *const bm);
+FileId *getFrameFileIds (BM_BufferPool *const bm);
 int getNumReadIO (BM_BufferPool *const bm);
 int getNumWriteIO (BM_BufferPool *const bm);
+long getNumBytesWritten (BM_BufferPool *const bm);
+long getNumBytesSaved (BM_BufferPool *const bm);
+FrameMemoryMode getFrameMemoryMode (BM_BufferPool *const bm);
+int getNumPartitions (BM_BufferPool *const bm);
+int getNumLocalHits (BM_BufferPool *const bm);
+int getNumRemoteHits (BM_BufferPool *const bm);
+int getNumRejectedPages (BM_BufferPool *const bm);
+int getNumStrategySwitches (BM_BufferPool *const bm);
+int getNumPinStalls (BM_BufferPool *const bm);
+int getNumPinTimeouts (BM_BufferPool *const bm);
+int getNumTierHits (BM_BufferPool *const bm);
+int getNumTierMisses (BM_BufferPool *const bm);
+long getTierBytesUsed (BM_BufferPool *const bm);
+int getNumVictimHits (BM_BufferPool *const bm);
+int getNumVictimWrites (BM_BufferPool *const bm);
+int getNumVictimRestored (BM_BufferPool *const bm);
+int getNumSharedProcesses (BM_BufferPool *const bm);
+int getNumReclaimedProcesses (BM_BufferPool *const bm);
+
+// Buffer Manager Interface Warm-up
+RC saveWarmFile (BM_BufferPool *const bm);
+RC finishPreload (BM_BufferPool *const bm);
+int getNumPreloadedPages (BM_BufferPool *const bm);
 
 #endif
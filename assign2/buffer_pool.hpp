@@ -0,0 +1,411 @@
+#ifndef BUFFER_POOL_HPP
+#define BUFFER_POOL_HPP
+
+// Compile-time specialized buffer pool for C++ callers. The replacement
+// policy and the page size are template parameters, so the hit path inlines
+// the policy's bookkeeping and frame addressing multiplies by a constant.
+// Pages of PageSize bytes span PageSize / PAGE_SIZE consecutive blocks of
+// the page file. Errors are reported with the RC codes of the C interface.
+
+extern "C" {
+#include "dberror.h"
+#include "storage_mgr.h"
+#include "buffer_mgr.h"
+#include "frame_scan.h"
+}
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace bm {
+
+// FIFO: a hand replaces frames in load order, skipping pinned ones
+class FifoPolicy {
+public:
+	static const char *name() { return "FIFO"; }
+
+	bool init(int frames)
+	{
+		numFrames = frames;
+		hand = 0;
+		return true;
+	}
+
+	void onHit(int) {}
+	void onInsert(int) {}
+
+	int pickVictim(const int *fixCounts)
+	{
+		for (int scanned = 0; scanned < numFrames; scanned++) {
+			int idx = (hand + scanned) % numFrames;
+			if (fixCounts[idx] == 0) {
+				hand = (idx + 1) % numFrames;
+				return idx;
+			}
+		}
+		return -1;
+	}
+
+private:
+	int numFrames = 0;
+	int hand = 0;
+};
+
+// LRU: pins stamp their frame; the oldest unpinned stamp is replaced
+class LruPolicy {
+public:
+	static const char *name() { return "LRU"; }
+
+	bool init(int frames)
+	{
+		numFrames = frames;
+		clock = 0;
+		stamps.reset(new (std::nothrow) int[frames]());
+		return stamps != nullptr;
+	}
+
+	void onHit(int idx) { stamps[idx] = ++clock; }
+	void onInsert(int idx) { stamps[idx] = ++clock; }
+
+	int pickVictim(const int *fixCounts)
+	{
+		return scanMinUnpinned(stamps.get(), fixCounts, numFrames);
+	}
+
+private:
+	int numFrames = 0;
+	int clock = 0;
+	std::unique_ptr<int[]> stamps;
+};
+
+// CLOCK: hits set a reference bit; the hand clears the bits of unpinned
+// frames it passes and replaces the first one found without
+class ClockPolicy {
+public:
+	static const char *name() { return "CLOCK"; }
+
+	bool init(int frames)
+	{
+		numFrames = frames;
+		hand = 0;
+		refBits.reset(new (std::nothrow) uint8_t[frames]());
+		return refBits != nullptr;
+	}
+
+	void onHit(int idx) { refBits[idx] = 1; }
+	void onInsert(int idx) { refBits[idx] = 0; }
+
+	int pickVictim(const int *fixCounts)
+	{
+		// Two sweeps clear every reference bit
+		for (int scanned = 0; scanned < numFrames * 2; scanned++) {
+			int idx = hand;
+			hand = (hand + 1) % numFrames;
+			if (fixCounts[idx] != 0) {
+				continue;
+			}
+			if (!refBits[idx]) {
+				return idx;
+			}
+			refBits[idx] = 0;
+		}
+		return -1;
+	}
+
+private:
+	int numFrames = 0;
+	int hand = 0;
+	std::unique_ptr<uint8_t[]> refBits;
+};
+
+// Page pinned in a BufferPool; the frame makes unpin and markDirty O(1)
+struct PageRef {
+	PageNumber pageNum = NO_PAGE;
+	int frame = -1;
+	char *data = nullptr;
+};
+
+template <class Policy, std::size_t PageSize = PAGE_SIZE>
+class BufferPool {
+	static_assert(PageSize > 0 && PageSize % PAGE_SIZE == 0,
+	              "a page spans whole blocks of the page file");
+
+public:
+	static constexpr std::size_t pageSize = PageSize;
+	static constexpr int blocksPerPage = static_cast<int>(PageSize / PAGE_SIZE);
+
+	BufferPool() = default;
+	BufferPool(const BufferPool &) = delete;
+	BufferPool &operator=(const BufferPool &) = delete;
+
+	// Writes back dirty pages and closes the file if shutdown() was not
+	// called; pins still held are dropped
+	~BufferPool()
+	{
+		if (isOpen) {
+			forceFlush();
+			closePageFile(&fh);
+		}
+	}
+
+	// Opens the page file and allocates numFrames empty frames
+	RC init(const char *pageFileName, int frames)
+	{
+		if (isOpen) {
+			return RC_ERROR;
+		}
+		if (pageFileName == nullptr) {
+			return RC_FILE_NOT_FOUND;
+		}
+		if (frames <= 0) {
+			return RC_ERROR;
+		}
+
+		pageNumbers.reset(new (std::nothrow) PageNumber[frames]);
+		fixCounts.reset(new (std::nothrow) int[frames]());
+		dirty.reset(new (std::nothrow) bool[frames]());
+		frameArea.reset(new (std::nothrow) char[static_cast<std::size_t>(frames) * PageSize]);
+		if (pageNumbers == nullptr || fixCounts == nullptr || dirty == nullptr ||
+		    frameArea == nullptr || !policy.init(frames)) {
+			return RC_ERROR;
+		}
+		for (int i = 0; i < frames; i++) {
+			pageNumbers[i] = NO_PAGE;
+		}
+
+		RC result = openPageFile(pageFileName, &fh);
+		if (result != RC_OK) {
+			return result;
+		}
+
+		numFrames = frames;
+		readCount = 0;
+		writeCount = 0;
+		isOpen = true;
+		return RC_OK;
+	}
+
+	// Writes back dirty pages and closes the file; fails while pages are pinned
+	RC shutdown()
+	{
+		if (!isOpen) {
+			return RC_BUFF_POOL_NOT_FOUND;
+		}
+
+		RC result = forceFlush();
+		if (result != RC_OK) {
+			return result;
+		}
+		for (int i = 0; i < numFrames; i++) {
+			if (fixCounts[i] != 0) {
+				return RC_PINNED_PAGES_IN_BUFFER;
+			}
+		}
+
+		isOpen = false;
+		return closePageFile(&fh);
+	}
+
+	// Pins a page, reading it into an empty frame or the policy's victim on a miss
+	RC pin(PageNumber pageNum, PageRef &ref)
+	{
+		if (!isOpen) {
+			return RC_BUFF_POOL_NOT_FOUND;
+		}
+		if (pageNum < 0) {
+			return RC_READ_NON_EXISTING_PAGE;
+		}
+
+		int idx = frameOf(pageNum);
+		if (idx != -1) {
+			pinFrame(idx, ref);
+			return RC_OK;
+		}
+
+		PendingLoad load;
+		RC result = reserveFrame(pageNum, load);
+		if (result != RC_OK) {
+			return result;
+		}
+		result = readPage(load);
+		completeLoad(load, result);
+		if (result == RC_OK) {
+			ref = load.ref;
+		}
+		return result;
+	}
+
+	// Frame holding a page, or -1
+	int frameOf(PageNumber pageNum) const
+	{
+		return scanFindPage(pageNumbers.get(), 0, numFrames, pageNum);
+	}
+
+	// Pins the page cached in frame idx
+	void pinFrame(int idx, PageRef &ref)
+	{
+		fixCounts[idx]++;
+		policy.onHit(idx);
+		ref.pageNum = pageNumbers[idx];
+		ref.frame = idx;
+		ref.data = frameData(idx);
+	}
+
+	// Page read in progress: reserveFrame() claims a frame for the page with
+	// one pin, readPage() may then run on any thread, since it only touches
+	// the frame and a copy of the file handle, and completeLoad() publishes
+	// the page or frees the frame again. Until then frameOf() already finds
+	// the page, so callers loading asynchronously must track such frames.
+	struct PendingLoad {
+		PageRef ref;
+		SM_FileHandle fh;
+	};
+
+	RC reserveFrame(PageNumber pageNum, PendingLoad &load)
+	{
+		if (!isOpen) {
+			return RC_BUFF_POOL_NOT_FOUND;
+		}
+		if (pageNum < 0) {
+			return RC_READ_NON_EXISTING_PAGE;
+		}
+
+		int idx = frameOf(NO_PAGE);
+		if (idx == -1) {
+			idx = policy.pickVictim(fixCounts.get());
+			if (idx == -1) {
+				return RC_ALL_FRAMES_PINNED;
+			}
+			if (dirty[idx] && writeFrame(idx) != RC_OK) {
+				return RC_WRITE_BACK_FAILED;
+			}
+			pageNumbers[idx] = NO_PAGE;
+		}
+
+		ensureCapacity((pageNum + 1) * blocksPerPage, &fh);
+		pageNumbers[idx] = pageNum;
+		fixCounts[idx] = 1;
+		dirty[idx] = false;
+
+		load.ref.pageNum = pageNum;
+		load.ref.frame = idx;
+		load.ref.data = frameData(idx);
+		load.fh = fh;
+		return RC_OK;
+	}
+
+	static RC readPage(PendingLoad &load)
+	{
+		if (readBlocks(load.ref.pageNum * blocksPerPage, blocksPerPage, &load.fh,
+		               load.ref.data) != RC_OK) {
+			return RC_READ_NON_EXISTING_PAGE;
+		}
+		return RC_OK;
+	}
+
+	void completeLoad(const PendingLoad &load, RC readResult)
+	{
+		int idx = load.ref.frame;
+		if (readResult != RC_OK) {
+			pageNumbers[idx] = NO_PAGE;
+			fixCounts[idx] = 0;
+			return;
+		}
+		readCount++;
+		policy.onInsert(idx);
+	}
+
+	// Releases one pin of a page
+	RC unpin(const PageRef &ref)
+	{
+		if (!holds(ref) || fixCounts[ref.frame] == 0) {
+			return RC_ERROR;
+		}
+		fixCounts[ref.frame]--;
+		return RC_OK;
+	}
+
+	// Marks a pinned page as modified
+	RC markDirty(const PageRef &ref)
+	{
+		if (!holds(ref)) {
+			return RC_ERROR;
+		}
+		dirty[ref.frame] = true;
+		return RC_OK;
+	}
+
+	// Writes a page back now
+	RC forcePage(const PageRef &ref)
+	{
+		if (!holds(ref)) {
+			return RC_ERROR;
+		}
+		return writeFrame(ref.frame);
+	}
+
+	// Writes back every dirty unpinned page
+	RC forceFlush()
+	{
+		for (int i = 0; i < numFrames; i++) {
+			if (dirty[i] && fixCounts[i] == 0) {
+				RC result = writeFrame(i);
+				if (result != RC_OK) {
+					return result;
+				}
+			}
+		}
+		return RC_OK;
+	}
+
+	int frames() const { return numFrames; }
+	PageNumber pageAt(int idx) const { return pageNumbers[idx]; }
+	int fixCountAt(int idx) const { return fixCounts[idx]; }
+	bool dirtyAt(int idx) const { return dirty[idx]; }
+	int numReadIO() const { return readCount; }
+	int numWriteIO() const { return writeCount; }
+	static const char *strategyName() { return Policy::name(); }
+
+private:
+	char *frameData(int idx) { return frameArea.get() + static_cast<std::size_t>(idx) * PageSize; }
+
+	bool holds(const PageRef &ref) const
+	{
+		return isOpen && ref.frame >= 0 && ref.frame < numFrames &&
+		       pageNumbers[ref.frame] == ref.pageNum;
+	}
+
+	RC writeFrame(int idx)
+	{
+		char *data = frameData(idx);
+		for (int b = 0; b < blocksPerPage; b++) {
+			if (writeBlock(pageNumbers[idx] * blocksPerPage + b, &fh, data + b * PAGE_SIZE) != RC_OK) {
+				return RC_WRITE_FAILED;
+			}
+		}
+		dirty[idx] = false;
+		writeCount++;
+		return RC_OK;
+	}
+
+	Policy policy;
+	SM_FileHandle fh;
+	bool isOpen = false;
+	int numFrames = 0;
+	int readCount = 0;
+	int writeCount = 0;
+	std::unique_ptr<PageNumber[]> pageNumbers;
+	std::unique_ptr<int[]> fixCounts;
+	std::unique_ptr<bool[]> dirty;
+	std::unique_ptr<char[]> frameArea;
+};
+
+// Common configurations, matching RS_FIFO, RS_LRU and RS_CLOCK
+using FifoBufferPool = BufferPool<FifoPolicy>;
+using LruBufferPool = BufferPool<LruPolicy>;
+using ClockBufferPool = BufferPool<ClockPolicy>;
+
+} // namespace bm
+
+#endif
@@ -0,0 +1,256 @@
+#include <stdlib.h>
+#include <string.h>
+#include "compressed_cache.h"
+#include "page_compress.h"
+
+/* Pages must shrink by at least this fraction of PAGE_SIZE to be stored */
+#define MIN_SAVING_DIVISOR 8
+
+/*
+ * Bucket of a page key (splitmix64 finalizer)
+ */
+static inline int bucketOf(const CompressedCache *cache, FileId fileId, PageNumber pageNum)
+{
+    uint64_t h = ((uint64_t)(uint32_t)fileId << 32) | (uint32_t)pageNum;
+    h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+    h ^= h >> 31;
+    return (int)(h & (uint64_t)cache->bucketMask);
+}
+
+/*
+ * Finds the entry holding a page
+ * @return Entry index, -1 if the page is not in the tier
+ */
+static int findEntry(const CompressedCache *cache, FileId fileId, PageNumber pageNum)
+{
+    for (int e = cache->buckets[bucketOf(cache, fileId, pageNum)]; e != -1;
+         e = cache->entries[e].hashNext) {
+        if (cache->entries[e].pageNum == pageNum && cache->entries[e].fileId == fileId) {
+            return e;
+        }
+    }
+    return -1;
+}
+
+/*
+ * Removes an entry from the hash chains and the storage order, frees its
+ * image and returns it to the free list
+ */
+static void removeEntry(CompressedCache *cache, int e)
+{
+    CompressedEntry *entry = &cache->entries[e];
+
+    int *link = &cache->buckets[bucketOf(cache, entry->fileId, entry->pageNum)];
+    while (*link != e) {
+        link = &cache->entries[*link].hashNext;
+    }
+    *link = entry->hashNext;
+
+    if (entry->newer != -1) {
+        cache->entries[entry->newer].older = entry->older;
+    } else {
+        cache->newest = entry->older;
+    }
+    if (entry->older != -1) {
+        cache->entries[entry->older].newer = entry->newer;
+    } else {
+        cache->oldest = entry->newer;
+    }
+
+    cache->bytesUsed -= entry->size;
+    free(entry->data);
+    entry->data = NULL;
+    entry->pageNum = NO_PAGE;
+    entry->older = cache->freeEntries;
+    cache->freeEntries = e;
+}
+
+/*
+ * Expands an entry into the page half of the scratch buffer and writes it back
+ * @return 0 on success, -1 if the image is corrupt or the write failed
+ */
+static int writeBackEntry(CompressedCache *cache, CompressedEntry *entry,
+                          CompressedWriteBack writeBack, void *context)
+{
+    char *page = cache->scratch + PAGE_SIZE;
+    if (decompressPage(entry->data, entry->size, page, PAGE_SIZE) != 0 ||
+        writeBack(context, entry->fileId, entry->pageNum, page) != 0) {
+        return -1;
+    }
+    entry->dirty = 0;
+    return 0;
+}
+
+/*
+ * Creates an empty tier
+ * @param cache - Tier to initialize
+ * @param byteLimit - Cap on the compressed page images held
+ * @return 0 on success, -1 if out of memory or byteLimit is not positive
+ */
+extern int initCompressedCache(CompressedCache *cache, long byteLimit)
+{
+    if (byteLimit <= 0) {
+        return -1;
+    }
+
+    long capacity = byteLimit / COMPRESSED_BYTES_PER_ENTRY + 1;
+    if (capacity > (1L << 30)) {
+        return -1;
+    }
+    int numBuckets = 1;
+    while (numBuckets < capacity) {
+        numBuckets <<= 1;
+    }
+
+    cache->entries = (CompressedEntry*)malloc(sizeof(CompressedEntry) * capacity);
+    cache->buckets = (int*)malloc(sizeof(int) * numBuckets);
+    cache->scratch = (char*)malloc(2 * PAGE_SIZE);
+    if (cache->entries == NULL || cache->buckets == NULL || cache->scratch == NULL) {
+        free(cache->entries);
+        free(cache->buckets);
+        free(cache->scratch);
+        return -1;
+    }
+
+    for (int i = 0; i < numBuckets; i++) {
+        cache->buckets[i] = -1;
+    }
+    for (int e = 0; e < capacity; e++) {
+        cache->entries[e].pageNum = NO_PAGE;
+        cache->entries[e].data = NULL;
+        cache->entries[e].older = (e + 1 < capacity) ? e + 1 : -1;
+    }
+    cache->bucketMask = numBuckets - 1;
+    cache->capacity = (int)capacity;
+    cache->freeEntries = 0;
+    cache->newest = -1;
+    cache->oldest = -1;
+    cache->byteLimit = byteLimit;
+    cache->bytesUsed = 0;
+    cache->hits = 0;
+    cache->misses = 0;
+    return 0;
+}
+
+/*
+ * Frees every page image and the tables of a tier, without write-backs
+ */
+extern void freeCompressedCache(CompressedCache *cache)
+{
+    for (int e = cache->newest; e != -1; e = cache->entries[e].older) {
+        free(cache->entries[e].data);
+    }
+    free(cache->entries);
+    free(cache->buckets);
+    free(cache->scratch);
+    cache->entries = NULL;
+    cache->buckets = NULL;
+    cache->scratch = NULL;
+}
+
+/*
+ * Compresses a page evicted from the pool into the tier
+ * The oldest pages are dropped until the new one fits, modified ones
+ * after a write-back
+ * @param dirty - Whether the page was modified since it was last written
+ * @param writeBack - Writes the dropped pages
+ * @param context - Passed to writeBack
+ * @return 1 if stored, 0 if the page compresses poorly or memory is
+ *         short (nothing was changed), -1 if a write-back failed
+ */
+extern int storeCompressedPage(CompressedCache *cache, FileId fileId, PageNumber pageNum,
+                               const char *page, bool dirty, CompressedWriteBack writeBack,
+                               void *context)
+{
+    int size = compressPage(page, PAGE_SIZE, cache->scratch,
+                            PAGE_SIZE - PAGE_SIZE / MIN_SAVING_DIVISOR);
+    if (size == 0 || size > cache->byteLimit) {
+        return 0;
+    }
+
+    char *data = (char*)malloc(size);
+    if (data == NULL) {
+        return 0;
+    }
+    memcpy(data, cache->scratch, size);
+
+    /* A stale copy is replaced; its modifications are in the new image */
+    int e = findEntry(cache, fileId, pageNum);
+    if (e != -1) {
+        dirty = dirty || cache->entries[e].dirty;
+        removeEntry(cache, e);
+    }
+
+    while (cache->bytesUsed + size > cache->byteLimit || cache->freeEntries == -1) {
+        CompressedEntry *oldest = &cache->entries[cache->oldest];
+        if (oldest->dirty && writeBackEntry(cache, oldest, writeBack, context) != 0) {
+            free(data);
+            return -1;
+        }
+        removeEntry(cache, cache->oldest);
+    }
+
+    e = cache->freeEntries;
+    CompressedEntry *entry = &cache->entries[e];
+    cache->freeEntries = entry->older;
+
+    entry->fileId = fileId;
+    entry->pageNum = pageNum;
+    entry->data = data;
+    entry->size = size;
+    entry->dirty = dirty;
+
+    int bucket = bucketOf(cache, fileId, pageNum);
+    entry->hashNext = cache->buckets[bucket];
+    cache->buckets[bucket] = e;
+
+    entry->newer = -1;
+    entry->older = cache->newest;
+    if (cache->newest != -1) {
+        cache->entries[cache->newest].newer = e;
+    } else {
+        cache->oldest = e;
+    }
+    cache->newest = e;
+    cache->bytesUsed += size;
+    return 1;
+}
+
+/*
+ * Moves a page out of the tier
+ * @param page - Receives the PAGE_SIZE bytes of the page
+ * @param dirty - Set if the page was modified and not yet written back
+ * @return true on a hit, false if the page is not in the tier
+ */
+extern bool takeCompressedPage(CompressedCache *cache, FileId fileId, PageNumber pageNum,
+                               char *page, bool *dirty)
+{
+    int e = findEntry(cache, fileId, pageNum);
+    if (e == -1 ||
+        decompressPage(cache->entries[e].data, cache->entries[e].size, page, PAGE_SIZE) != 0) {
+        cache->misses++;
+        return false;
+    }
+
+    *dirty = cache->entries[e].dirty;
+    removeEntry(cache, e);
+    cache->hits++;
+    return true;
+}
+
+/*
+ * Writes back every modified page, oldest first; the pages stay in the tier
+ * @return 0 on success, -1 if a write-back failed
+ */
+extern int flushCompressedCache(CompressedCache *cache, CompressedWriteBack writeBack,
+                                void *context)
+{
+    for (int e = cache->oldest; e != -1; e = cache->entries[e].newer) {
+        if (cache->entries[e].dirty &&
+            writeBackEntry(cache, &cache->entries[e], writeBack, context) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
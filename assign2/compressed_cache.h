@@ -0,0 +1,65 @@
+#ifndef COMPRESSED_CACHE_H
+#define COMPRESSED_CACHE_H
+
+// Second cache tier for pages evicted from a buffer pool: page images are
+// compressed (page_compress.h) and kept in RAM up to a byte limit, dropping
+// the least recently stored first. The tier is exclusive, a page leaves it
+// when the pool reads it back. Modified pages stay modified in the tier and
+// are written back when it drops or flushes them.
+
+#include "buffer_mgr.h"
+
+typedef struct CompressedEntry {
+	FileId fileId;
+	PageNumber pageNum;  // NO_PAGE for free entries
+	char *data;          // Compressed page image
+	int size;
+	int dirty;
+	int newer;           // Storage order, -1 at the ends; free entries
+	int older;           // are chained through older
+	int hashNext;        // Next entry of the same bucket, -1 at the end
+} CompressedEntry;
+
+typedef struct CompressedCache {
+	CompressedEntry *entries;
+	int *buckets;        // First entry of each hash bucket, -1 if none
+	int bucketMask;
+	int capacity;        // One entry per COMPRESSED_BYTES_PER_ENTRY of the limit
+	int freeEntries;     // First free entry, -1 if none
+	int newest;          // Entries in storage order, -1 if empty
+	int oldest;
+	long byteLimit;      // Cap on the compressed images held
+	long bytesUsed;
+	char *scratch;       // A compressed image and an expanded page
+	int hits;            // Pool misses served by the tier
+	int misses;          // Pool misses that went to disk
+} CompressedCache;
+
+// Entries per byte of the limit: room for pages compressed 16 to 1
+#define COMPRESSED_BYTES_PER_ENTRY (PAGE_SIZE / 16)
+
+// Writes back a page the tier drops or flushes; returns 0 on success
+typedef int (*CompressedWriteBack) (void *context, FileId fileId,
+		PageNumber pageNum, const char *page);
+
+// Creates an empty tier; returns 0 on success, -1 if out of memory or the
+// limit is not positive
+int initCompressedCache (CompressedCache *cache, long byteLimit);
+void freeCompressedCache (CompressedCache *cache);
+
+// Keeps a page evicted from the pool, dropping the oldest pages to stay
+// under the limit; returns 1 if stored, 0 if the page does not compress
+// well enough to be worth keeping, -1 if writing back a dropped page failed
+int storeCompressedPage (CompressedCache *cache, FileId fileId, PageNumber pageNum,
+		const char *page, bool dirty, CompressedWriteBack writeBack, void *context);
+
+// Moves a page out of the tier into page (PAGE_SIZE bytes) and counts a
+// hit, or counts a miss; *dirty tells if the page still needs a write-back
+bool takeCompressedPage (CompressedCache *cache, FileId fileId, PageNumber pageNum,
+		char *page, bool *dirty);
+
+// Writes back every modified page; returns 0 on success, -1 if a write failed
+int flushCompressedCache (CompressedCache *cache, CompressedWriteBack writeBack,
+		void *context);
+
+#endif
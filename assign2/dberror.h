@@ -18,6 +18,8 @@ typedef int RC;
 #define RC_BUFF_POOL_NOT_FOUND 6
 #define RC_WRITE_BACK_FAILED 7
 #define RC_PINNED_PAGES_IN_BUFFER 8
+#define RC_ALL_FRAMES_PINNED 9
+#define RC_PAGE_NOT_PINNED 10
 
 #define RC_RM_COMPARE_VALUE_OF_DIFFERENT_DATATYPE 200
 #define RC_RM_EXPR_RESULT_IS_NOT_BOOLEAN 201
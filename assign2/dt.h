@@ -1,11 +1,10 @@
 #ifndef DT_H
 #define DT_H
 
-// define bool if not defined
-#ifndef bool
-    typedef short bool;
-#define true 1
-#define false 0
+// define bool if not defined; C99's bool has the layout of the C++ type, so
+// structs and bool arrays of the interface can be shared with C++ callers
+#if !defined(bool) && !defined(__cplusplus)
+#include <stdbool.h>
 #endif
 
 #define TRUE true
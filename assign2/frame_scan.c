@@ -0,0 +1,256 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <limits.h>
+#include <pthread.h>
+#include "frame_scan.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define FRAME_SCAN_X86 1
+#include <immintrin.h>
+#endif
+
+/* Kernels selected for this CPU */
+static int (*findPageKernel)(const PageNumber *, int, int, PageNumber) = scanFindPageScalar;
+static int (*minUnpinnedKernel)(const int *, const int *, int) = scanMinUnpinnedScalar;
+static const char *kernelName = "scalar";
+static pthread_once_t kernelOnce = PTHREAD_ONCE_INIT;
+
+/*
+ * Finds the first frame holding a page, one frame at a time
+ * @param pageNumbers - Page number of each frame
+ * @param start - First frame to look at
+ * @param n - Number of frames
+ * @param pageNum - Page number to look for
+ * @return Frame index, or -1 if no frame holds the page
+ */
+extern int scanFindPageScalar(const PageNumber *pageNumbers, int start, int n, PageNumber pageNum)
+{
+    for (int i = start; i < n; i++) {
+        if (pageNumbers[i] == pageNum) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/*
+ * Finds the unpinned frame with the smallest stamp, one frame at a time
+ * @param stamps - Replacement stamp of each frame
+ * @param fixCounts - Fix count of each frame
+ * @param n - Number of frames
+ * @return Frame index, or -1 if all frames are pinned
+ */
+extern int scanMinUnpinnedScalar(const int *stamps, const int *fixCounts, int n)
+{
+    int minIdx = -1;
+    int minStamp = INT_MAX;
+
+    for (int i = 0; i < n; i++) {
+        if (fixCounts[i] == 0 && (minIdx == -1 || stamps[i] < minStamp)) {
+            minStamp = stamps[i];
+            minIdx = i;
+        }
+    }
+    return minIdx;
+}
+
+#ifdef FRAME_SCAN_X86
+
+/* Returns the first lane of a reduction that holds the minimum stamp */
+static int reduceMinLanes(const int *laneMin, const int *laneIdx, int lanes)
+{
+    int minIdx = -1;
+    int minStamp = INT_MAX;
+
+    for (int l = 0; l < lanes; l++) {
+        if (laneIdx[l] != -1 &&
+            (minIdx == -1 || laneMin[l] < minStamp ||
+             (laneMin[l] == minStamp && laneIdx[l] < minIdx))) {
+            minStamp = laneMin[l];
+            minIdx = laneIdx[l];
+        }
+    }
+    return minIdx;
+}
+
+/* Folds a scalar tail into a lane reduction result */
+static int mergeTail(const int *stamps, const int *fixCounts, int from, int n, int minIdx)
+{
+    for (int i = from; i < n; i++) {
+        if (fixCounts[i] == 0 && (minIdx == -1 || stamps[i] < stamps[minIdx])) {
+            minIdx = i;
+        }
+    }
+    return minIdx;
+}
+
+/*
+ * AVX2 page lookup: compares 16 page numbers per iteration
+ */
+__attribute__((target("avx2")))
+static int scanFindPageAvx2(const PageNumber *pageNumbers, int start, int n, PageNumber pageNum)
+{
+    __m256i key = _mm256_set1_epi32(pageNum);
+    int i = start;
+
+    for (; i + 16 <= n; i += 16) {
+        __m256i lo = _mm256_loadu_si256((const __m256i*)(pageNumbers + i));
+        __m256i hi = _mm256_loadu_si256((const __m256i*)(pageNumbers + i + 8));
+        unsigned int mask = (unsigned int)_mm256_movemask_ps(
+                                _mm256_castsi256_ps(_mm256_cmpeq_epi32(lo, key))) |
+                            ((unsigned int)_mm256_movemask_ps(
+                                _mm256_castsi256_ps(_mm256_cmpeq_epi32(hi, key))) << 8);
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return scanFindPageScalar(pageNumbers, i, n, pageNum);
+}
+
+/*
+ * AVX2 victim search: tracks the minimum stamp of unpinned frames in 8 lanes
+ */
+__attribute__((target("avx2")))
+static int scanMinUnpinnedAvx2(const int *stamps, const int *fixCounts, int n)
+{
+    __m256i zero = _mm256_setzero_si256();
+    __m256i unset = _mm256_set1_epi32(-1);
+    __m256i step = _mm256_set1_epi32(8);
+    __m256i idx = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    __m256i minStamp = _mm256_set1_epi32(INT_MAX);
+    __m256i minIdx = unset;
+    int i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        __m256i stamp = _mm256_loadu_si256((const __m256i*)(stamps + i));
+        __m256i unpinned = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*)(fixCounts + i)),
+                                              zero);
+        /* A lane takes the frame if it is unpinned and either the lane is
+         * still empty or the stamp is strictly smaller */
+        __m256i better = _mm256_or_si256(_mm256_cmpgt_epi32(minStamp, stamp),
+                                         _mm256_cmpeq_epi32(minIdx, unset));
+        __m256i take = _mm256_and_si256(unpinned, better);
+        minStamp = _mm256_blendv_epi8(minStamp, stamp, take);
+        minIdx = _mm256_blendv_epi8(minIdx, idx, take);
+        idx = _mm256_add_epi32(idx, step);
+    }
+
+    int laneMin[8];
+    int laneIdx[8];
+    _mm256_storeu_si256((__m256i*)laneMin, minStamp);
+    _mm256_storeu_si256((__m256i*)laneIdx, minIdx);
+    return mergeTail(stamps, fixCounts, i, n, reduceMinLanes(laneMin, laneIdx, 8));
+}
+
+/*
+ * SSE4.1 page lookup: compares 8 page numbers per iteration
+ */
+__attribute__((target("sse4.1")))
+static int scanFindPageSse41(const PageNumber *pageNumbers, int start, int n, PageNumber pageNum)
+{
+    __m128i key = _mm_set1_epi32(pageNum);
+    int i = start;
+
+    for (; i + 8 <= n; i += 8) {
+        __m128i lo = _mm_loadu_si128((const __m128i*)(pageNumbers + i));
+        __m128i hi = _mm_loadu_si128((const __m128i*)(pageNumbers + i + 4));
+        unsigned int mask = (unsigned int)_mm_movemask_ps(
+                                _mm_castsi128_ps(_mm_cmpeq_epi32(lo, key))) |
+                            ((unsigned int)_mm_movemask_ps(
+                                _mm_castsi128_ps(_mm_cmpeq_epi32(hi, key))) << 4);
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return scanFindPageScalar(pageNumbers, i, n, pageNum);
+}
+
+/*
+ * SSE4.1 victim search: tracks the minimum stamp of unpinned frames in 4 lanes
+ */
+__attribute__((target("sse4.1")))
+static int scanMinUnpinnedSse41(const int *stamps, const int *fixCounts, int n)
+{
+    __m128i zero = _mm_setzero_si128();
+    __m128i unset = _mm_set1_epi32(-1);
+    __m128i step = _mm_set1_epi32(4);
+    __m128i idx = _mm_setr_epi32(0, 1, 2, 3);
+    __m128i minStamp = _mm_set1_epi32(INT_MAX);
+    __m128i minIdx = unset;
+    int i = 0;
+
+    for (; i + 4 <= n; i += 4) {
+        __m128i stamp = _mm_loadu_si128((const __m128i*)(stamps + i));
+        __m128i unpinned = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(fixCounts + i)), zero);
+        __m128i better = _mm_or_si128(_mm_cmpgt_epi32(minStamp, stamp),
+                                      _mm_cmpeq_epi32(minIdx, unset));
+        __m128i take = _mm_and_si128(unpinned, better);
+        minStamp = _mm_blendv_epi8(minStamp, stamp, take);
+        minIdx = _mm_blendv_epi8(minIdx, idx, take);
+        idx = _mm_add_epi32(idx, step);
+    }
+
+    int laneMin[4];
+    int laneIdx[4];
+    _mm_storeu_si128((__m128i*)laneMin, minStamp);
+    _mm_storeu_si128((__m128i*)laneIdx, minIdx);
+    return mergeTail(stamps, fixCounts, i, n, reduceMinLanes(laneMin, laneIdx, 4));
+}
+
+#endif
+
+/*
+ * Selects the kernels for the CPU we are running on
+ */
+static void selectKernels(void)
+{
+#ifdef FRAME_SCAN_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        findPageKernel = scanFindPageAvx2;
+        minUnpinnedKernel = scanMinUnpinnedAvx2;
+        kernelName = "avx2";
+    } else if (__builtin_cpu_supports("sse4.1")) {
+        findPageKernel = scanFindPageSse41;
+        minUnpinnedKernel = scanMinUnpinnedSse41;
+        kernelName = "sse4.1";
+    }
+#endif
+}
+
+/*
+ * Finds the first frame holding a page with the fastest available kernel
+ * @param pageNumbers - Page number of each frame
+ * @param start - First frame to look at
+ * @param n - Number of frames
+ * @param pageNum - Page number to look for
+ * @return Frame index, or -1 if no frame holds the page
+ */
+extern int scanFindPage(const PageNumber *pageNumbers, int start, int n, PageNumber pageNum)
+{
+    pthread_once(&kernelOnce, selectKernels);
+    return findPageKernel(pageNumbers, start, n, pageNum);
+}
+
+/*
+ * Finds the unpinned frame with the smallest stamp with the fastest
+ * available kernel
+ * @param stamps - Replacement stamp of each frame
+ * @param fixCounts - Fix count of each frame
+ * @param n - Number of frames
+ * @return Frame index, or -1 if all frames are pinned
+ */
+extern int scanMinUnpinned(const int *stamps, const int *fixCounts, int n)
+{
+    pthread_once(&kernelOnce, selectKernels);
+    return minUnpinnedKernel(stamps, fixCounts, n);
+}
+
+/*
+ * Returns the name of the kernel set in use
+ */
+extern const char *scanKernelName(void)
+{
+    pthread_once(&kernelOnce, selectKernels);
+    return kernelName;
+}
@@ -0,0 +1,24 @@
+#ifndef FRAME_SCAN_H
+#define FRAME_SCAN_H
+
+// Vectorized scans over the dense frame metadata arrays of a buffer pool.
+// The best kernel supported by the CPU (AVX2, SSE4.1 or scalar) is selected
+// at runtime on first use.
+
+#include "buffer_mgr.h"
+
+// Index of the first frame in [start, n) holding pageNum, or -1
+int scanFindPage (const PageNumber *pageNumbers, int start, int n, PageNumber pageNum);
+
+// Index of the unpinned frame with the smallest stamp in [0, n), the first
+// one on ties, or -1 if every frame is pinned
+int scanMinUnpinned (const int *stamps, const int *fixCounts, int n);
+
+// Scalar versions, used as fallback and for benchmarking
+int scanFindPageScalar (const PageNumber *pageNumbers, int start, int n, PageNumber pageNum);
+int scanMinUnpinnedScalar (const int *stamps, const int *fixCounts, int n);
+
+// Name of the kernel set in use ("avx2", "sse4.1" or "scalar")
+const char *scanKernelName (void);
+
+#endif
@@ -0,0 +1,115 @@
+#include <stdlib.h>
+#include "frequency_sketch.h"
+
+/* Rows of the sketch, each indexed by its own hash of the key */
+#define SKETCH_DEPTH 4
+
+/* Counters saturate at the largest 4-bit value */
+#define SKETCH_MAX_COUNT 15
+
+/* Accesses recorded per cache entry before all counters are halved */
+#define SKETCH_SAMPLE_FACTOR 10
+
+/* Seeds of the row hashes */
+static const uint64_t rowSeeds[SKETCH_DEPTH] = {
+    0x9E3779B97F4A7C15ULL, 0xC2B2AE3D27D4EB4FULL,
+    0x165667B19E3779F9ULL, 0xD6E8FEB86659FD93ULL
+};
+
+/*
+ * Mixes a key with a row seed (splitmix64 finalizer)
+ */
+static inline uint32_t rowIndex(const FrequencySketch *sketch, uint64_t key, int row)
+{
+    uint64_t h = key + rowSeeds[row];
+    h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+    h ^= h >> 31;
+    return (uint32_t)row * (sketch->widthMask + 1) + ((uint32_t)h & sketch->widthMask);
+}
+
+/*
+ * Sizes the sketch for a cache: one row is the next power of two of at
+ * least four counters per cached entry
+ * @param sketch - Sketch to initialize
+ * @param cacheSize - Number of entries of the cache it guards
+ * @return 0 on success, -1 if out of memory
+ */
+extern int initFrequencySketch(FrequencySketch *sketch, int cacheSize)
+{
+    uint32_t width = 16;
+    while (width < (uint32_t)cacheSize * 4 && width < (1u << 30)) {
+        width <<= 1;
+    }
+
+    sketch->counters = (uint8_t*)calloc((size_t)width * SKETCH_DEPTH, sizeof(uint8_t));
+    if (sketch->counters == NULL) {
+        return -1;
+    }
+    sketch->widthMask = width - 1;
+    sketch->additions = 0;
+    sketch->sampleSize = (cacheSize > 0 ? cacheSize : 1) * SKETCH_SAMPLE_FACTOR;
+    sketch->numResets = 0;
+    return 0;
+}
+
+/*
+ * Frees the counters of a sketch
+ */
+extern void freeFrequencySketch(FrequencySketch *sketch)
+{
+    free(sketch->counters);
+    sketch->counters = NULL;
+}
+
+/*
+ * Halves every counter, so the sketch follows changes in popularity
+ */
+static void halveCounters(FrequencySketch *sketch)
+{
+    size_t n = (size_t)(sketch->widthMask + 1) * SKETCH_DEPTH;
+    for (size_t i = 0; i < n; i++) {
+        sketch->counters[i] >>= 1;
+    }
+    sketch->additions /= 2;
+    sketch->numResets++;
+}
+
+/*
+ * Records one access to a key
+ * @param sketch - Sketch to update
+ * @param key - Accessed key
+ */
+extern void incrementFrequency(FrequencySketch *sketch, uint64_t key)
+{
+    int added = 0;
+    for (int row = 0; row < SKETCH_DEPTH; row++) {
+        uint8_t *counter = &sketch->counters[rowIndex(sketch, key, row)];
+        if (*counter < SKETCH_MAX_COUNT) {
+            (*counter)++;
+            added = 1;
+        }
+    }
+
+    if (added && ++sketch->additions >= sketch->sampleSize) {
+        halveCounters(sketch);
+    }
+}
+
+/*
+ * Estimates the number of recent accesses to a key
+ * @param sketch - Sketch to query
+ * @param key - Key to look up
+ * @return Smallest counter of the key over all rows
+ */
+extern int estimateFrequency(const FrequencySketch *sketch, uint64_t key)
+{
+    int estimate = SKETCH_MAX_COUNT;
+    for (int row = 0; row < SKETCH_DEPTH; row++) {
+        int count = sketch->counters[rowIndex(sketch, key, row)];
+        if (count < estimate) {
+            estimate = count;
+        }
+    }
+    return estimate;
+}
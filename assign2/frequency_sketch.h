@@ -0,0 +1,28 @@
+#ifndef FREQUENCY_SKETCH_H
+#define FREQUENCY_SKETCH_H
+
+// Count-Min sketch of recent access frequencies, as used by TinyLFU:
+// 4-bit saturating counters in four rows, all halved once the number of
+// recorded accesses reaches the sample size so old popularity fades.
+
+#include <stdint.h>
+
+typedef struct FrequencySketch {
+	uint8_t *counters;   // SKETCH_DEPTH rows of (widthMask + 1) counters
+	uint32_t widthMask;
+	int additions;       // Accesses since the last halving
+	int sampleSize;
+	int numResets;
+} FrequencySketch;
+
+// Sizes the sketch for a cache of the given number of entries
+int initFrequencySketch (FrequencySketch *sketch, int cacheSize);
+void freeFrequencySketch (FrequencySketch *sketch);
+
+// Records one access to key
+void incrementFrequency (FrequencySketch *sketch, uint64_t key);
+
+// Estimated number of recent accesses to key (never underestimated)
+int estimateFrequency (const FrequencySketch *sketch, uint64_t key);
+
+#endif
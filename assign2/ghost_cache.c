@@ -0,0 +1,103 @@
+#include <stdlib.h>
+#include "ghost_cache.h"
+#include "frame_scan.h"
+
+/*
+ * Creates an empty shadow cache
+ * @param cache - Cache to initialize
+ * @param strategy - Strategy to simulate: RS_FIFO, RS_LRU or RS_CLOCK
+ * @param capacity - Number of keys the cache holds
+ * @return 0 on success, -1 if out of memory or the strategy is not supported
+ */
+extern int initGhostCache(GhostCache *cache, ReplacementStrategy strategy, int capacity)
+{
+    if ((strategy != RS_FIFO && strategy != RS_LRU && strategy != RS_CLOCK) || capacity <= 0) {
+        return -1;
+    }
+
+    cache->keys = (PageNumber*)malloc(sizeof(PageNumber) * capacity);
+    cache->stamps = (int*)calloc(capacity, sizeof(int));
+    cache->refBits = (uint8_t*)calloc(capacity, sizeof(uint8_t));
+    if (cache->keys == NULL || cache->stamps == NULL || cache->refBits == NULL) {
+        freeGhostCache(cache);
+        return -1;
+    }
+
+    for (int i = 0; i < capacity; i++) {
+        cache->keys[i] = NO_PAGE;
+    }
+    cache->strategy = strategy;
+    cache->capacity = capacity;
+    cache->hand = 0;
+    cache->clock = 0;
+    return 0;
+}
+
+/*
+ * Frees the arrays of a shadow cache
+ */
+extern void freeGhostCache(GhostCache *cache)
+{
+    free(cache->keys);
+    free(cache->stamps);
+    free(cache->refBits);
+    cache->keys = NULL;
+    cache->stamps = NULL;
+    cache->refBits = NULL;
+}
+
+/*
+ * Picks the slot a missed key replaces, following the simulated strategy
+ */
+static int ghostVictim(GhostCache *cache)
+{
+    int victim = 0;
+
+    switch (cache->strategy) {
+        case RS_LRU:
+            for (int i = 1; i < cache->capacity; i++) {
+                if (cache->stamps[i] < cache->stamps[victim]) {
+                    victim = i;
+                }
+            }
+            return victim;
+        case RS_CLOCK:
+            while (cache->refBits[cache->hand]) {
+                cache->refBits[cache->hand] = 0;
+                cache->hand = (cache->hand + 1) % cache->capacity;
+            }
+            /* fall through */
+        default:
+            victim = cache->hand;
+            cache->hand = (cache->hand + 1) % cache->capacity;
+            return victim;
+    }
+}
+
+/*
+ * Simulates one access
+ * @param cache - Shadow cache
+ * @param key - Accessed key, never NO_PAGE
+ * @return true if the key was cached
+ */
+extern bool accessGhostCache(GhostCache *cache, PageNumber key)
+{
+    cache->clock++;
+
+    int idx = scanFindPage(cache->keys, 0, cache->capacity, key);
+    if (idx != -1) {
+        cache->stamps[idx] = cache->clock;
+        cache->refBits[idx] = 1;
+        return true;
+    }
+
+    /* Fill empty slots first, like the buffer pool */
+    idx = scanFindPage(cache->keys, 0, cache->capacity, NO_PAGE);
+    if (idx == -1) {
+        idx = ghostVictim(cache);
+    }
+    cache->keys[idx] = key;
+    cache->stamps[idx] = cache->clock;
+    cache->refBits[idx] = 0;
+    return false;
+}
@@ -0,0 +1,29 @@
+#ifndef GHOST_CACHE_H
+#define GHOST_CACHE_H
+
+// Shadow cache that simulates a replacement strategy on page keys only, with
+// no page data. Adaptive pools feed one per candidate strategy with a hashed
+// sample of their accesses to compare hit ratios.
+
+#include <stdint.h>
+#include "buffer_mgr.h"
+
+typedef struct GhostCache {
+	ReplacementStrategy strategy;  // RS_FIFO, RS_LRU or RS_CLOCK
+	PageNumber *keys;    // Cached keys, NO_PAGE for empty slots
+	int *stamps;         // Last access of each slot (LRU)
+	uint8_t *refBits;    // Reference bit of each slot (CLOCK)
+	int capacity;
+	int hand;            // Next slot to replace (FIFO) or test (CLOCK)
+	int clock;           // Accesses so far, used as LRU stamp
+} GhostCache;
+
+// Creates an empty shadow cache; returns 0 on success, -1 if out of memory
+// or the strategy cannot be simulated
+int initGhostCache (GhostCache *cache, ReplacementStrategy strategy, int capacity);
+void freeGhostCache (GhostCache *cache);
+
+// Simulates an access to key (>= 0); returns true on a hit
+bool accessGhostCache (GhostCache *cache, PageNumber key);
+
+#endif
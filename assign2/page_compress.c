@@ -0,0 +1,246 @@
+#include <stdint.h>
+#include <string.h>
+#include "page_compress.h"
+
+/* Shortest match worth a sequence; matches are found by 4-byte hashes */
+#define MIN_MATCH 4
+
+/* Positions remembered by the match finder, indexed by sequence hash */
+#define HASH_BITS 12
+
+/* Largest length stored in a token nibble; longer ones continue in bytes */
+#define LENGTH_MASK 15
+
+/* Reads 4 bytes without alignment requirements */
+static inline uint32_t read32(const char *p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+/* Reads 8 bytes without alignment requirements */
+static inline uint64_t read64(const char *p) {
+    uint64_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+/*
+ * Length of the common prefix of two positions, compared 8 bytes at a time
+ * @param limit - Largest length to return
+ */
+static inline int commonPrefix(const char *a, const char *b, int limit)
+{
+    int length = 0;
+    while (length + 8 <= limit) {
+        uint64_t diff = read64(a + length) ^ read64(b + length);
+        if (diff != 0) {
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+            /* The first differing byte holds the lowest set bit */
+            return length + __builtin_ctzll(diff) / 8;
+#else
+            break;
+#endif
+        }
+        length += 8;
+    }
+    while (length < limit && a[length] == b[length]) {
+        length++;
+    }
+    return length;
+}
+
+/* Multiplicative hash of a 4-byte sequence */
+static inline uint32_t hashSequence(uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - HASH_BITS);
+}
+
+/*
+ * Appends the part of a length above the token nibble: 255 for every full
+ * 255, then the remainder
+ * @return The new output position, -1 if dst is full
+ */
+static int putLength(char *dst, int op, int capacity, int length)
+{
+    for (; length >= 255; length -= 255) {
+        if (op >= capacity) {
+            return -1;
+        }
+        dst[op++] = (char)255;
+    }
+    if (op >= capacity) {
+        return -1;
+    }
+    dst[op++] = (char)length;
+    return op;
+}
+
+/*
+ * Reads the continuation bytes of a length, adding them to *length
+ * @return The new input position, -1 if src ends first
+ */
+static int getLength(const unsigned char *src, int ip, int srcSize, int *length)
+{
+    for (;;) {
+        if (ip >= srcSize) {
+            return -1;
+        }
+        int byte = src[ip++];
+        *length += byte;
+        if (byte != 255) {
+            return ip;
+        }
+    }
+}
+
+/*
+ * Appends one sequence: literals followed by a match
+ * @param matchLength - Match length, 0 for the final sequence, which has literals only
+ * @return The new output position, -1 if dst is full
+ */
+static int putSequence(char *dst, int op, int capacity, const char *literals,
+                       int numLiterals, int offset, int matchLength)
+{
+    int literalCode = (numLiterals < LENGTH_MASK) ? numLiterals : LENGTH_MASK;
+    int matchCode = 0;
+    if (matchLength > 0) {
+        matchCode = (matchLength - MIN_MATCH < LENGTH_MASK) ? matchLength - MIN_MATCH : LENGTH_MASK;
+    }
+
+    if (op >= capacity) {
+        return -1;
+    }
+    dst[op++] = (char)((literalCode << 4) | matchCode);
+    if (literalCode == LENGTH_MASK &&
+        (op = putLength(dst, op, capacity, numLiterals - LENGTH_MASK)) < 0) {
+        return -1;
+    }
+    if (numLiterals > capacity - op) {
+        return -1;
+    }
+    memcpy(dst + op, literals, numLiterals);
+    op += numLiterals;
+
+    if (matchLength == 0) {
+        return op;
+    }
+    if (capacity - op < 2) {
+        return -1;
+    }
+    dst[op++] = (char)(offset & 0xFF);
+    dst[op++] = (char)(offset >> 8);
+    if (matchCode == LENGTH_MASK &&
+        (op = putLength(dst, op, capacity, matchLength - MIN_MATCH - LENGTH_MASK)) < 0) {
+        return -1;
+    }
+    return op;
+}
+
+/*
+ * Compresses a page image
+ * Greedy parsing: each position is looked up in a table of the last
+ * position with the same 4-byte hash and the match is extended as far as
+ * it goes
+ * @param src - Bytes to compress
+ * @param size - Number of bytes, at most COMPRESS_MAX_INPUT
+ * @param dst - Output buffer
+ * @param capacity - Size of dst
+ * @return The compressed size, 0 if it exceeds capacity
+ */
+extern int compressPage(const char *src, int size, char *dst, int capacity)
+{
+    if (size < 0 || size > COMPRESS_MAX_INPUT) {
+        return 0;
+    }
+
+    /* Positions are stored plus one so that 0 means none */
+    uint16_t table[1 << HASH_BITS];
+    memset(table, 0, sizeof(table));
+
+    int ip = 0;
+    int anchor = 0;
+    int op = 0;
+    while (ip + MIN_MATCH <= size) {
+        uint32_t sequence = read32(src + ip);
+        uint32_t h = hashSequence(sequence);
+        int ref = table[h] - 1;
+        table[h] = (uint16_t)(ip + 1);
+        if (ref < 0 || read32(src + ref) != sequence) {
+            ip++;
+            continue;
+        }
+
+        int length = MIN_MATCH + commonPrefix(src + ref + MIN_MATCH, src + ip + MIN_MATCH,
+                                              size - ip - MIN_MATCH);
+        op = putSequence(dst, op, capacity, src + anchor, ip - anchor, ip - ref, length);
+        if (op < 0) {
+            return 0;
+        }
+        ip += length;
+        anchor = ip;
+    }
+
+    op = putSequence(dst, op, capacity, src + anchor, size - anchor, 0, 0);
+    return (op < 0) ? 0 : op;
+}
+
+/*
+ * Decompresses a page image produced by compressPage
+ * @param src - Compressed bytes
+ * @param srcSize - Number of compressed bytes
+ * @param dst - Output buffer of size bytes
+ * @param size - Size of the original page image
+ * @return 0 on success, -1 if src is corrupt or does not expand to size bytes
+ */
+extern int decompressPage(const char *src, int srcSize, char *dst, int size)
+{
+    const unsigned char *in = (const unsigned char*)src;
+    int ip = 0;
+    int op = 0;
+    while (ip < srcSize) {
+        int token = in[ip++];
+
+        int numLiterals = token >> 4;
+        if (numLiterals == LENGTH_MASK && (ip = getLength(in, ip, srcSize, &numLiterals)) < 0) {
+            return -1;
+        }
+        if (numLiterals > srcSize - ip || numLiterals > size - op) {
+            return -1;
+        }
+        memcpy(dst + op, src + ip, numLiterals);
+        ip += numLiterals;
+        op += numLiterals;
+
+        /* The final sequence ends after its literals */
+        if (ip == srcSize) {
+            break;
+        }
+
+        if (srcSize - ip < 2) {
+            return -1;
+        }
+        int offset = in[ip] | (in[ip + 1] << 8);
+        ip += 2;
+        int matchLength = (token & LENGTH_MASK) + MIN_MATCH;
+        if ((token & LENGTH_MASK) == LENGTH_MASK &&
+            (ip = getLength(in, ip, srcSize, &matchLength)) < 0) {
+            return -1;
+        }
+        if (offset == 0 || offset > op || matchLength > size - op) {
+            return -1;
+        }
+
+        /* An overlapping match repeats the last offset bytes; every copy
+         * doubles the distance that can be copied at once */
+        int distance = offset;
+        while (matchLength > 0) {
+            int chunk = (matchLength < distance) ? matchLength : distance;
+            memcpy(dst + op, dst + op - distance, chunk);
+            op += chunk;
+            matchLength -= chunk;
+            distance += chunk;
+        }
+    }
+
+    return (op == size) ? 0 : -1;
+}
@@ -0,0 +1,21 @@
+#ifndef PAGE_COMPRESS_H
+#define PAGE_COMPRESS_H
+
+// Byte-oriented LZ77 compression of page images, in the spirit of LZ4:
+// a stream of sequences, each a token byte with the literal and match
+// lengths, the literals, and a 16-bit backward offset of the match. Fast
+// enough to run on every eviction; pages of zeros or repeated records
+// shrink to a few dozen bytes.
+
+// Inputs are limited to 65535 bytes so every offset fits 16 bits
+#define COMPRESS_MAX_INPUT 65535
+
+// Compresses size bytes of src into dst; returns the compressed size, or 0
+// if the result would not fit in capacity bytes
+int compressPage (const char *src, int size, char *dst, int capacity);
+
+// Restores exactly size bytes into dst; returns 0 on success, -1 if src is
+// not a valid compressed image of that size
+int decompressPage (const char *src, int srcSize, char *dst, int size);
+
+#endif
@@ -0,0 +1,136 @@
+#ifndef PAGE_GUARD_HPP
+#define PAGE_GUARD_HPP
+
+// RAII pins for C++ callers of the C buffer pool. A PageGuard owns one pin
+// and unpins it when destroyed, so early returns cannot leak pins; guards
+// are move-only. A WritePageGuard also marks the page dirty when it is
+// pinned. PageView<T> reads a page's data as an array of T.
+
+extern "C" {
+#include "dberror.h"
+#include "buffer_mgr.h"
+}
+
+#include <cstddef>
+#include <type_traits>
+
+namespace bm {
+
+// Typed view of a page: PAGE_SIZE / sizeof(T) elements of T
+template <class T>
+class PageView {
+	static_assert(std::is_trivially_copyable<T>::value, "pages hold raw bytes");
+	static_assert(sizeof(T) <= PAGE_SIZE, "an element must fit in a page");
+
+public:
+	static constexpr std::size_t capacity = PAGE_SIZE / sizeof(T);
+
+	explicit PageView(T *data) : items(data) {}
+
+	T &operator[](std::size_t i) const { return items[i]; }
+	T &operator*() const { return *items; }
+	T *operator->() const { return items; }
+	T *begin() const { return items; }
+	T *end() const { return items + capacity; }
+	static constexpr std::size_t size() { return capacity; }
+
+private:
+	T *items;
+};
+
+// Read pin of a page
+class PageGuard {
+public:
+	PageGuard() = default;
+	PageGuard(const PageGuard &) = delete;
+	PageGuard &operator=(const PageGuard &) = delete;
+
+	PageGuard(PageGuard &&other) noexcept : pool(other.pool), handle(other.handle)
+	{
+		other.pool = nullptr;
+	}
+
+	PageGuard &operator=(PageGuard &&other) noexcept
+	{
+		if (this != &other) {
+			release();
+			pool = other.pool;
+			handle = other.handle;
+			other.pool = nullptr;
+		}
+		return *this;
+	}
+
+	~PageGuard() { release(); }
+
+	// Pins a page of the pool's own file, releasing the page held before
+	RC pin(BM_BufferPool *bm, PageNumber pageNum)
+	{
+		return pin(bm, DEFAULT_FILE_ID, pageNum);
+	}
+
+	// Pins a page of a registered file, releasing the page held before
+	RC pin(BM_BufferPool *bm, FileId fileId, PageNumber pageNum)
+	{
+		release();
+		RC result = pinFilePage(bm, &handle, fileId, pageNum);
+		if (result == RC_OK) {
+			pool = bm;
+		}
+		return result;
+	}
+
+	// Unpins the page now; a no-op for an empty guard
+	RC release()
+	{
+		if (pool == nullptr) {
+			return RC_OK;
+		}
+		BM_BufferPool *bm = pool;
+		pool = nullptr;
+		return unpinPage(bm, &handle);
+	}
+
+	bool pinned() const { return pool != nullptr; }
+	explicit operator bool() const { return pinned(); }
+	PageNumber pageNum() const { return handle.pageNum; }
+	FileId fileId() const { return handle.fileId; }
+	const char *data() const { return handle.data; }
+
+	template <class T>
+	PageView<const T> view() const { return PageView<const T>(reinterpret_cast<const T *>(handle.data)); }
+
+protected:
+	BM_BufferPool *pool = nullptr;  // nullptr while the guard holds no pin
+	BM_PageHandle handle = {};
+};
+
+// Write pin of a page: the page is marked dirty when pinned
+class WritePageGuard : public PageGuard {
+public:
+	RC pin(BM_BufferPool *bm, PageNumber pageNum)
+	{
+		return pin(bm, DEFAULT_FILE_ID, pageNum);
+	}
+
+	RC pin(BM_BufferPool *bm, FileId fileId, PageNumber pageNum)
+	{
+		RC result = PageGuard::pin(bm, fileId, pageNum);
+		if (result == RC_OK) {
+			result = markDirty(bm, &handle);
+			if (result != RC_OK) {
+				release();
+			}
+		}
+		return result;
+	}
+
+	char *data() const { return handle.data; }
+
+	template <class T>
+	PageView<T> view() const { return PageView<T>(reinterpret_cast<T *>(handle.data)); }
+};
+
+} // namespace bm
+
+#endif
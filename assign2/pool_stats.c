@@ -0,0 +1,192 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <stddef.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "pool_stats.h"
+
+/* Loads a field the owning pool may be updating */
+static inline uint64_t statLoad(const uint64_t *field) {
+#if defined(__GNUC__)
+    return __atomic_load_n(field, __ATOMIC_RELAXED);
+#else
+    return *(const volatile uint64_t *)field;
+#endif
+}
+
+/*
+ * Creates the statistics segment of a pool
+ * A segment left behind by a process that crashed is replaced. The header
+ * is complete before the magic number appears, so readers either reject
+ * the segment or see all of it
+ * @param name - POSIX shared memory name ("/name")
+ * @param pageFile - Page file of the pool, shown by monitors
+ * @return The segment mapped read-write, NULL on failure
+ */
+extern PoolStats *createPoolStats(const char *name, const char *pageFile, int numFrames,
+                                  int strategy)
+{
+    if (strlen(name) >= POOL_STATS_NAME_MAX) {
+        return NULL;
+    }
+    shm_unlink(name);
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        return NULL;
+    }
+    if (ftruncate(fd, sizeof(PoolStats)) != 0) {
+        close(fd);
+        shm_unlink(name);
+        return NULL;
+    }
+    void *addr = mmap(NULL, sizeof(PoolStats), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        shm_unlink(name);
+        return NULL;
+    }
+
+    PoolStats *stats = (PoolStats*)addr;
+    memset(stats, 0, sizeof(PoolStats));
+    stats->version = POOL_STATS_VERSION;
+    stats->pid = (int64_t)getpid();
+    stats->numFrames = numFrames;
+    stats->strategy = strategy;
+    strncpy(stats->name, name, POOL_STATS_NAME_MAX - 1);
+    strncpy(stats->pageFile, pageFile, POOL_STATS_NAME_MAX - 1);
+#if defined(__GNUC__)
+    __atomic_store_n(&stats->magic, POOL_STATS_MAGIC, __ATOMIC_RELEASE);
+#else
+    stats->magic = POOL_STATS_MAGIC;
+#endif
+    return stats;
+}
+
+/*
+ * Marks a pool's segment closed, so monitors that still map it can tell,
+ * then removes its name and unmaps it
+ */
+extern void destroyPoolStats(PoolStats *stats)
+{
+    statSet((uint64_t*)&stats->closed, 1);
+    shm_unlink(stats->name);
+    munmap(stats, sizeof(PoolStats));
+}
+
+/*
+ * Maps the statistics segment of a running pool read-only
+ * @return The segment, NULL if it does not exist or is not a statistics
+ *         segment of this version
+ */
+extern const PoolStats *openPoolStats(const char *name)
+{
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) {
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(PoolStats)) {
+        close(fd);
+        return NULL;
+    }
+    void *addr = mmap(NULL, sizeof(PoolStats), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        return NULL;
+    }
+
+    const PoolStats *stats = (const PoolStats*)addr;
+#if defined(__GNUC__)
+    uint64_t magic = __atomic_load_n(&stats->magic, __ATOMIC_ACQUIRE);
+#else
+    uint64_t magic = stats->magic;
+#endif
+    if (magic != POOL_STATS_MAGIC || stats->version != POOL_STATS_VERSION) {
+        munmap(addr, sizeof(PoolStats));
+        return NULL;
+    }
+    return stats;
+}
+
+/*
+ * Unmaps a segment mapped by openPoolStats
+ */
+extern void closePoolStats(const PoolStats *stats)
+{
+    munmap((void*)stats, sizeof(PoolStats));
+}
+
+/*
+ * Copies a segment field by field; of the header fields only closed
+ * changes after creation
+ */
+extern void snapshotPoolStats(const PoolStats *stats, PoolStats *copy)
+{
+    memcpy(copy, stats, offsetof(PoolStats, hits));
+    copy->closed = (int64_t)statLoad((const uint64_t*)&stats->closed);
+
+    const uint64_t *src = &stats->hits;
+    uint64_t *dst = &copy->hits;
+    size_t numCounters = (sizeof(PoolStats) - offsetof(PoolStats, hits)) / sizeof(uint64_t);
+    for (size_t i = 0; i < numCounters; i++) {
+        dst[i] = statLoad(&src[i]);
+    }
+}
+
+/*
+ * Monotonic clock in nanoseconds
+ */
+extern uint64_t poolStatsClock(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/*
+ * Counts one I/O in the bucket of its duration
+ * @param histogram - LATENCY_BUCKETS counters of the segment
+ */
+extern void recordLatency(uint64_t *histogram, uint64_t ns)
+{
+    uint64_t us = ns / 1000;
+    int bucket = 0;
+    while (bucket < LATENCY_BUCKETS - 1 && us >= (1ULL << bucket)) {
+        bucket++;
+    }
+    statAdd(&histogram[bucket], 1);
+}
+
+/*
+ * Latency below which the given fraction of the I/Os of a histogram fall,
+ * rounded up to the bucket bound
+ * @param fraction - 0.5 for the median, 0.99 for the 99th percentile
+ * @return Microseconds, 0 if the histogram is empty
+ */
+extern uint64_t latencyPercentile(const uint64_t *histogram, double fraction)
+{
+    uint64_t total = 0;
+    for (int i = 0; i < LATENCY_BUCKETS; i++) {
+        total += histogram[i];
+    }
+    if (total == 0) {
+        return 0;
+    }
+
+    uint64_t target = (uint64_t)(fraction * (double)total + 0.5);
+    if (target < 1) {
+        target = 1;
+    }
+    uint64_t seen = 0;
+    for (int i = 0; i < LATENCY_BUCKETS - 1; i++) {
+        seen += histogram[i];
+        if (seen >= target) {
+            return 1ULL << i;
+        }
+    }
+    return 1ULL << (LATENCY_BUCKETS - 1);
+}
@@ -0,0 +1,87 @@
+#ifndef POOL_STATS_H
+#define POOL_STATS_H
+
+// Statistics segment of a buffer pool: a POSIX shared memory object that
+// the pool updates on pins and I/O and that monitors such as bmtop map
+// read-only. The pool is its only writer and every field is a 64-bit word
+// stored atomically, so readers take no lock and never see a torn value;
+// two fields read one after the other may be one update apart.
+
+#include <stdint.h>
+
+#define POOL_STATS_MAGIC 0x5354415453504D42ULL
+#define POOL_STATS_VERSION 1
+#define POOL_STATS_NAME_MAX 256
+
+// Bucket 0 counts I/Os under 1 us, bucket i those in [2^(i-1), 2^i) us,
+// the last bucket everything slower
+#define LATENCY_BUCKETS 32
+
+typedef struct PoolStats {
+	uint64_t magic;
+	uint64_t version;
+	int64_t pid;         // Process that owns the pool
+	int64_t numFrames;
+	int64_t strategy;    // ReplacementStrategy of the pool
+	int64_t closed;      // Set when the pool shuts down
+	char name[POOL_STATS_NAME_MAX];  // Shared memory name of the segment
+	char pageFile[POOL_STATS_NAME_MAX];
+	uint64_t hits;       // Pins served from a frame
+	uint64_t misses;     // Pins that loaded their page
+	uint64_t evictions;  // Pages a miss replaced
+	uint64_t reads;      // Pages read from page files
+	uint64_t writes;     // Pages written to page files
+	uint64_t dirtyFrames;   // Gauges, refreshed every POOL_STATS_GAUGE_PINS
+	uint64_t pinnedFrames;  // pins and after flushes
+	uint64_t readLatency[LATENCY_BUCKETS];
+	uint64_t writeLatency[LATENCY_BUCKETS];
+} PoolStats;
+
+// Pins between two refreshes of the dirty and pinned frame gauges
+#define POOL_STATS_GAUGE_PINS 256
+
+// Creates (or replaces) the segment of a pool; returns NULL if it cannot
+// be created
+PoolStats *createPoolStats (const char *name, const char *pageFile, int numFrames,
+		int strategy);
+
+// Marks the segment closed, removes its name and unmaps it
+void destroyPoolStats (PoolStats *stats);
+
+// Maps the segment of a running pool read-only; returns NULL if there is
+// none or the object is not a statistics segment of this version
+const PoolStats *openPoolStats (const char *name);
+
+void closePoolStats (const PoolStats *stats);
+
+// Copies every field of a segment with atomic loads
+void snapshotPoolStats (const PoolStats *stats, PoolStats *copy);
+
+// Monotonic clock in nanoseconds, for timing I/O
+uint64_t poolStatsClock (void);
+
+// Counts one I/O of the given duration in a latency histogram
+void recordLatency (uint64_t *histogram, uint64_t ns);
+
+// Upper bound in microseconds of the bucket holding the given fraction of
+// the I/Os in a histogram; 0 if it is empty
+uint64_t latencyPercentile (const uint64_t *histogram, double fraction);
+
+// Adds to a counter of the segment; only the owning pool calls this
+static inline void statAdd(uint64_t *counter, uint64_t n) {
+#if defined(__GNUC__)
+	__atomic_store_n(counter, __atomic_load_n(counter, __ATOMIC_RELAXED) + n, __ATOMIC_RELAXED);
+#else
+	*(volatile uint64_t *)counter += n;
+#endif
+}
+
+static inline void statSet(uint64_t *counter, uint64_t value) {
+#if defined(__GNUC__)
+	__atomic_store_n(counter, value, __ATOMIC_RELAXED);
+#else
+	*(volatile uint64_t *)counter = value;
+#endif
+}
+
+#endif
@@ -0,0 +1,107 @@
+#include <stdint.h>
+#include "replacement_policy.h"
+
+/*
+ * FIFO: a hand moves over the frames in load order and replaces the first
+ * unpinned frame it reaches
+ */
+typedef struct FifoState {
+    int hand;
+} FifoState;
+
+static int fifoPickVictim(BM_PolicyView *view)
+{
+    FifoState *state = (FifoState*)view->poolState;
+
+    for (int scanned = 0; scanned < view->numFrames; scanned++) {
+        int idx = (state->hand + scanned) % view->numFrames;
+        if (view->fixCounts[idx] == 0) {
+            state->hand = (idx + 1) % view->numFrames;
+            return idx;
+        }
+    }
+    return -1;
+}
+
+const BM_ReplacementPolicy fifoPolicy = {
+    "FIFO", 0, sizeof(FifoState), NULL,
+    NULL, NULL, NULL, fifoPickVictim, NULL
+};
+
+/*
+ * LRU: every pin stamps its frame with a counter; the unpinned frame with
+ * the oldest stamp is replaced
+ */
+typedef struct LruState {
+    uint64_t clock;
+} LruState;
+
+static void lruTouch(BM_PolicyView *view, int idx)
+{
+    LruState *state = (LruState*)view->poolState;
+    *(uint64_t*)POLICY_FRAME_STATE(view, idx) = ++state->clock;
+}
+
+static int lruPickVictim(BM_PolicyView *view)
+{
+    int victim = -1;
+    uint64_t oldest = UINT64_MAX;
+
+    for (int idx = 0; idx < view->numFrames; idx++) {
+        uint64_t stamp = *(uint64_t*)POLICY_FRAME_STATE(view, idx);
+        if (view->fixCounts[idx] == 0 && (victim == -1 || stamp < oldest)) {
+            victim = idx;
+            oldest = stamp;
+        }
+    }
+    return victim;
+}
+
+const BM_ReplacementPolicy lruPolicy = {
+    "LRU", sizeof(uint64_t), sizeof(LruState), NULL,
+    lruTouch, lruTouch, NULL, lruPickVictim, NULL
+};
+
+/*
+ * CLOCK: hits set a reference bit; the hand clears the bits of the unpinned
+ * frames it passes and replaces the first one found without
+ */
+typedef struct ClockState {
+    int hand;
+} ClockState;
+
+static void clockHit(BM_PolicyView *view, int idx)
+{
+    *(uint8_t*)POLICY_FRAME_STATE(view, idx) = 1;
+}
+
+static void clockInsert(BM_PolicyView *view, int idx)
+{
+    *(uint8_t*)POLICY_FRAME_STATE(view, idx) = 0;
+}
+
+static int clockPickVictim(BM_PolicyView *view)
+{
+    ClockState *state = (ClockState*)view->poolState;
+
+    /* Two sweeps clear every reference bit */
+    for (int scanned = 0; scanned < view->numFrames * 2; scanned++) {
+        int idx = state->hand;
+        uint8_t *referenced = (uint8_t*)POLICY_FRAME_STATE(view, idx);
+        state->hand = (idx + 1) % view->numFrames;
+
+        if (view->fixCounts[idx] != 0) {
+            continue;
+        }
+        if (!*referenced) {
+            return idx;
+        }
+        *referenced = 0;
+    }
+    return -1;
+}
+
+const BM_ReplacementPolicy clockPolicy = {
+    "CLOCK", sizeof(uint8_t), sizeof(ClockState), NULL,
+    clockHit, clockInsert, NULL, clockPickVictim, NULL
+};
@@ -0,0 +1,51 @@
+#ifndef REPLACEMENT_POLICY_H
+#define REPLACEMENT_POLICY_H
+
+// Interface for replacement policies defined outside the buffer manager.
+// A pool initialized with RS_CUSTOM and a const BM_ReplacementPolicy * as
+// stratData calls the policy's callbacks wherever a built-in strategy would
+// update its metadata or pick a victim. The pool gives the policy
+// frameStateSize bytes of state per frame and poolStateSize bytes for the
+// whole pool, both zeroed at init; the policy struct itself is copied.
+
+#include "buffer_mgr.h"
+
+// What a policy sees of its pool
+typedef struct BM_PolicyView {
+	int numFrames;
+	const int *fixCounts;           // Frames with a positive fix count must not be victims
+	const PageNumber *pageNumbers;  // NO_PAGE for empty frames
+	const FileId *fileIds;
+	char *frameState;               // frameStateSize bytes per frame
+	size_t frameStateSize;
+	void *poolState;                // poolStateSize bytes
+	void *policyData;               // BM_ReplacementPolicy.policyData
+} BM_PolicyView;
+
+// State of frame idx
+#define POLICY_FRAME_STATE(view, idx)			\
+		((void *) ((view)->frameState + (size_t) (idx) * (view)->frameStateSize))
+
+typedef struct BM_ReplacementPolicy {
+	const char *name;
+	size_t frameStateSize;
+	size_t poolStateSize;
+	void *policyData;               // Passed to the callbacks through the view
+	// Called with the frame of a page that was pinned while cached
+	void (*onHit) (BM_PolicyView *view, int idx);
+	// Called after a page was read into frame idx
+	void (*onInsert) (BM_PolicyView *view, int idx);
+	// Called after one pin of the page in frame idx was released
+	void (*onUnpin) (BM_PolicyView *view, int idx);
+	// Required: returns the unpinned frame to evict, or -1 if there is none
+	int (*pickVictim) (BM_PolicyView *view);
+	// Called before the page in frame idx is dropped
+	void (*onEvict) (BM_PolicyView *view, int idx);
+} BM_ReplacementPolicy;
+
+// Built-in policies making the same choices as RS_FIFO, RS_LRU and RS_CLOCK
+extern const BM_ReplacementPolicy fifoPolicy;
+extern const BM_ReplacementPolicy lruPolicy;
+extern const BM_ReplacementPolicy clockPolicy;
+
+#endif
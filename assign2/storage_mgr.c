@@ -1,8 +1,15 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include "dberror.h"
 #include "stdio.h"
 #include "stdlib.h"
 #include "string.h"
+#include "time.h"
 #include "storage_mgr.h"
+#include "trace_probes.h"
+
+/* Delay added to every read call, see setReadLatency() */
+static long readLatencyMicros = 0;
 
 /*
  * Initializes the storage manager
@@ -14,6 +21,29 @@ extern void initStorageManager(void)
     /* No initialization required for basic implementation */
 }
 
+/*
+ * Makes every read call wait the given time before returning, emulating a
+ * device slower than the page cache; benchmarks use it to show what overlaps
+ * with I/O. Set it before any pool starts reading
+ * @param micros - Delay per readBlock() or readBlocks() call, 0 to disable
+ */
+extern void setReadLatency(long micros)
+{
+    readLatencyMicros = micros > 0 ? micros : 0;
+}
+
+/* Sleeps for the injected read latency */
+static void delayRead(void)
+{
+    if (readLatencyMicros > 0)
+    {
+        struct timespec delay;
+        delay.tv_sec = readLatencyMicros / 1000000;
+        delay.tv_nsec = (readLatencyMicros % 1000000) * 1000;
+        nanosleep(&delay, NULL);
+    }
+}
+
 /*
  * Creates a new page file with the given filename
  * The initial file contains one page filled with zero bytes
@@ -142,6 +172,53 @@ extern RC destroyPageFile(const char *fileName)
     }
 }
 
+/* Body of readBlock, without the probe */
+static RC readBlockFile(int pageNum, SM_FileHandle *fHandle, SM_PageHandle memPage)
+{
+    if (fHandle == NULL)
+    {
+        return RC_FILE_HANDLE_NOT_INIT;
+    }
+
+    if (memPage == NULL)
+    {
+        return RC_WRITE_FAILED;
+    }
+
+    if (pageNum < 0 || pageNum >= fHandle->totalNumPages)
+    {
+        return RC_READ_NON_EXISTING_PAGE;
+    }
+
+    FILE *filePtr = fopen(fHandle->fileName, "r");
+    if (filePtr == NULL)
+    {
+        return RC_FILE_NOT_FOUND;
+    }
+
+    /* Seek to the requested page */
+    if (fseek(filePtr, PAGE_SIZE * pageNum, SEEK_SET) != 0)
+    {
+        fclose(filePtr);
+        return RC_READ_NON_EXISTING_PAGE;
+    }
+
+    /* Read the page into memory */
+    size_t bytesRead = fread(memPage, sizeof(char), PAGE_SIZE, filePtr);
+
+    /* Update current page position */
+    fHandle->curPagePos = pageNum;
+
+    fclose(filePtr);
+
+    if (bytesRead < PAGE_SIZE)
+    {
+        return RC_READ_NON_EXISTING_PAGE;
+    }
+
+    return RC_OK;
+}
+
 /*
  * Reads a specific block (page) from the file into memory
  * @param pageNum - Page number to read (0-indexed)
@@ -152,18 +229,29 @@ extern RC destroyPageFile(const char *fileName)
  *         RC_FILE_NOT_FOUND if file can't be opened
  */
 extern RC readBlock(int pageNum, SM_FileHandle *fHandle, SM_PageHandle memPage)
+{
+    uint64_t start = TRACE_CLOCK();
+    delayRead();
+    RC result = readBlockFile(pageNum, fHandle, memPage);
+    TRACE_READ_BLOCK(fHandle != NULL ? fHandle->fileName : NULL, pageNum, 1,
+                     TRACE_CLOCK() - start, result);
+    return result;
+}
+
+/* Body of readBlocks, without the probe */
+static RC readBlocksFile(int pageNum, int numPages, SM_FileHandle *fHandle, SM_PageHandle memPages)
 {
     if (fHandle == NULL)
     {
         return RC_FILE_HANDLE_NOT_INIT;
     }
 
-    if (memPage == NULL)
+    if (memPages == NULL)
     {
         return RC_WRITE_FAILED;
     }
 
-    if (pageNum < 0 || pageNum >= fHandle->totalNumPages)
+    if (pageNum < 0 || numPages <= 0 || pageNum + numPages > fHandle->totalNumPages)
     {
         return RC_READ_NON_EXISTING_PAGE;
     }
@@ -174,22 +262,22 @@ extern RC readBlock(int pageNum, SM_FileHandle *fHandle, SM_PageHandle memPage)
         return RC_FILE_NOT_FOUND;
     }
 
-    /* Seek to the requested page */
-    if (fseek(filePtr, PAGE_SIZE * pageNum, SEEK_SET) != 0)
+    /* Seek to the first page of the run */
+    if (fseek(filePtr, (long)PAGE_SIZE * pageNum, SEEK_SET) != 0)
     {
         fclose(filePtr);
         return RC_READ_NON_EXISTING_PAGE;
     }
 
-    /* Read the page into memory */
-    size_t bytesRead = fread(memPage, sizeof(char), PAGE_SIZE, filePtr);
+    /* Read the whole run into memory */
+    size_t bytesRead = fread(memPages, sizeof(char), (size_t)PAGE_SIZE * numPages, filePtr);
 
-    /* Update current page position */
-    fHandle->curPagePos = pageNum;
+    /* Update current page position to the last page read */
+    fHandle->curPagePos = pageNum + numPages - 1;
 
     fclose(filePtr);
 
-    if (bytesRead < PAGE_SIZE)
+    if (bytesRead < (size_t)PAGE_SIZE * numPages)
     {
         return RC_READ_NON_EXISTING_PAGE;
     }
@@ -197,6 +285,26 @@ extern RC readBlock(int pageNum, SM_FileHandle *fHandle, SM_PageHandle memPage)
     return RC_OK;
 }
 
+/*
+ * Reads a run of consecutive blocks from the file with a single read
+ * @param pageNum - First page number to read (0-indexed)
+ * @param numPages - Number of consecutive pages to read
+ * @param fHandle - Pointer to file handle
+ * @param memPages - Buffer to store the pages (must be at least numPages * PAGE_SIZE bytes)
+ * @return RC_OK on success, RC_FILE_HANDLE_NOT_INIT if handle is invalid,
+ *         RC_READ_NON_EXISTING_PAGE if any page of the run doesn't exist,
+ *         RC_FILE_NOT_FOUND if file can't be opened
+ */
+extern RC readBlocks(int pageNum, int numPages, SM_FileHandle *fHandle, SM_PageHandle memPages)
+{
+    uint64_t start = TRACE_CLOCK();
+    delayRead();
+    RC result = readBlocksFile(pageNum, numPages, fHandle, memPages);
+    TRACE_READ_BLOCK(fHandle != NULL ? fHandle->fileName : NULL, pageNum, numPages,
+                     TRACE_CLOCK() - start, result);
+    return result;
+}
+
 /*
  * Returns the current page position in the file
  * @param fHandle - Pointer to file handle
@@ -290,16 +398,8 @@ extern RC readLastBlock(SM_FileHandle *fHandle, SM_PageHandle memPage)
     return readBlock(lastPageNum, fHandle, memPage);
 }
 
-/*
- * Writes a block to a specific page in the file
- * @param pageNum - Page number to write (0-indexed)
- * @param fHandle - Pointer to file handle
- * @param memPage - Buffer containing the data to write (must be PAGE_SIZE bytes)
- * @return RC_OK on success, RC_FILE_NOT_FOUND if file can't be opened,
- *         RC_WRITE_FAILED if write operation fails,
- *         RC_FILE_HANDLE_NOT_INIT if handle is invalid
- */
-extern RC writeBlock(int pageNum, SM_FileHandle *fHandle, SM_PageHandle memPage)
+/* Body of writeBlock, without the probe */
+static RC writeBlockFile(int pageNum, SM_FileHandle *fHandle, SM_PageHandle memPage)
 {
     if (fHandle == NULL)
     {
@@ -363,6 +463,113 @@ extern RC writeBlock(int pageNum, SM_FileHandle *fHandle, SM_PageHandle memPage)
     return RC_OK;
 }
 
+/*
+ * Writes a block to a specific page in the file
+ * @param pageNum - Page number to write (0-indexed)
+ * @param fHandle - Pointer to file handle
+ * @param memPage - Buffer containing the data to write (must be PAGE_SIZE bytes)
+ * @return RC_OK on success, RC_FILE_NOT_FOUND if file can't be opened,
+ *         RC_WRITE_FAILED if write operation fails,
+ *         RC_FILE_HANDLE_NOT_INIT if handle is invalid
+ */
+extern RC writeBlock(int pageNum, SM_FileHandle *fHandle, SM_PageHandle memPage)
+{
+    uint64_t start = TRACE_CLOCK();
+    RC result = writeBlockFile(pageNum, fHandle, memPage);
+    TRACE_WRITE_BLOCK(fHandle != NULL ? fHandle->fileName : NULL, pageNum, PAGE_SIZE,
+                      TRACE_CLOCK() - start, result);
+    return result;
+}
+
+/* Body of writeBlockSectors, without the probe */
+static RC writeSectorsFile(int pageNum, unsigned int sectorMask, SM_FileHandle *fHandle,
+                           SM_PageHandle memPage)
+{
+    if (fHandle == NULL)
+    {
+        return RC_FILE_HANDLE_NOT_INIT;
+    }
+
+    if (memPage == NULL)
+    {
+        return RC_WRITE_FAILED;
+    }
+
+    if (pageNum < 0 || pageNum >= fHandle->totalNumPages)
+    {
+        return RC_WRITE_FAILED;
+    }
+
+    FILE *filePtr = fopen(fHandle->fileName, "r+");
+    if (filePtr == NULL)
+    {
+        return RC_FILE_NOT_FOUND;
+    }
+
+    int sector = 0;
+    while (sector < SECTORS_PER_PAGE)
+    {
+        if (!(sectorMask & (1u << sector)))
+        {
+            sector++;
+            continue;
+        }
+
+        /* Extend the run over the following selected sectors */
+        int end = sector + 1;
+        while (end < SECTORS_PER_PAGE && (sectorMask & (1u << end)))
+        {
+            end++;
+        }
+
+        size_t length = (size_t)(end - sector) * SECTOR_SIZE;
+        if (fseek(filePtr, (long)PAGE_SIZE * pageNum + (long)sector * SECTOR_SIZE, SEEK_SET) != 0 ||
+            fwrite(memPage + sector * SECTOR_SIZE, sizeof(char), length, filePtr) != length)
+        {
+            fclose(filePtr);
+            return RC_WRITE_FAILED;
+        }
+        sector = end;
+    }
+
+    fHandle->curPagePos = pageNum;
+
+    if (fclose(filePtr) != 0)
+    {
+        return RC_WRITE_FAILED;
+    }
+    return RC_OK;
+}
+
+/*
+ * Writes selected sectors of a block, leaving the rest of the page on disk
+ * untouched; each run of consecutive sectors is written with one write
+ * @param pageNum - Page number to write (0-indexed), must already exist
+ * @param sectorMask - Bit i selects bytes [i * SECTOR_SIZE, (i + 1) * SECTOR_SIZE)
+ * @param fHandle - Pointer to file handle
+ * @param memPage - Buffer holding the whole page (PAGE_SIZE bytes)
+ * @return RC_OK on success, RC_FILE_NOT_FOUND if file can't be opened,
+ *         RC_WRITE_FAILED if the page doesn't exist or a write fails,
+ *         RC_FILE_HANDLE_NOT_INIT if handle is invalid
+ */
+extern RC writeBlockSectors(int pageNum, unsigned int sectorMask, SM_FileHandle *fHandle,
+                            SM_PageHandle memPage)
+{
+    uint64_t start = TRACE_CLOCK();
+    RC result = writeSectorsFile(pageNum, sectorMask, fHandle, memPage);
+    int bytes = 0;
+    for (int sector = 0; sector < SECTORS_PER_PAGE; sector++)
+    {
+        if (sectorMask & (1u << sector))
+        {
+            bytes += SECTOR_SIZE;
+        }
+    }
+    TRACE_WRITE_BLOCK(fHandle != NULL ? fHandle->fileName : NULL, pageNum, bytes,
+                      TRACE_CLOCK() - start, result);
+    return result;
+}
+
 /*
  * Writes a block at the current page position
  * @param fHandle - Pointer to file handle
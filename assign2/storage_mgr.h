@@ -15,6 +15,10 @@ typedef struct SM_FileHandle {
 
 typedef char* SM_PageHandle;
 
+/* unit of partial page writes */
+#define SECTOR_SIZE 512
+#define SECTORS_PER_PAGE (PAGE_SIZE / SECTOR_SIZE)
+
 /************************************************************
  *                    interface                             *
  ************************************************************/
@@ -27,6 +31,8 @@ extern RC destroyPageFile (const char *fileName);
 
 /* reading blocks from disc */
 extern RC readBlock (int pageNum, SM_FileHandle *fHandle, SM_PageHandle memPage);
+extern RC readBlocks (int pageNum, int numPages, SM_FileHandle *fHandle, SM_PageHandle memPages);
+extern void setReadLatency (long micros);
 extern int getBlockPos (SM_FileHandle *fHandle);
 extern RC readFirstBlock (SM_FileHandle *fHandle, SM_PageHandle memPage);
 extern RC readPreviousBlock (SM_FileHandle *fHandle, SM_PageHandle memPage);
@@ -36,6 +42,8 @@ extern RC readLastBlock (SM_FileHandle *fHandle, SM_PageHandle memPage);
 
 /* writing blocks to a page file */
 extern RC writeBlock (int pageNum, SM_FileHandle *fHandle, SM_PageHandle memPage);
+extern RC writeBlockSectors (int pageNum, unsigned int sectorMask, SM_FileHandle *fHandle,
+		SM_PageHandle memPage);
 extern RC writeCurrentBlock (SM_FileHandle *fHandle, SM_PageHandle memPage);
 extern RC appendEmptyBlock (SM_FileHandle *fHandle);
 extern RC ensureCapacity (int numberOfPages, SM_FileHandle *fHandle);
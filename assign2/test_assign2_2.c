@@ -36,6 +36,8 @@ static void checkDummyPages(BM_BufferPool *bm, int num);
 static void testReadPage (void);
 
 static void testClock (void);
+static void testGClock (void);
+static void testClockPro (void);
 
 // main method
 int 
@@ -47,6 +49,8 @@ main (void)
   testCreatingAndReadingDummyPages();
   testReadPage();
   testClock();
+  testGClock();
+  testClockPro();
   return 0;
 }
 
@@ -203,3 +207,128 @@ testClock(void)
     TEST_DONE();
 }
 
+
+void
+testGClock(void)
+{
+    // expected results
+    const char *poolContents[]= {
+    "[1 0],[-1 0],[-1 0]",
+    "[1 0],[-1 0],[-1 0]",
+    "[1 0],[-1 0],[-1 0]",
+    "[1 0],[-1 0],[-1 0]",
+    "[1 0],[2 0],[-1 0]",
+    "[1 0],[2 0],[3 0]",
+    "[1 0],[4 0],[3 0]",
+    "[1 0],[4 0],[5 0]",
+    "[1 0],[6 0],[5 0]",
+    "[1 0],[6 0],[7 0]",
+    "[1 0],[8 0],[7 0]"
+    };
+    // page 1 is hit often enough to outlive every page loaded after it
+    const int orderRequests[]= {1,1,1,1,2,3,4,5,6,7,8};
+
+    int i;
+    int maxCount = 3;
+    int invalidCount = 0;
+    BM_BufferPool *bm = MAKE_POOL();
+    BM_PageHandle *h = MAKE_PAGE_HANDLE();
+    testName = "Testing GCLOCK page replacement";
+
+    CHECK(createPageFile("testbuffer.bin"));
+    createDummyPages(bm, 100);
+
+    ASSERT_ERROR(initBufferPool(bm, "testbuffer.bin", 3, RS_GCLOCK, &invalidCount),
+                 "usage count must be positive");
+    CHECK(initBufferPool(bm, "testbuffer.bin", 3, RS_GCLOCK, &maxCount));
+
+    for (i=0;i<11;i++)
+    {
+        pinPage(bm,h,orderRequests[i]);
+        unpinPage(bm,h);
+        ASSERT_EQUALS_POOL(poolContents[i], bm, "check pool content using pages");
+    }
+    ASSERT_EQUALS_INT(8, getNumReadIO(bm), "check number of read I/Os");
+    CHECK(shutdownBufferPool(bm));
+
+    // a single usage level behaves like CLOCK
+    maxCount = 1;
+    CHECK(initBufferPool(bm, "testbuffer.bin", 3, RS_GCLOCK, &maxCount));
+    for (i=0;i<11;i++)
+    {
+        pinPage(bm,h,orderRequests[i]);
+        unpinPage(bm,h);
+    }
+    ASSERT_EQUALS_POOL("[6 0],[7 0],[8 0]", bm, "check pool content using pages");
+    CHECK(shutdownBufferPool(bm));
+
+    CHECK(destroyPageFile("testbuffer.bin"));
+
+    free(bm);
+    free(h);
+    TEST_DONE();
+}
+
+void
+testClockPro(void)
+{
+    // expected results
+    const char *poolContents[]= {
+    "[1 0],[-1 0],[-1 0],[-1 0]",
+    "[1 0],[2 0],[-1 0],[-1 0]",
+    "[1 0],[2 0],[3 0],[-1 0]",
+    "[1 0],[2 0],[3 0],[4 0]",
+    "[1 0],[2 0],[3 0],[4 0]",
+    "[1 0],[2 0],[3 0],[10 0]",
+    "[1 0],[2 0],[3 0],[11 0]",
+    "[1 0],[2 0],[3 0],[12 0]",
+    "[1 0],[2 0],[3 0],[11 0]",
+    "[1 0],[13 0],[3 0],[11 0]",
+    "[1 0],[13 0],[14 0],[11 0]",
+    "[1 0],[2 0],[14 0],[11 0]",
+    "[1 0],[2 0],[14 0],[11 0]",
+    "[1 0],[2 0],[3 0],[11 0]",
+    "[1 0],[20 0],[3 1],[11 0]",
+    "[1 0],[21 0],[3 1],[11 0]"
+    };
+    // pages 1 to 3 fill the pool as hot pages and survive the scan of
+    // cold pages 10 to 12; page 11 comes back within its test period and
+    // becomes hot, demoting the unreferenced hot pages 2 and 3
+    const int orderRequests[]= {1,2,3,4,1,10,11,12,11,13,14,2,11,3};
+
+    int i;
+    BM_BufferPool *bm = MAKE_POOL();
+    BM_PageHandle *h = MAKE_PAGE_HANDLE();
+    BM_PageHandle *pinned = MAKE_PAGE_HANDLE();
+    testName = "Testing CLOCK-Pro page replacement";
+
+    CHECK(createPageFile("testbuffer.bin"));
+    createDummyPages(bm, 100);
+    CHECK(initBufferPool(bm, "testbuffer.bin", 4, RS_CLOCK_PRO, NULL));
+
+    for (i=0;i<14;i++)
+    {
+        pinPage(bm,h,orderRequests[i]);
+        unpinPage(bm,h);
+        ASSERT_EQUALS_POOL(poolContents[i], bm, "check pool content using pages");
+    }
+    ASSERT_EQUALS_INT(12, getNumReadIO(bm), "check number of read I/Os");
+
+    // a pinned cold page is passed over by the cold hand
+    CHECK(pinPage(bm, pinned, 3));
+    for (i=0;i<2;i++)
+    {
+        pinPage(bm,h,20 + i);
+        unpinPage(bm,h);
+        ASSERT_EQUALS_POOL(poolContents[14 + i], bm, "check pool content using pages");
+    }
+    CHECK(unpinPage(bm, pinned));
+
+    CHECK(shutdownBufferPool(bm));
+    CHECK(destroyPageFile("testbuffer.bin"));
+
+    free(bm);
+    free(h);
+    free(pinned);
+    TEST_DONE();
+}
@@ -0,0 +1,1574 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "storage_mgr.h"
+#include "buffer_mgr_stat.h"
+#include "buffer_mgr.h"
+#include "dberror.h"
+#include "frame_scan.h"
+#include "pool_stats.h"
+#include "replacement_policy.h"
+#include "test_helper.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// var to store the current test's name
+char *testName;
+
+// check whether two the content of a buffer pool is the same as an expected content
+// (given in the format produced by sprintPoolContent)
+#define ASSERT_EQUALS_POOL(expected,bm,message)			        \
+  do {									\
+    char *real;								\
+    char *_exp = (char *) (expected);                                   \
+    real = sprintPoolContent(bm);					\
+    if (strcmp((_exp),real) != 0)					\
+      {									\
+	printf("[%s-%s-L%i-%s] FAILED: expected <%s> but was <%s>: %s\n",TEST_INFO, _exp, real, message); \
+	free(real);							\
+	exit(1);							\
+      }									\
+    printf("[%s-%s-L%i-%s] OK: expected <%s> and was <%s>: %s\n",TEST_INFO, _exp, real, message); \
+    free(real);								\
+  } while(0)
+
+// test and helper methods
+static void createDummyPages(const char *fileName, int num);
+
+static void testMultipleFiles (void);
+static void testWarmup (void);
+static void testFrameMemory (void);
+static void testNumaPartitions (void);
+static void testFrameScan (void);
+static void testLirsLoop (void);
+static void testSieve (void);
+static void testAdmission (void);
+static void testAdaptiveStrategy (void);
+static void testCustomPolicy (void);
+static void testPinWait (void);
+static void testPageHandles (void);
+static void testDirtyRanges (void);
+static void testCompressedTier (void);
+static void testVictimCache (void);
+static void testPinHints (void);
+static void testSharedPool (void);
+static void testSharedRecovery (void);
+static void testPoolStats (void);
+
+// main method
+int
+main (void)
+{
+  initStorageManager();
+  testName = "";
+
+  testMultipleFiles();
+  testWarmup();
+  testFrameMemory();
+  testNumaPartitions();
+  testFrameScan();
+  testLirsLoop();
+  testSieve();
+  testAdmission();
+  testAdaptiveStrategy();
+  testCustomPolicy();
+  testPinWait();
+  testPageHandles();
+  testDirtyRanges();
+  testCompressedTier();
+  testVictimCache();
+  testPinHints();
+  testSharedPool();
+  testSharedRecovery();
+  testPoolStats();
+  return 0;
+}
+
+// create n pages with content "<fileName>-X" in the given page file
+void
+createDummyPages(const char *fileName, int num)
+{
+  int i;
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+
+  CHECK(createPageFile(fileName));
+  CHECK(initBufferPool(bm, fileName, 3, RS_FIFO, NULL));
+
+  for (i = 0; i < num; i++)
+    {
+      CHECK(pinPage(bm, h, i));
+      sprintf(h->data, "%s-%i", fileName, h->pageNum);
+      CHECK(markDirty(bm, h));
+      CHECK(unpinPage(bm,h));
+    }
+
+  CHECK(shutdownBufferPool(bm));
+
+  free(bm);
+  free(h);
+}
+
+// pin pages of two page files through one pool and check that frames are keyed on (file, page)
+void
+testMultipleFiles (void)
+{
+  // expected results
+  const char *poolContents[] = {
+    "[0 0],[-1 0],[-1 0]",
+    "[0 0],[0 0],[-1 0]",
+    "[0 0],[0 0],[1 0]",
+    "[2x0],[0 0],[1 0]",
+  };
+
+  int i;
+  FileId other;
+  FileId *fileIds;
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  char *expected = malloc(sizeof(char) * 512);
+  testName = "Testing one buffer pool over multiple page files";
+
+  createDummyPages("testbuffer.bin", 10);
+  createDummyPages("testbuffer2.bin", 10);
+
+  CHECK(initBufferPool(bm, "testbuffer.bin", 3, RS_FIFO, NULL));
+  CHECK(registerPageFile(bm, "testbuffer2.bin", &other));
+  ASSERT_EQUALS_INT(1, other, "second file gets id 1");
+
+  CHECK(registerPageFile(bm, "testbuffer.bin", &i));
+  ASSERT_EQUALS_INT(DEFAULT_FILE_ID, i, "registering the pool's file again returns its id");
+  ASSERT_ERROR(registerPageFile(bm, "nosuchfile.bin", &i), "registering a missing file fails");
+
+  // page 0 of both files lands in separate frames
+  CHECK(pinPage(bm, h, 0));
+  ASSERT_EQUALS_STRING("testbuffer.bin-0", h->data, "page 0 of first file");
+  CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_POOL(poolContents[0], bm, "check pool content");
+
+  CHECK(pinFilePage(bm, h, other, 0));
+  ASSERT_EQUALS_STRING("testbuffer2.bin-0", h->data, "page 0 of second file");
+  CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_POOL(poolContents[1], bm, "check pool content");
+
+  CHECK(pinFilePage(bm, h, other, 1));
+  CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_POOL(poolContents[2], bm, "check pool content");
+
+  fileIds = getFrameFileIds(bm);
+  ASSERT_EQUALS_INT(DEFAULT_FILE_ID, fileIds[0], "frame 0 holds first file");
+  ASSERT_EQUALS_INT(other, fileIds[1], "frame 1 holds second file");
+  ASSERT_EQUALS_INT(other, fileIds[2], "frame 2 holds second file");
+  free(fileIds);
+
+  // a hit on page 0 of the second file must not return page 0 of the first
+  CHECK(pinFilePage(bm, h, other, 0));
+  ASSERT_EQUALS_STRING("testbuffer2.bin-0", h->data, "hit on page 0 of second file");
+  CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_INT(3, getNumReadIO(bm), "check number of read I/Os");
+
+  // dirty pages are written back to the file they came from on eviction
+  CHECK(pinFilePage(bm, h, other, 2));
+  sprintf(h->data, "%s-%i", "modified", h->pageNum);
+  CHECK(markDirty(bm, h));
+  CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_POOL(poolContents[3], bm, "check pool content");
+
+  ASSERT_ERROR(pinFilePage(bm, h, 7, 0), "pinning with an unknown file id fails");
+
+  CHECK(shutdownBufferPool(bm));
+
+  CHECK(initBufferPool(bm, "testbuffer2.bin", 3, RS_FIFO, NULL));
+  for (i = 0; i < 3; i++)
+    {
+      CHECK(pinPage(bm, h, i));
+      sprintf(expected, "%s-%i", (i == 2) ? "modified" : "testbuffer2.bin", i);
+      ASSERT_EQUALS_STRING(expected, h->data, "reading back second file");
+      CHECK(unpinPage(bm, h));
+    }
+  CHECK(shutdownBufferPool(bm));
+
+  CHECK(destroyPageFile("testbuffer.bin"));
+  CHECK(destroyPageFile("testbuffer2.bin"));
+
+  free(expected);
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+// dump the hot page set at shutdown and preload it into a new pool
+void
+testWarmup (void)
+{
+  int i;
+  char line[64];
+  FILE *warm;
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  BM_PoolOptions options;
+  const int requests[] = {5,6,7,5};
+  testName = "Testing buffer pool warm-up across restarts";
+
+  memset(&options, 0, sizeof(options));
+  options.warmFile = "testbuffer.warm";
+  remove(options.warmFile);
+
+  createDummyPages("testbuffer.bin", 10);
+
+  // a missing warm file leaves the pool cold
+  CHECK(initBufferPoolWithOptions(bm, "testbuffer.bin", 3, RS_LRU, NULL, &options));
+  CHECK(finishPreload(bm));
+  ASSERT_EQUALS_POOL("[-1 0],[-1 0],[-1 0]", bm, "cold pool without warm file");
+
+  for (i = 0; i < 4; i++)
+    {
+      CHECK(pinPage(bm, h, requests[i]));
+      CHECK(unpinPage(bm, h));
+    }
+  CHECK(shutdownBufferPool(bm));
+
+  // the most recently used page is listed first
+  warm = fopen(options.warmFile, "r");
+  ASSERT_TRUE(warm != NULL, "warm file written at shutdown");
+  for (i = 0; i < 5; i++)
+    ASSERT_TRUE(fgets(line, sizeof(line), warm) != NULL, "read warm file header");
+  ASSERT_EQUALS_STRING("0 5\n", line, "most valuable page first");
+  fclose(warm);
+
+  CHECK(initBufferPoolWithOptions(bm, "testbuffer.bin", 3, RS_LRU, NULL, &options));
+  CHECK(finishPreload(bm));
+  ASSERT_EQUALS_POOL("[5 0],[6 0],[7 0]", bm, "hot pages preloaded in sorted order");
+  ASSERT_EQUALS_INT(3, getNumPreloadedPages(bm), "check number of preloaded pages");
+
+  CHECK(pinPage(bm, h, 6));
+  ASSERT_EQUALS_STRING("testbuffer.bin-6", h->data, "preloaded page content");
+  CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_INT(3, getNumReadIO(bm), "pinning a preloaded page is a hit");
+
+  // untouched preloaded pages are evicted before used ones
+  CHECK(pinPage(bm, h, 8));
+  CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_POOL("[8 0],[6 0],[7 0]", bm, "preloaded pages evicted first");
+  CHECK(shutdownBufferPool(bm));
+
+  // with a save interval, forceFlushPool rewrites the warm file; pinPage never does
+  options.warmSaveInterval = 2;
+  CHECK(initBufferPoolWithOptions(bm, "testbuffer.bin", 3, RS_LRU, NULL, &options));
+  CHECK(finishPreload(bm));
+  remove(options.warmFile);
+  for (i = 0; i < 4; i++)
+    {
+      CHECK(pinPage(bm, h, requests[i]));
+      CHECK(unpinPage(bm, h));
+    }
+  warm = fopen(options.warmFile, "r");
+  ASSERT_TRUE(warm == NULL, "pinning does not write the warm file");
+  CHECK(forceFlushPool(bm));
+  warm = fopen(options.warmFile, "r");
+  ASSERT_TRUE(warm != NULL, "flush writes the warm file after the interval");
+  fclose(warm);
+
+  CHECK(shutdownBufferPool(bm));
+  CHECK(destroyPageFile("testbuffer.bin"));
+  remove(options.warmFile);
+
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+// frame memory falls back gracefully and reports the mode obtained
+void
+testFrameMemory (void)
+{
+  int i;
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  BM_PoolOptions options;
+  char *expected = malloc(sizeof(char) * 512);
+  testName = "Testing huge page backed frame memory";
+
+  memset(&options, 0, sizeof(options));
+  createDummyPages("testbuffer.bin", 600);
+
+  // small pools stay on the heap
+  CHECK(initBufferPool(bm, "testbuffer.bin", 3, RS_FIFO, NULL));
+  ASSERT_EQUALS_INT(FM_HEAP, getFrameMemoryMode(bm), "small pool uses the heap");
+  CHECK(shutdownBufferPool(bm));
+
+  options.frameMemory = FM_HEAP;
+  CHECK(initBufferPoolWithOptions(bm, "testbuffer.bin", 512, RS_FIFO, NULL, &options));
+  ASSERT_EQUALS_INT(FM_HEAP, getFrameMemoryMode(bm), "heap requested explicitly");
+  CHECK(shutdownBufferPool(bm));
+
+  // huge pages may be unavailable; any mode obtained must hold the pages
+  options.frameMemory = FM_HUGETLB;
+  CHECK(initBufferPoolWithOptions(bm, "testbuffer.bin", 512, RS_CLOCK, NULL, &options));
+  ASSERT_TRUE(getFrameMemoryMode(bm) != FM_AUTO, "a concrete mode is reported");
+  for (i = 0; i < 600; i++)
+    {
+      CHECK(pinPage(bm, h, i));
+      sprintf(expected, "%s-%i", "testbuffer.bin", i);
+      ASSERT_EQUALS_STRING(expected, h->data, "reading pages through huge page frames");
+      CHECK(unpinPage(bm, h));
+    }
+  CHECK(shutdownBufferPool(bm));
+
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(expected);
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+// NUMA partitioning covers every frame and counts where hits were served
+void
+testNumaPartitions (void)
+{
+  int i;
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  BM_PoolOptions options;
+  testName = "Testing NUMA-aware frame partitions";
+
+  memset(&options, 0, sizeof(options));
+  createDummyPages("testbuffer.bin", 20);
+
+  CHECK(initBufferPool(bm, "testbuffer.bin", 3, RS_CLOCK, NULL));
+  ASSERT_EQUALS_INT(1, getNumPartitions(bm), "single partition by default");
+  CHECK(shutdownBufferPool(bm));
+
+  // small pools and single-node machines degrade to one partition
+  options.numaAware = true;
+  CHECK(initBufferPoolWithOptions(bm, "testbuffer.bin", 3, RS_CLOCK, NULL, &options));
+  ASSERT_EQUALS_INT(1, getNumPartitions(bm), "degrades to a single partition");
+
+  for (i = 0; i < 6; i++)
+    {
+      CHECK(pinPage(bm, h, i % 2));
+      CHECK(unpinPage(bm, h));
+    }
+  ASSERT_EQUALS_POOL("[0 0],[1 0],[-1 0]", bm, "check pool content");
+  ASSERT_EQUALS_INT(4, getNumLocalHits(bm) + getNumRemoteHits(bm), "every hit is counted");
+  ASSERT_EQUALS_INT(2, getNumReadIO(bm), "check number of read I/Os");
+  CHECK(shutdownBufferPool(bm));
+
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+// vector scan kernels agree with the scalar loops, including ties and tails
+void
+testFrameScan (void)
+{
+  int pages[80], stamps[80], fixCounts[80];
+  int n, round, i, mismatches = 0;
+  testName = "Testing vectorized frame scans";
+
+  srand(42);
+  for (n = 0; n <= 80; n++)
+    for (round = 0; round < 50; round++)
+      {
+        for (i = 0; i < n; i++)
+          {
+            pages[i] = rand() % 40 - 1;
+            stamps[i] = rand() % 8;
+            fixCounts[i] = (rand() % 4 == 0);
+          }
+        for (i = 0; i <= n; i++)
+          if (scanFindPage(pages, i, n, round % 40 - 1) != scanFindPageScalar(pages, i, n, round % 40 - 1))
+            mismatches++;
+        if (scanMinUnpinned(stamps, fixCounts, n) != scanMinUnpinnedScalar(stamps, fixCounts, n))
+          mismatches++;
+      }
+  ASSERT_EQUALS_INT(0, mismatches, "kernels match the scalar scans");
+
+  for (i = 0; i < 80; i++)
+    fixCounts[i] = 1;
+  ASSERT_EQUALS_INT(-1, scanMinUnpinned(stamps, fixCounts, 80), "no victim when all frames are pinned");
+  printf("frame scan kernel: %s\n", scanKernelName());
+
+  TEST_DONE();
+}
+
+// a loop one page larger than the pool: LRU never hits, LIRS keeps its LIR pages
+void
+testLirsLoop (void)
+{
+  const char *poolContents[] = {
+    "[0 0],[-1 0],[-1 0]",
+    "[0 0],[1 0],[-1 0]",
+    "[0 0],[1 0],[2 0]",
+    "[0 0],[1 0],[3 0]",
+    "[0 0],[1 0],[3 0]",
+    "[0 0],[1 0],[3 0]",
+    "[0 0],[1 0],[2 0]",
+    "[0 0],[1 0],[3 0]",
+  };
+  int i;
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  testName = "Testing LIRS on a looping access pattern";
+
+  createDummyPages("testbuffer.bin", 4);
+
+  CHECK(initBufferPool(bm, "testbuffer.bin", 3, RS_LRU, NULL));
+  for (i = 0; i < 12; i++)
+    {
+      CHECK(pinPage(bm, h, i % 4));
+      CHECK(unpinPage(bm, h));
+    }
+  ASSERT_EQUALS_INT(12, getNumReadIO(bm), "LRU misses on every request");
+  CHECK(shutdownBufferPool(bm));
+
+  // pages 0 and 1 are LIR; 2 and 3 take turns in the single HIR frame
+  CHECK(initBufferPool(bm, "testbuffer.bin", 3, RS_LIRS, NULL));
+  for (i = 0; i < 8; i++)
+    {
+      CHECK(pinPage(bm, h, i % 4));
+      CHECK(unpinPage(bm, h));
+      ASSERT_EQUALS_POOL(poolContents[i], bm, "check pool content");
+    }
+  ASSERT_EQUALS_INT(6, getNumReadIO(bm), "LIRS hits on its LIR pages");
+
+  // a pinned HIR page forces the least recent LIR page out
+  CHECK(pinPage(bm, h, 3));
+  CHECK(pinPage(bm, h, 2));
+  ASSERT_EQUALS_POOL("[2 1],[1 0],[3 1]", bm, "check pool content");
+  CHECK(unpinPage(bm, h));
+  h->pageNum = 3;
+  CHECK(unpinPage(bm, h));
+  CHECK(shutdownBufferPool(bm));
+
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+// SIEVE keeps visited pages in place while the hand evicts unvisited ones
+void
+testSieve (void)
+{
+  const char *poolContents[] = {
+    "[1 0],[-1 0],[-1 0]",
+    "[1 0],[2 0],[-1 0]",
+    "[1 0],[2 0],[3 0]",
+    "[1 0],[2 0],[3 0]",
+    "[1 0],[4 0],[3 0]",
+    "[1 0],[4 0],[5 0]",
+    "[1 0],[4 0],[5 0]",
+    "[1 0],[4 0],[6 0]",
+    "[1 0],[4 0],[6 0]",
+    "[1 0],[7 0],[6 0]",
+  };
+  const int orderRequests[] = {1,2,3,1,4,5,4,6,1,7};
+  int i;
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  testName = "Testing SIEVE page replacement";
+
+  createDummyPages("testbuffer.bin", 10);
+  CHECK(initBufferPool(bm, "testbuffer.bin", 3, RS_SIEVE, NULL));
+
+  for (i = 0; i < 10; i++)
+    {
+      CHECK(pinPage(bm, h, orderRequests[i]));
+      CHECK(unpinPage(bm, h));
+      ASSERT_EQUALS_POOL(poolContents[i], bm, "check pool content");
+    }
+  ASSERT_EQUALS_INT(7, getNumReadIO(bm), "check number of read I/Os");
+
+  // the hand passes over a pinned page
+  CHECK(pinPage(bm, h, 6));
+  CHECK(pinPage(bm, h, 8));
+  ASSERT_EQUALS_POOL("[1 0],[8 1],[6 1]", bm, "check pool content");
+  CHECK(unpinPage(bm, h));
+  h->pageNum = 6;
+  CHECK(unpinPage(bm, h));
+  CHECK(shutdownBufferPool(bm));
+
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+// TinyLFU admission serves a page seen less often than the victim from a bypass frame
+void
+testAdmission (void)
+{
+  int i;
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  BM_PageHandle *h2 = MAKE_PAGE_HANDLE();
+  BM_PoolOptions options;
+  testName = "Testing TinyLFU admission filter";
+
+  memset(&options, 0, sizeof(options));
+  options.admissionFilter = true;
+  createDummyPages("testbuffer.bin", 10);
+  CHECK(initBufferPoolWithOptions(bm, "testbuffer.bin", 3, RS_LRU, NULL, &options));
+
+  for (i = 0; i < 6; i++)
+    {
+      CHECK(pinPage(bm, h, 1 + i / 2));
+      CHECK(unpinPage(bm, h));
+    }
+  ASSERT_EQUALS_POOL("[1 0],[2 0],[3 0]", bm, "pages seen twice");
+
+  // page 9 was seen once, less than the LRU victim page 1
+  CHECK(pinPage(bm, h, 9));
+  ASSERT_EQUALS_STRING("testbuffer.bin-9", h->data, "bypassed page content");
+  ASSERT_EQUALS_POOL("[1 0],[2 0],[3 0]", bm, "rejected page is not cached");
+  ASSERT_EQUALS_INT(1, getNumRejectedPages(bm), "one rejected page");
+  CHECK(pinPage(bm, h2, 9));
+  ASSERT_TRUE(h->data == h2->data, "second pin shares the bypass frame");
+  ASSERT_EQUALS_INT(4, getNumReadIO(bm), "check number of read I/Os");
+
+  sprintf(h->data, "%s", "bypassed");
+  CHECK(markDirty(bm, h));
+  ASSERT_ERROR(shutdownBufferPool(bm), "bypassed page is still pinned");
+  CHECK(unpinPage(bm, h));
+  CHECK(unpinPage(bm, h2));
+  ASSERT_EQUALS_INT(1, getNumWriteIO(bm), "written back on its last unpin");
+
+  // seen three times now, page 9 beats the victim and is cached
+  CHECK(pinPage(bm, h, 9));
+  ASSERT_EQUALS_STRING("bypassed", h->data, "modification was written");
+  ASSERT_EQUALS_POOL("[9 1],[2 0],[3 0]", bm, "popular page is admitted");
+  CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_INT(1, getNumRejectedPages(bm), "one rejected page");
+  CHECK(shutdownBufferPool(bm));
+
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(bm);
+  free(h);
+  free(h2);
+  TEST_DONE();
+}
+
+// adaptive pools switch to the strategy that scores more hits in their shadow caches
+void
+testAdaptiveStrategy (void)
+{
+  int i;
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  BM_PoolOptions options;
+  testName = "Testing adaptive strategy selection";
+
+  memset(&options, 0, sizeof(options));
+  options.adaptiveStrategy = true;
+  createDummyPages("testbuffer.bin", 10);
+  ASSERT_ERROR(initBufferPoolWithOptions(bm, "testbuffer.bin", 4, RS_LIRS, NULL, &options),
+               "only FIFO, LRU and CLOCK pools are adaptive");
+  CHECK(initBufferPoolWithOptions(bm, "testbuffer.bin", 4, RS_FIFO, NULL, &options));
+
+  // every strategy hits on a working set that fits
+  for (i = 0; i < 1000; i++)
+    {
+      CHECK(pinPage(bm, h, 1 + i % 4));
+      CHECK(unpinPage(bm, h));
+    }
+  ASSERT_EQUALS_INT(RS_FIFO, bm->strategy, "no reason to switch");
+  ASSERT_EQUALS_INT(0, getNumStrategySwitches(bm), "no switches");
+
+  // a hot page between a loop over five pages: FIFO keeps evicting it
+  for (i = 0; i < 1000; i++)
+    {
+      CHECK(pinPage(bm, h, (i % 2 == 0) ? 1 : 5 + (i / 2) % 5));
+      CHECK(unpinPage(bm, h));
+    }
+  ASSERT_EQUALS_INT(RS_LRU, bm->strategy, "switched to LRU");
+  ASSERT_EQUALS_INT(1, getNumStrategySwitches(bm), "one switch");
+
+  // the hot page now stays cached
+  CHECK(pinPage(bm, h, 5));
+  CHECK(unpinPage(bm, h));
+  CHECK(pinPage(bm, h, 1));
+  CHECK(unpinPage(bm, h));
+  i = getNumReadIO(bm);
+  CHECK(pinPage(bm, h, 6));
+  CHECK(unpinPage(bm, h));
+  CHECK(pinPage(bm, h, 1));
+  CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_INT(i + 1, getNumReadIO(bm), "hot page is a hit");
+  CHECK(shutdownBufferPool(bm));
+
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+// MRU policy counting its callbacks, for testCustomPolicy
+typedef struct MruCalls {
+  int hits, inserts, unpins, evictions;
+} MruCalls;
+
+static void
+mruHit (BM_PolicyView *view, int idx)
+{
+  ((MruCalls *) view->policyData)->hits++;
+  *(int *) POLICY_FRAME_STATE(view, idx) = ++*(int *) view->poolState;
+}
+
+static void
+mruInsert (BM_PolicyView *view, int idx)
+{
+  ((MruCalls *) view->policyData)->inserts++;
+  *(int *) POLICY_FRAME_STATE(view, idx) = ++*(int *) view->poolState;
+}
+
+static void
+mruUnpin (BM_PolicyView *view, int idx)
+{
+  (void) idx;
+  ((MruCalls *) view->policyData)->unpins++;
+}
+
+static int
+mruPickVictim (BM_PolicyView *view)
+{
+  int i, victim = -1;
+
+  for (i = 0; i < view->numFrames; i++)
+    if (view->fixCounts[i] == 0 && (victim == -1 || *(int *) POLICY_FRAME_STATE(view, i)
+                                    > *(int *) POLICY_FRAME_STATE(view, victim)))
+      victim = i;
+  return victim;
+}
+
+static void
+mruEvict (BM_PolicyView *view, int idx)
+{
+  (void) idx;
+  ((MruCalls *) view->policyData)->evictions++;
+}
+
+// policies plugged in through stratData; the built-in ones match RS_FIFO, RS_LRU and RS_CLOCK
+void
+testCustomPolicy (void)
+{
+  const ReplacementStrategy strategies[] = { RS_FIFO, RS_LRU, RS_CLOCK };
+  const BM_ReplacementPolicy *policies[] = { &fifoPolicy, &lruPolicy, &clockPolicy };
+  BM_BufferPool *native = MAKE_POOL();
+  BM_BufferPool *custom = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  BM_PageHandle pinned[3];
+  BM_ReplacementPolicy mru;
+  MruCalls calls;
+  unsigned int random = 12345;
+  int s, i, same;
+  testName = "Testing custom replacement policies";
+
+  createDummyPages("testbuffer.bin", 12);
+  ASSERT_ERROR(initBufferPool(custom, "testbuffer.bin", 5, RS_CUSTOM, NULL),
+               "a custom pool needs a policy");
+
+  // random pins, some held across later requests, give the same pool contents
+  for (s = 0; s < 3; s++)
+    {
+      CHECK(initBufferPool(native, "testbuffer.bin", 5, strategies[s], NULL));
+      CHECK(initBufferPool(custom, "testbuffer.bin", 5, RS_CUSTOM, (void *) policies[s]));
+      same = 1;
+      for (i = 0; i < 400 && same; i++)
+        {
+          int page;
+          random = random * 1103515245u + 12345u;
+          page = (random >> 16) % 12;
+          if (i % 7 == 0)
+            {
+              int slot = (i / 7) % 3;
+              if (i >= 21)
+                {
+                  CHECK(unpinPage(native, &pinned[slot]));
+                  CHECK(unpinPage(custom, &pinned[slot]));
+                }
+              CHECK(pinPage(native, &pinned[slot], page));
+              CHECK(pinPage(custom, &pinned[slot], page));
+            }
+          else
+            {
+              CHECK(pinPage(native, h, page));
+              CHECK(unpinPage(native, h));
+              CHECK(pinPage(custom, h, page));
+              CHECK(unpinPage(custom, h));
+            }
+          char *expected = sprintPoolContent(native);
+          char *actual = sprintPoolContent(custom);
+          same = strcmp(expected, actual) == 0;
+          free(expected);
+          free(actual);
+        }
+      ASSERT_TRUE(same, policies[s]->name);
+      ASSERT_EQUALS_INT(getNumReadIO(native), getNumReadIO(custom), "same number of reads");
+      for (i = 0; i < 3; i++)
+        {
+          CHECK(unpinPage(native, &pinned[i]));
+          CHECK(unpinPage(custom, &pinned[i]));
+        }
+      CHECK(shutdownBufferPool(native));
+      CHECK(shutdownBufferPool(custom));
+    }
+
+  // a policy defined here, with its own frame and pool state
+  memset(&calls, 0, sizeof(calls));
+  memset(&mru, 0, sizeof(mru));
+  mru.name = "MRU";
+  mru.frameStateSize = sizeof(int);
+  mru.poolStateSize = sizeof(int);
+  mru.policyData = &calls;
+  mru.onHit = mruHit;
+  mru.onInsert = mruInsert;
+  mru.onUnpin = mruUnpin;
+  mru.pickVictim = mruPickVictim;
+  mru.onEvict = mruEvict;
+  CHECK(initBufferPool(custom, "testbuffer.bin", 3, RS_CUSTOM, &mru));
+  for (i = 0; i < 4; i++)
+    {
+      CHECK(pinPage(custom, h, i));
+      CHECK(unpinPage(custom, h));
+    }
+  ASSERT_EQUALS_POOL("[0 0],[1 0],[3 0]", custom, "most recent page replaced");
+  CHECK(pinPage(custom, h, 0));
+  CHECK(pinPage(custom, &pinned[0], 4));
+  ASSERT_EQUALS_POOL("[0 1],[1 0],[4 1]", custom, "pinned page is skipped");
+  CHECK(pinPage(custom, &pinned[1], 5));
+  ASSERT_ERROR(pinPage(custom, &pinned[2], 6), "all frames pinned");
+  ASSERT_EQUALS_INT(1, calls.hits, "onHit calls");
+  ASSERT_EQUALS_INT(6, calls.inserts, "onInsert calls");
+  ASSERT_EQUALS_INT(4, calls.unpins, "onUnpin calls");
+  ASSERT_EQUALS_INT(3, calls.evictions, "onEvict calls");
+  CHECK(unpinPage(custom, h));
+  CHECK(unpinPage(custom, &pinned[0]));
+  CHECK(unpinPage(custom, &pinned[1]));
+  CHECK(shutdownBufferPool(custom));
+
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(native);
+  free(custom);
+  free(h);
+  TEST_DONE();
+}
+
+// page released by unpinAfterStall once the pool reports a stalled pin
+typedef struct StalledUnpin {
+  BM_BufferPool *bm;
+  BM_PageHandle *page;
+} StalledUnpin;
+
+static void *
+unpinAfterStall (void *arg)
+{
+  StalledUnpin *unpin = (StalledUnpin *) arg;
+  struct timespec pause = { 0, 1000000 };
+
+  while (getNumPinStalls(unpin->bm) == 0)
+    nanosleep(&pause, NULL);
+  CHECK(unpinPage(unpin->bm, unpin->page));
+  return NULL;
+}
+
+// pins fail with a distinct code when every frame is pinned, or wait for an unpin
+void
+testPinWait (void)
+{
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  BM_PageHandle pinned[2];
+  BM_PoolOptions options;
+  StalledUnpin unpin;
+  pthread_t thread;
+  RC rc;
+  testName = "Testing pins when all frames are pinned";
+
+  createDummyPages("testbuffer.bin", 4);
+  CHECK(initBufferPool(bm, "testbuffer.bin", 2, RS_LRU, NULL));
+  CHECK(pinPage(bm, &pinned[0], 0));
+  CHECK(pinPage(bm, &pinned[1], 1));
+  rc = pinPage(bm, h, 2);
+  ASSERT_EQUALS_INT(RC_ALL_FRAMES_PINNED, rc, "no frame can be evicted");
+  ASSERT_EQUALS_INT(1, getNumPinStalls(bm), "one stalled pin");
+  ASSERT_EQUALS_INT(1, getNumPinTimeouts(bm), "without waits every stall fails");
+  CHECK(pinPage(bm, h, 1));
+  CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_INT(1, getNumPinStalls(bm), "hits on pinned pages do not stall");
+  CHECK(unpinPage(bm, &pinned[0]));
+  CHECK(unpinPage(bm, &pinned[1]));
+  CHECK(shutdownBufferPool(bm));
+
+  memset(&options, 0, sizeof(options));
+  options.pinWaitMs = -1;
+  ASSERT_ERROR(initBufferPoolWithOptions(bm, "testbuffer.bin", 2, RS_LRU, NULL, &options),
+               "negative wait");
+
+  // a bounded wait gives up when nobody unpins
+  options.pinWaitMs = 20;
+  CHECK(initBufferPoolWithOptions(bm, "testbuffer.bin", 2, RS_LRU, NULL, &options));
+  CHECK(pinPage(bm, &pinned[0], 0));
+  CHECK(pinPage(bm, &pinned[1], 1));
+  rc = pinPage(bm, h, 2);
+  ASSERT_EQUALS_INT(RC_ALL_FRAMES_PINNED, rc, "wait timed out");
+  ASSERT_EQUALS_INT(1, getNumPinTimeouts(bm), "one timeout");
+
+  // and succeeds when another thread unpins a page meanwhile
+  CHECK(unpinPage(bm, &pinned[0]));
+  CHECK(unpinPage(bm, &pinned[1]));
+  CHECK(shutdownBufferPool(bm));
+  options.pinWaitMs = 10000;
+  CHECK(initBufferPoolWithOptions(bm, "testbuffer.bin", 2, RS_LRU, NULL, &options));
+  CHECK(pinPage(bm, &pinned[0], 0));
+  CHECK(pinPage(bm, &pinned[1], 1));
+  unpin.bm = bm;
+  unpin.page = &pinned[1];
+  ASSERT_TRUE(pthread_create(&thread, NULL, unpinAfterStall, &unpin) == 0, "unpinning thread started");
+  CHECK(pinPage(bm, h, 2));
+  pthread_join(thread, NULL);
+  ASSERT_EQUALS_STRING("testbuffer.bin-2", h->data, "page read after the wait");
+  ASSERT_EQUALS_POOL("[0 1],[2 1]", bm, "unpinned frame was replaced");
+  ASSERT_EQUALS_INT(1, getNumPinStalls(bm), "one stalled pin");
+  ASSERT_EQUALS_INT(0, getNumPinTimeouts(bm), "no timeouts");
+  CHECK(unpinPage(bm, h));
+  CHECK(unpinPage(bm, &pinned[0]));
+  CHECK(shutdownBufferPool(bm));
+
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+// handles record their frame; a second unpin is reported and stale handles are rejected
+void
+testPageHandles (void)
+{
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  BM_PageHandle first, stale;
+  RC rc;
+  int i;
+  testName = "Testing frame-index page handles";
+
+  createDummyPages("testbuffer.bin", 6);
+  CHECK(initBufferPool(bm, "testbuffer.bin", 3, RS_FIFO, NULL));
+  CHECK(pinPage(bm, h, 0));
+  CHECK(pinPage(bm, h, 1));
+  ASSERT_EQUALS_INT(1, h->frame, "frame of page 1");
+  CHECK(markDirty(bm, h));
+  CHECK(unpinPage(bm, h));
+  rc = unpinPage(bm, h);
+  ASSERT_EQUALS_INT(RC_PAGE_NOT_PINNED, rc, "second unpin is detected");
+  ASSERT_EQUALS_POOL("[0 1],[1x0],[-1 0]", bm, "page 1 unpinned once");
+
+  // a handle filled in by the caller is looked up
+  h->frame = -1;
+  h->pageNum = 0;
+  CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_POOL("[0 0],[1x0],[-1 0]", bm, "page 0 unpinned by lookup");
+  CHECK(shutdownBufferPool(bm));
+
+  // page 0 is evicted and read again into the same frame
+  CHECK(initBufferPool(bm, "testbuffer.bin", 1, RS_FIFO, NULL));
+  CHECK(pinPage(bm, &first, 0));
+  stale = first;
+  CHECK(unpinPage(bm, &first));
+  CHECK(pinPage(bm, h, 2));
+  CHECK(unpinPage(bm, h));
+  ASSERT_ERROR(markDirty(bm, &stale), "page of the stale handle is gone");
+  CHECK(pinPage(bm, &first, 0));
+  ASSERT_EQUALS_INT(stale.frame, first.frame, "same frame again");
+  ASSERT_TRUE(stale.generation != first.generation, "new generation");
+
+  // the page is pinned again through another handle; the stale one must not touch that pin
+  rc = unpinPage(bm, &stale);
+  ASSERT_EQUALS_INT(RC_PAGE_NOT_PINNED, rc, "unpin through a stale handle");
+  rc = markDirty(bm, &stale);
+  ASSERT_EQUALS_INT(RC_PAGE_NOT_PINNED, rc, "markDirty through a stale handle");
+  rc = forcePage(bm, &stale);
+  ASSERT_EQUALS_INT(RC_PAGE_NOT_PINNED, rc, "forcePage through a stale handle");
+  ASSERT_EQUALS_POOL("[0 1]", bm, "other pin left alone");
+  CHECK(unpinPage(bm, &first));
+  ASSERT_EQUALS_POOL("[0 0]", bm, "other pin released through its own handle");
+  CHECK(shutdownBufferPool(bm));
+
+  // a handle aimed at another page is looked up, even after its old frame was reused
+  CHECK(initBufferPool(bm, "testbuffer.bin", 3, RS_LRU, NULL));
+  CHECK(pinPage(bm, &stale, 0));
+  CHECK(unpinPage(bm, &stale));
+  for (i = 1; i <= 3; i++)
+    {
+      CHECK(pinPage(bm, h, i));
+      CHECK(unpinPage(bm, h));
+    }
+  CHECK(pinPage(bm, &first, 5));
+  stale.pageNum = 5;
+  CHECK(unpinPage(bm, &stale));
+  ASSERT_EQUALS_POOL("[3 0],[5 0],[2 0]", bm, "page 5 unpinned through the re-aimed handle");
+  CHECK(shutdownBufferPool(bm));
+
+  // a fresh handle naming a page is looked up
+  free(h);
+  h = MAKE_PAGE_HANDLE();
+  ASSERT_EQUALS_INT(-1, h->frame, "fresh handle has no frame");
+  ASSERT_EQUALS_INT(DEFAULT_FILE_ID, h->fileId, "fresh handle names the default file");
+  CHECK(initBufferPool(bm, "testbuffer.bin", 3, RS_LRU, NULL));
+  CHECK(pinPage(bm, &first, 4));
+  h->pageNum = 4;
+  CHECK(markDirty(bm, h));
+  CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_POOL("[4x0],[-1 0],[-1 0]", bm, "page 4 unpinned through a fresh handle");
+  CHECK(shutdownBufferPool(bm));
+
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+// pages modified through byte ranges only write back their dirty sectors
+void
+testDirtyRanges (void)
+{
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  SM_FileHandle fh;
+  char block[PAGE_SIZE];
+  testName = "Testing sub-page dirty ranges";
+
+  createDummyPages("testbuffer.bin", 3);
+  CHECK(initBufferPool(bm, "testbuffer.bin", 3, RS_FIFO, NULL));
+  CHECK(pinPage(bm, h, 0));
+  ASSERT_ERROR(markDirtyRange(bm, h, -1, 4), "negative offset");
+  ASSERT_ERROR(markDirtyRange(bm, h, 0, 0), "empty range");
+  ASSERT_ERROR(markDirtyRange(bm, h, PAGE_SIZE - 2, 4), "range beyond the page");
+  ASSERT_EQUALS_POOL("[0 1],[-1 0],[-1 0]", bm, "invalid ranges do not dirty the page");
+
+  // sectors 1 and 7 are marked; the change in sector 0 is not
+  sprintf(h->data + 1000, "%s", "sector1");
+  sprintf(h->data + PAGE_SIZE - 10, "%s", "sector7");
+  sprintf(h->data, "%s", "unmarked");
+  CHECK(markDirtyRange(bm, h, 1000, 8));
+  CHECK(markDirtyRange(bm, h, PAGE_SIZE - 10, 8));
+  ASSERT_EQUALS_POOL("[0x1],[-1 0],[-1 0]", bm, "range marks the page dirty");
+  CHECK(forcePage(bm, h));
+  ASSERT_EQUALS_INT(2 * SECTOR_SIZE, (int) getNumBytesWritten(bm), "two sectors written");
+  ASSERT_EQUALS_INT(PAGE_SIZE - 2 * SECTOR_SIZE, (int) getNumBytesSaved(bm), "six sectors saved");
+
+  CHECK(openPageFile("testbuffer.bin", &fh));
+  CHECK(readBlock(0, &fh, block));
+  ASSERT_EQUALS_STRING("testbuffer.bin-0", block, "unmarked sector not written");
+  ASSERT_EQUALS_STRING("sector1", block + 1000, "sector 1 written");
+  ASSERT_EQUALS_STRING("sector7", block + PAGE_SIZE - 10, "sector 7 written");
+
+  // a range across a sector boundary marks both sectors, markDirty the whole page
+  CHECK(markDirtyRange(bm, h, SECTOR_SIZE - 2, 4));
+  CHECK(forcePage(bm, h));
+  ASSERT_EQUALS_INT(4 * SECTOR_SIZE, (int) getNumBytesWritten(bm), "sectors 0 and 1 written");
+  CHECK(markDirtyRange(bm, h, 0, 1));
+  CHECK(markDirty(bm, h));
+  CHECK(unpinPage(bm, h));
+  CHECK(forceFlushPool(bm));
+  ASSERT_EQUALS_INT(4 * SECTOR_SIZE + PAGE_SIZE, (int) getNumBytesWritten(bm), "whole page written");
+  ASSERT_EQUALS_INT(2 * (PAGE_SIZE - 2 * SECTOR_SIZE), (int) getNumBytesSaved(bm), "nothing saved on full writes");
+  CHECK(shutdownBufferPool(bm));
+  CHECK(readBlock(0, &fh, block));
+  ASSERT_EQUALS_STRING("unmarked", block, "sector 0 written with the page");
+  CHECK(closePageFile(&fh));
+
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+// evict pages into a compressed tier and read them back without disk reads
+void
+testCompressedTier (void)
+{
+  int i;
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  BM_PoolOptions options;
+  SM_FileHandle fh;
+  char block[PAGE_SIZE];
+  char name[32];
+  testName = "Testing the compressed second tier";
+
+  createDummyPages("testbuffer.bin", 10);
+  memset(&options, 0, sizeof(options));
+  options.compressedTierBytes = -1;
+  ASSERT_ERROR(initBufferPoolWithOptions(bm, "testbuffer.bin", 3, RS_FIFO, NULL, &options),
+               "negative tier size");
+  options.compressedTierBytes = 64 * 1024;
+  CHECK(initBufferPoolWithOptions(bm, "testbuffer.bin", 3, RS_FIFO, NULL, &options));
+
+  // pages 0 to 2 move to the tier, page 1 still modified
+  for (i = 0; i < 6; i++)
+    {
+      CHECK(pinPage(bm, h, i));
+      if (i == 1)
+        {
+          sprintf(h->data, "%s", "tier-1");
+          CHECK(markDirty(bm, h));
+        }
+      CHECK(unpinPage(bm, h));
+    }
+  ASSERT_EQUALS_POOL("[3 0],[4 0],[5 0]", bm, "pages 0 to 2 evicted");
+  ASSERT_EQUALS_INT(6, getNumReadIO(bm), "six disk reads");
+  ASSERT_EQUALS_INT(0, getNumWriteIO(bm), "modified page kept in the tier");
+  ASSERT_EQUALS_INT(6, getNumTierMisses(bm), "every read missed the tier");
+  ASSERT_TRUE(getTierBytesUsed(bm) > 0 && getTierBytesUsed(bm) < PAGE_SIZE,
+              "three sparse pages compress to less than one page");
+
+  // page 1 comes back from the tier, modification included
+  CHECK(pinPage(bm, h, 1));
+  ASSERT_EQUALS_STRING("tier-1", h->data, "modified page restored");
+  CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_POOL("[1x0],[4 0],[5 0]", bm, "page from the tier is still dirty");
+  ASSERT_EQUALS_INT(1, getNumTierHits(bm), "one tier hit");
+  ASSERT_EQUALS_INT(6, getNumReadIO(bm), "no disk read for the hit");
+
+  // a page that does not compress is written back at once
+  CHECK(pinPage(bm, h, 6));
+  srand(42);
+  for (i = 0; i < PAGE_SIZE; i++)
+    h->data[i] = (char) rand();
+  CHECK(markDirty(bm, h));
+  CHECK(unpinPage(bm, h));
+  for (i = 7; i < 10; i++)
+    {
+      CHECK(pinPage(bm, h, i));
+      CHECK(unpinPage(bm, h));
+    }
+  ASSERT_EQUALS_INT(1, getNumWriteIO(bm), "page 1 back in the tier, page 6 written");
+
+  // modified pages in the tier are written by a flush
+  CHECK(pinPage(bm, h, 3));
+  sprintf(h->data, "%s", "tier-3");
+  CHECK(markDirty(bm, h));
+  CHECK(unpinPage(bm, h));
+  for (i = 7; i < 10; i++)
+    {
+      CHECK(pinPage(bm, h, i));
+      CHECK(unpinPage(bm, h));
+    }
+  CHECK(forceFlushPool(bm));
+  ASSERT_EQUALS_INT(3, getNumWriteIO(bm), "pages 1 and 3 flushed from the tier");
+  CHECK(shutdownBufferPool(bm));
+
+  CHECK(openPageFile("testbuffer.bin", &fh));
+  CHECK(readBlock(1, &fh, block));
+  ASSERT_EQUALS_STRING("tier-1", block, "page 1 on disk");
+  CHECK(readBlock(3, &fh, block));
+  ASSERT_EQUALS_STRING("tier-3", block, "page 3 on disk");
+  CHECK(closePageFile(&fh));
+
+  // a tier too small for many pages writes back the modified pages it drops
+  options.compressedTierBytes = 64;
+  CHECK(initBufferPoolWithOptions(bm, "testbuffer.bin", 3, RS_FIFO, NULL, &options));
+  for (i = 0; i < 10; i++)
+    {
+      CHECK(pinPage(bm, h, i));
+      sprintf(h->data, "small-%i", i);
+      CHECK(markDirty(bm, h));
+      CHECK(unpinPage(bm, h));
+      ASSERT_TRUE(getTierBytesUsed(bm) <= 64, "tier stays under its limit");
+    }
+  CHECK(shutdownBufferPool(bm));
+
+  CHECK(openPageFile("testbuffer.bin", &fh));
+  for (i = 0; i < 10; i++)
+    {
+      sprintf(name, "small-%i", i);
+      CHECK(readBlock(i, &fh, block));
+      ASSERT_EQUALS_STRING(name, block, "every modification reached the disk");
+    }
+  CHECK(closePageFile(&fh));
+
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+// keep evicted pages of a file in a "slow" directory in a cache file in a "fast" one
+void
+testVictimCache (void)
+{
+  int i;
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  BM_PoolOptions options;
+  SM_FileHandle fh;
+  FILE *index;
+  char *zeros = calloc(PAGE_SIZE, 1);
+  testName = "Testing the victim cache file";
+
+  mkdir("testslow", 0755);
+  mkdir("testfast", 0755);
+  createDummyPages("testslow/testbuffer.bin", 10);
+  memset(&options, 0, sizeof(options));
+  options.victimCacheFile = "testfast/victim.bin";
+  ASSERT_ERROR(initBufferPoolWithOptions(bm, "testslow/testbuffer.bin", 3, RS_FIFO, NULL, &options),
+               "victim cache without pages");
+  options.victimCachePages = 4;
+  CHECK(initBufferPoolWithOptions(bm, "testslow/testbuffer.bin", 3, RS_FIFO, NULL, &options));
+  ASSERT_EQUALS_INT(0, getNumVictimRestored(bm), "new cache file starts empty");
+
+  // pages 0 to 2 are evicted into the cache file, page 1 after its write-back
+  for (i = 0; i < 6; i++)
+    {
+      CHECK(pinPage(bm, h, i));
+      if (i == 1)
+        {
+          sprintf(h->data, "%s", "victim-1");
+          CHECK(markDirty(bm, h));
+        }
+      CHECK(unpinPage(bm, h));
+    }
+  ASSERT_EQUALS_INT(3, getNumVictimWrites(bm), "three pages cached");
+  ASSERT_EQUALS_INT(1, getNumWriteIO(bm), "modified page written to its file first");
+
+  CHECK(pinPage(bm, h, 1));
+  ASSERT_EQUALS_STRING("victim-1", h->data, "page 1 read from the cache file");
+  CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_INT(1, getNumVictimHits(bm), "one cache hit");
+  ASSERT_EQUALS_INT(6, getNumReadIO(bm), "no read of the slow file");
+  CHECK(shutdownBufferPool(bm));
+
+  // pages 0, 2 and 3 survive the restart
+  CHECK(initBufferPoolWithOptions(bm, "testslow/testbuffer.bin", 3, RS_FIFO, NULL, &options));
+  ASSERT_EQUALS_INT(3, getNumVictimRestored(bm), "index restored");
+  CHECK(pinPage(bm, h, 0));
+  ASSERT_EQUALS_STRING("testslow/testbuffer.bin-0", h->data, "restored page");
+  CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_INT(0, getNumReadIO(bm), "restored page read locally");
+  CHECK(shutdownBufferPool(bm));
+
+  // a page file changed behind the cache's back invalidates its entries
+  CHECK(openPageFile("testslow/testbuffer.bin", &fh));
+  CHECK(appendEmptyBlock(&fh));
+  CHECK(closePageFile(&fh));
+  CHECK(initBufferPoolWithOptions(bm, "testslow/testbuffer.bin", 3, RS_FIFO, NULL, &options));
+  ASSERT_EQUALS_INT(0, getNumVictimRestored(bm), "entries of a modified file dropped");
+  for (i = 0; i < 6; i++)
+    {
+      CHECK(pinPage(bm, h, i));
+      CHECK(unpinPage(bm, h));
+    }
+  CHECK(shutdownBufferPool(bm));
+
+  // damaged slots fail their checksum and are read from the page file
+  CHECK(openPageFile("testfast/victim.bin", &fh));
+  for (i = 0; i < 4; i++)
+    CHECK(writeBlock(i, &fh, zeros));
+  CHECK(closePageFile(&fh));
+  CHECK(initBufferPoolWithOptions(bm, "testslow/testbuffer.bin", 3, RS_FIFO, NULL, &options));
+  ASSERT_EQUALS_INT(3, getNumVictimRestored(bm), "index of the damaged slots restored");
+  CHECK(pinPage(bm, h, 0));
+  ASSERT_EQUALS_STRING("testslow/testbuffer.bin-0", h->data, "page read from its file");
+  CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_INT(0, getNumVictimHits(bm), "damaged slot is no hit");
+  ASSERT_EQUALS_INT(1, getNumReadIO(bm), "slow file read instead");
+  CHECK(shutdownBufferPool(bm));
+
+  // a malformed index leaves the cache empty
+  index = fopen("testfast/victim.bin.idx", "w");
+  fprintf(index, "garbage\n");
+  fclose(index);
+  CHECK(initBufferPoolWithOptions(bm, "testslow/testbuffer.bin", 3, RS_FIFO, NULL, &options));
+  ASSERT_EQUALS_INT(0, getNumVictimRestored(bm), "malformed index ignored");
+  CHECK(shutdownBufferPool(bm));
+
+  CHECK(destroyPageFile("testslow/testbuffer.bin"));
+  CHECK(destroyPageFile("testfast/victim.bin"));
+  remove("testfast/victim.bin.idx");
+  rmdir("testslow");
+  rmdir("testfast");
+
+  free(zeros);
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+// pin hints place frames for FIFO, LRU and CLOCK
+void
+testPinHints (void)
+{
+  int i;
+  RC rc;
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  testName = "Testing pin priority hints";
+
+  createDummyPages("testbuffer.bin", 10);
+
+  // FIFO: a one-shot page gives its frame back, a kept page is skipped once
+  CHECK(initBufferPool(bm, "testbuffer.bin", 3, RS_FIFO, NULL));
+  for (i = 0; i < 3; i++)
+    {
+      CHECK(pinPage(bm, h, i));
+      CHECK(unpinPage(bm, h));
+    }
+  CHECK(pinPageWithHint(bm, h, 3, PH_EVICT_SOON));
+  CHECK(unpinPage(bm, h));
+  CHECK(pinPage(bm, h, 4));
+  CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_POOL("[4 0],[1 0],[2 0]", bm, "page 4 replaced the one-shot page 3");
+  CHECK(pinPageWithHint(bm, h, 1, PH_KEEP));
+  CHECK(unpinPage(bm, h));
+  CHECK(pinPage(bm, h, 5));
+  CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_POOL("[4 0],[1 0],[5 0]", bm, "kept page 1 skipped");
+  CHECK(pinPage(bm, h, 6));
+  CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_POOL("[6 0],[1 0],[5 0]", bm, "hand wrapped to frame 0");
+  CHECK(pinPage(bm, h, 7));
+  CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_POOL("[6 0],[7 0],[5 0]", bm, "protection lasts one pass of the hand");
+  rc = pinPageWithHint(bm, h, 1, (PinHint) 3);
+  ASSERT_ERROR(rc, "unknown hint");
+  CHECK(shutdownBufferPool(bm));
+
+  // LRU: a kept page counts as used one pool turnover later
+  CHECK(initBufferPool(bm, "testbuffer.bin", 3, RS_LRU, NULL));
+  CHECK(pinPageWithHint(bm, h, 0, PH_KEEP));
+  CHECK(unpinPage(bm, h));
+  for (i = 1; i < 4; i++)
+    {
+      CHECK(pinPage(bm, h, i));
+      CHECK(unpinPage(bm, h));
+    }
+  ASSERT_EQUALS_POOL("[0 0],[3 0],[2 0]", bm, "least recently used page 0 kept");
+  CHECK(pinPageWithHint(bm, h, 4, PH_EVICT_SOON));
+  CHECK(unpinPage(bm, h));
+  CHECK(pinPage(bm, h, 5));
+  CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_POOL("[0 0],[3 0],[5 0]", bm, "one-shot page 4 evicted first");
+  CHECK(shutdownBufferPool(bm));
+
+  // CLOCK: one-shot pages recycle the frame under the hand
+  CHECK(initBufferPool(bm, "testbuffer.bin", 3, RS_CLOCK, NULL));
+  for (i = 0; i < 3; i++)
+    {
+      CHECK(pinPage(bm, h, i));
+      CHECK(unpinPage(bm, h));
+    }
+  for (i = 3; i < 6; i++)
+    {
+      CHECK(pinPageWithHint(bm, h, i, PH_EVICT_SOON));
+      CHECK(unpinPage(bm, h));
+    }
+  ASSERT_EQUALS_POOL("[5 0],[1 0],[2 0]", bm, "scan pages share one frame");
+  CHECK(pinPage(bm, h, 1));
+  CHECK(unpinPage(bm, h));
+  CHECK(pinPageWithHint(bm, h, 1, PH_EVICT_SOON));
+  CHECK(unpinPage(bm, h));
+  for (i = 6; i < 8; i++)
+    {
+      CHECK(pinPage(bm, h, i));
+      CHECK(unpinPage(bm, h));
+    }
+  ASSERT_EQUALS_POOL("[6 0],[7 0],[2 0]", bm, "page 1 lost its second chance");
+  CHECK(pinPageWithHint(bm, h, 8, PH_KEEP));
+  CHECK(unpinPage(bm, h));
+  for (i = 9; i < 12; i++)
+    {
+      CHECK(pinPage(bm, h, i % 10));
+      CHECK(unpinPage(bm, h));
+    }
+  ASSERT_EQUALS_POOL("[1 0],[0 0],[8 0]", bm, "kept page 8 got a second chance");
+  CHECK(shutdownBufferPool(bm));
+
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+// two processes share one pool; the pins of the one that dies are given back
+#define SHARED_POOL_NAME "/bm_testbuffer"
+
+void
+testSharedPool (void)
+{
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_BufferPool *other = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  BM_PageHandle *h2 = MAKE_PAGE_HANDLE();
+  BM_PageHandle *h3 = MAKE_PAGE_HANDLE();
+  BM_PoolOptions options;
+  SM_FileHandle fh;
+  char block[PAGE_SIZE];
+  pid_t child;
+  int status;
+  RC rc;
+  testName = "Testing a pool shared by processes";
+
+  createDummyPages("testbuffer.bin", 10);
+  shm_unlink(SHARED_POOL_NAME);
+  memset(&options, 0, sizeof(options));
+  options.sharedPoolName = SHARED_POOL_NAME;
+  rc = initBufferPoolWithOptions(bm, "testbuffer.bin", 3, RS_LIRS, NULL, &options);
+  ASSERT_ERROR(rc, "LIRS keeps state outside the segment");
+  CHECK(initBufferPoolWithOptions(bm, "testbuffer.bin", 3, RS_FIFO, NULL, &options));
+  ASSERT_EQUALS_INT(1, getNumSharedProcesses(bm), "creator attached");
+  ASSERT_TRUE(getFrameMemoryMode(bm) == FM_SHARED, "frames in shared memory");
+
+  // attachments must match the pool; one that leaves keeps the segment
+  rc = initBufferPoolWithOptions(other, "testbuffer.bin", 4, RS_FIFO, NULL, &options);
+  ASSERT_ERROR(rc, "different number of frames");
+  rc = initBufferPoolWithOptions(other, "testbuffer.bin", 3, RS_LRU, NULL, &options);
+  ASSERT_ERROR(rc, "different strategy");
+  CHECK(initBufferPoolWithOptions(other, "testbuffer.bin", 3, RS_FIFO, NULL, &options));
+  ASSERT_EQUALS_INT(2, getNumSharedProcesses(bm), "second attachment");
+  CHECK(pinPage(other, h, 0));
+  sprintf(h->data, "%s", "shared-0");
+  CHECK(markDirty(other, h));
+  CHECK(unpinPage(other, h));
+  CHECK(shutdownBufferPool(other));
+  ASSERT_EQUALS_INT(1, getNumSharedProcesses(bm), "second attachment left");
+  ASSERT_EQUALS_POOL("[0x0],[-1 0],[-1 0]", bm, "modified page stays in the pool");
+  ASSERT_EQUALS_INT(0, getNumWriteIO(bm), "nothing written");
+
+  // the child sees the modification, modifies another page and dies holding a pin
+  fflush(stdout);
+  child = fork();
+  if (child == 0)
+    {
+      BM_BufferPool childPool;
+      BM_PageHandle childPage;
+
+      CHECK(initBufferPoolWithOptions(&childPool, "testbuffer.bin", 3, RS_FIFO, NULL, &options));
+      CHECK(pinPage(&childPool, &childPage, 0));
+      ASSERT_EQUALS_STRING("shared-0", childPage.data, "child sees the unwritten modification");
+      CHECK(unpinPage(&childPool, &childPage));
+      ASSERT_EQUALS_INT(0, getNumReadIO(&childPool), "child read nothing");
+      CHECK(pinPage(&childPool, &childPage, 1));
+      sprintf(childPage.data, "%s", "child-1");
+      CHECK(markDirty(&childPool, &childPage));
+      CHECK(unpinPage(&childPool, &childPage));
+      CHECK(pinPage(&childPool, &childPage, 2));
+      fflush(stdout);
+      _exit(0);
+    }
+  waitpid(child, &status, 0);
+  ASSERT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0, "child checks passed");
+  ASSERT_EQUALS_POOL("[0x0],[1x0],[2 1]", bm, "dead child's pin still counted");
+  h->fileId = DEFAULT_FILE_ID;
+  h->pageNum = 2;
+  h->frame = -1;
+  rc = unpinPage(bm, h);
+  ASSERT_ERROR(rc, "the pin belongs to the child");
+
+  // a pin that finds every frame pinned gives the dead child's pin back
+  CHECK(pinPage(bm, h, 0));
+  CHECK(pinPage(bm, h2, 1));
+  ASSERT_EQUALS_STRING("child-1", h2->data, "parent sees the child's modification");
+  CHECK(pinPage(bm, h3, 3));
+  ASSERT_EQUALS_POOL("[0x1],[1x1],[3 1]", bm, "page 3 replaced the orphaned page");
+  ASSERT_EQUALS_INT(1, getNumReclaimedProcesses(bm), "dead child reclaimed");
+  ASSERT_EQUALS_INT(1, getNumSharedProcesses(bm), "parent attached alone");
+  CHECK(unpinPage(bm, h));
+  CHECK(unpinPage(bm, h2));
+  CHECK(unpinPage(bm, h3));
+
+  // the last process writes the modified pages and removes the segment
+  CHECK(shutdownBufferPool(bm));
+  ASSERT_TRUE(shm_open(SHARED_POOL_NAME, O_RDWR, 0) == -1, "segment removed");
+  CHECK(openPageFile("testbuffer.bin", &fh));
+  CHECK(readBlock(1, &fh, block));
+  ASSERT_EQUALS_STRING("child-1", block, "child's page written by the last process");
+  CHECK(closePageFile(&fh));
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(bm);
+  free(other);
+  free(h);
+  free(h2);
+  free(h3);
+  TEST_DONE();
+}
+
+// a process killed in the middle of a miss leaves a pool the others can use
+void
+testSharedRecovery (void)
+{
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  BM_PageHandle pins[3];
+  BM_PoolOptions options;
+  struct timespec delay = { 0, 100 * 1000000 };
+  char expected[64];
+  int *fixCounts;
+  pid_t child;
+  int i, status;
+  testName = "Testing recovery from a process killed during a miss";
+
+  createDummyPages("testbuffer.bin", 10);
+  shm_unlink(SHARED_POOL_NAME);
+  memset(&options, 0, sizeof(options));
+  options.sharedPoolName = SHARED_POOL_NAME;
+  CHECK(initBufferPoolWithOptions(bm, "testbuffer.bin", 3, RS_SIEVE, NULL, &options));
+
+  // every read of the child takes 20 ms, so it is killed inside a miss
+  fflush(stdout);
+  child = fork();
+  if (child == 0)
+    {
+      BM_BufferPool childPool;
+      BM_PageHandle childPage;
+
+      setReadLatency(20000);
+      if (initBufferPoolWithOptions(&childPool, "testbuffer.bin", 3, RS_SIEVE, NULL,
+                                    &options) != RC_OK)
+        _exit(1);
+      for (i = 0; ; i++)
+        if (pinPage(&childPool, &childPage, i % 10) == RC_OK)
+          unpinPage(&childPool, &childPage);
+    }
+  nanosleep(&delay, NULL);
+  kill(child, SIGKILL);
+  waitpid(child, &status, 0);
+  ASSERT_TRUE(WIFSIGNALED(status), "child killed");
+
+  // every resident page holds its own content, and every frame can be replaced
+  for (i = 0; i < 10; i++)
+    {
+      CHECK(pinPage(bm, h, i));
+      sprintf(expected, "%s-%i", "testbuffer.bin", i);
+      ASSERT_EQUALS_STRING(expected, h->data, "page content after recovery");
+      CHECK(unpinPage(bm, h));
+    }
+  for (i = 0; i < 3; i++)
+    CHECK(pinPage(bm, &pins[i], 4 + i));
+  fixCounts = getFixCounts(bm);
+  for (i = 0; i < 3; i++)
+    ASSERT_EQUALS_INT(1, fixCounts[i], "every frame holds one of the pins");
+  free(fixCounts);
+  for (i = 0; i < 3; i++)
+    CHECK(unpinPage(bm, &pins[i]));
+  ASSERT_EQUALS_INT(1, getNumReclaimedProcesses(bm), "killed child reclaimed");
+  ASSERT_EQUALS_INT(1, getNumSharedProcesses(bm), "parent attached alone");
+
+  CHECK(shutdownBufferPool(bm));
+  ASSERT_TRUE(shm_open(SHARED_POOL_NAME, O_RDWR, 0) == -1, "segment removed");
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+// a pool publishes its counters in a segment that another reader maps
+#define STATS_NAME "/bm_teststats"
+
+void
+testPoolStats (void)
+{
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  BM_PoolOptions options;
+  const PoolStats *segment;
+  PoolStats stats;
+  uint64_t histogram[LATENCY_BUCKETS];
+  uint64_t reads = 0, writes = 0;
+  int i;
+  testName = "Testing the statistics segment";
+
+  // percentiles are bucket bounds in microseconds
+  memset(histogram, 0, sizeof(histogram));
+  ASSERT_EQUALS_INT(0, (int) latencyPercentile(histogram, 0.5), "empty histogram");
+  recordLatency(histogram, 500);
+  for (i = 0; i < 98; i++)
+    recordLatency(histogram, 3000);
+  recordLatency(histogram, 5000000);
+  ASSERT_EQUALS_INT(1, (int) histogram[0], "sub-microsecond bucket");
+  ASSERT_EQUALS_INT(98, (int) histogram[2], "2-4 us bucket");
+  ASSERT_EQUALS_INT(4, (int) latencyPercentile(histogram, 0.5), "median");
+  ASSERT_EQUALS_INT(4, (int) latencyPercentile(histogram, 0.99), "99th percentile");
+  ASSERT_EQUALS_INT(1 << 13, (int) latencyPercentile(histogram, 1.0), "slowest I/O");
+
+  createDummyPages("testbuffer.bin", 10);
+  ASSERT_TRUE(openPoolStats(STATS_NAME) == NULL, "no segment before the pool");
+  memset(&options, 0, sizeof(options));
+  options.statsName = STATS_NAME;
+  CHECK(initBufferPoolWithOptions(bm, "testbuffer.bin", 3, RS_FIFO, NULL, &options));
+  segment = openPoolStats(STATS_NAME);
+  ASSERT_TRUE(segment != NULL, "segment mapped");
+  snapshotPoolStats(segment, &stats);
+  ASSERT_EQUALS_INT(getpid(), (int) stats.pid, "owner");
+  ASSERT_EQUALS_INT(3, (int) stats.numFrames, "frames");
+  ASSERT_EQUALS_INT(RS_FIFO, (int) stats.strategy, "strategy");
+  ASSERT_EQUALS_STRING("testbuffer.bin", stats.pageFile, "page file");
+
+  // five misses fill three frames and evict two pages, then two hits
+  for (i = 0; i < 5; i++)
+    {
+      CHECK(pinPage(bm, h, i));
+      if (i == 4)
+        CHECK(markDirty(bm, h));
+      CHECK(unpinPage(bm, h));
+    }
+  CHECK(pinPage(bm, h, 4));
+  CHECK(unpinPage(bm, h));
+  CHECK(pinPage(bm, h, 3));
+  snapshotPoolStats(segment, &stats);
+  ASSERT_EQUALS_INT(2, (int) stats.hits, "hits");
+  ASSERT_EQUALS_INT(5, (int) stats.misses, "misses");
+  ASSERT_EQUALS_INT(2, (int) stats.evictions, "evictions");
+  ASSERT_EQUALS_INT(getNumReadIO(bm), (int) stats.reads, "reads");
+  for (i = 0; i < LATENCY_BUCKETS; i++)
+    reads += stats.readLatency[i];
+  ASSERT_EQUALS_INT(5, (int) reads, "every read timed");
+
+  // gauges are current after a flush
+  CHECK(forceFlushPool(bm));
+  snapshotPoolStats(segment, &stats);
+  ASSERT_EQUALS_INT(1, (int) stats.writes, "write");
+  for (i = 0; i < LATENCY_BUCKETS; i++)
+    writes += stats.writeLatency[i];
+  ASSERT_EQUALS_INT(1, (int) writes, "write timed");
+  ASSERT_EQUALS_INT(0, (int) stats.dirtyFrames, "no dirty frame");
+  ASSERT_EQUALS_INT(1, (int) stats.pinnedFrames, "one pinned frame");
+  CHECK(unpinPage(bm, h));
+
+  // the segment outlives its name for readers that still map it
+  CHECK(shutdownBufferPool(bm));
+  snapshotPoolStats(segment, &stats);
+  ASSERT_TRUE(stats.closed != 0, "pool closed");
+  ASSERT_TRUE(openPoolStats(STATS_NAME) == NULL, "segment removed");
+  closePoolStats(segment);
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
@@ -0,0 +1,406 @@
+extern "C" {
+#include "storage_mgr.h"
+#include "buffer_mgr_stat.h"
+#include "buffer_mgr.h"
+#include "dberror.h"
+#include "test_helper.h"
+}
+#include "buffer_pool.hpp"
+#include "page_guard.hpp"
+#include "async_pool.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <utility>
+
+// var to store the current test's name
+char *testName;
+
+#define SET_TEST_NAME(name) testName = const_cast<char *> (name)
+
+// check whether two the content of a buffer pool is the same as an expected content
+// (given in the format produced by sprintPoolContent)
+#define ASSERT_EQUALS_POOL(expected,bm,message)			        \
+  do {									\
+    char *real;								\
+    const char *_exp = (expected);                                      \
+    real = sprintPoolContent(bm);					\
+    if (strcmp((_exp),real) != 0)					\
+      {									\
+	printf("[%s-%s-L%i-%s] FAILED: expected <%s> but was <%s>: %s\n",TEST_INFO, _exp, real, message); \
+	free(real);							\
+	exit(1);							\
+      }									\
+    printf("[%s-%s-L%i-%s] OK: expected <%s> and was <%s>: %s\n",TEST_INFO, _exp, real, message); \
+    free(real);								\
+  } while(0)
+
+// test methods
+template <class Pool> static void testSameAsC (ReplacementStrategy strategy);
+static void testLargePages (void);
+static void testPageRefs (void);
+static void testPageGuards (void);
+static void testAsyncPin (void);
+
+// helper methods
+static void createDummyPages(const char *fileName, int num);
+template <class Pool> static std::string poolContent (const Pool &pool);
+static RC readFirstInt (BM_BufferPool *bm, PageNumber pageNum, int *value, bool fail);
+static bm::Task readPages (bm::AsyncBufferPool<bm::LruPolicy> &pool, int first, int count, int *matches);
+static bm::Task pinOnce (bm::AsyncBufferPool<bm::LruPolicy> &pool, PageNumber pageNum, bm::PinResult *result);
+
+// main method
+int
+main (void)
+{
+  initStorageManager();
+  testName = NULL;
+
+  testSameAsC<bm::FifoBufferPool>(RS_FIFO);
+  testSameAsC<bm::LruBufferPool>(RS_LRU);
+  testSameAsC<bm::ClockBufferPool>(RS_CLOCK);
+  testLargePages();
+  testPageRefs();
+  testPageGuards();
+  testAsyncPin();
+  return 0;
+}
+
+// create n pages with content "<fileName>-<pageNum>"
+void
+createDummyPages(const char *fileName, int num)
+{
+  int i;
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+
+  CHECK(createPageFile(fileName));
+  CHECK(initBufferPool(bm, fileName, 3, RS_FIFO, NULL));
+
+  for (i = 0; i < num; i++)
+    {
+      CHECK(pinPage(bm, h, i));
+      sprintf(h->data, "%s-%i", fileName, h->pageNum);
+      CHECK(markDirty(bm, h));
+      CHECK(unpinPage(bm,h));
+    }
+
+  CHECK(shutdownBufferPool(bm));
+
+  free(bm);
+  free(h);
+}
+
+// pool content in the format of sprintPoolContent
+template <class Pool> std::string
+poolContent (const Pool &pool)
+{
+  std::string content;
+  char frame[64];
+  int i;
+
+  for (i = 0; i < pool.frames(); i++)
+    {
+      sprintf(frame, "%s[%i%s%i]", (i == 0) ? "" : ",", pool.pageAt(i),
+              pool.dirtyAt(i) ? "x" : " ", pool.fixCountAt(i));
+      content += frame;
+    }
+  return content;
+}
+
+// random pins, some held across later requests, leave the template pool
+// with the same contents as the C pool of the same strategy
+template <class Pool> void
+testSameAsC (ReplacementStrategy strategy)
+{
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  BM_PageHandle held[3];
+  bm::PageRef ref, heldRefs[3];
+  Pool pool;
+  unsigned int random = 4711;
+  int i, same = 1;
+  SET_TEST_NAME("Testing template pool against the C pool");
+
+  createDummyPages("testbuffer.bin", 12);
+  CHECK(initBufferPool(bm, "testbuffer.bin", 5, strategy, NULL));
+  CHECK(pool.init("testbuffer.bin", 5));
+
+  for (i = 0; i < 500 && same; i++)
+    {
+      int page;
+      random = random * 1103515245u + 12345u;
+      page = (random >> 16) % 12;
+      if (i % 7 == 0)
+        {
+          int slot = (i / 7) % 3;
+          if (i >= 21)
+            {
+              CHECK(unpinPage(bm, &held[slot]));
+              CHECK(pool.unpin(heldRefs[slot]));
+            }
+          CHECK(pinPage(bm, &held[slot], page));
+          CHECK(pool.pin(page, heldRefs[slot]));
+        }
+      else
+        {
+          CHECK(pinPage(bm, h, page));
+          CHECK(pool.pin(page, ref));
+          same = strcmp(h->data, ref.data) == 0;
+          if (i % 5 == 0)
+            {
+              CHECK(markDirty(bm, h));
+              CHECK(pool.markDirty(ref));
+            }
+          CHECK(unpinPage(bm, h));
+          CHECK(pool.unpin(ref));
+        }
+      char *expected = sprintPoolContent(bm);
+      same = same && poolContent(pool) == expected;
+      free(expected);
+    }
+  ASSERT_TRUE(same, Pool::strategyName());
+  ASSERT_EQUALS_INT(getNumReadIO(bm), pool.numReadIO(), "same number of reads");
+  ASSERT_EQUALS_INT(getNumWriteIO(bm), pool.numWriteIO(), "same number of writes");
+
+  for (i = 0; i < 3; i++)
+    {
+      CHECK(unpinPage(bm, &held[i]));
+      CHECK(pool.unpin(heldRefs[i]));
+    }
+  CHECK(shutdownBufferPool(bm));
+  CHECK(pool.shutdown());
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+// pages of two blocks map to consecutive blocks of the page file
+void
+testLargePages (void)
+{
+  bm::BufferPool<bm::ClockPolicy, 2 * PAGE_SIZE> pool;
+  bm::PageRef ref;
+  SM_FileHandle fh;
+  char block[PAGE_SIZE];
+  SET_TEST_NAME("Testing template pool with 8 KB pages");
+
+  createDummyPages("testbuffer.bin", 6);
+  CHECK(pool.init("testbuffer.bin", 2));
+  CHECK(pool.pin(1, ref));
+  ASSERT_EQUALS_STRING("testbuffer.bin-2", ref.data, "first block of page 1");
+  ASSERT_EQUALS_STRING("testbuffer.bin-3", ref.data + PAGE_SIZE, "second block of page 1");
+
+  sprintf(ref.data + PAGE_SIZE, "%s", "second half");
+  CHECK(pool.markDirty(ref));
+  CHECK(pool.unpin(ref));
+
+  // a page beyond the end of the file grows it by whole pages
+  CHECK(pool.pin(4, ref));
+  CHECK(pool.unpin(ref));
+  CHECK(pool.pin(2, ref));
+  CHECK(pool.unpin(ref));
+  ASSERT_EQUALS_INT(1, pool.numWriteIO(), "page 1 written on eviction");
+  CHECK(pool.shutdown());
+
+  CHECK(openPageFile("testbuffer.bin", &fh));
+  ASSERT_EQUALS_INT(10, fh.totalNumPages, "file holds five pages of two blocks");
+  CHECK(readBlock(3, &fh, block));
+  ASSERT_EQUALS_STRING("second half", block, "block 3 was written");
+  CHECK(readBlock(2, &fh, block));
+  ASSERT_EQUALS_STRING("testbuffer.bin-2", block, "block 2 unchanged");
+  CHECK(closePageFile(&fh));
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  TEST_DONE();
+}
+
+// page references only release pins of the page they were pinned for
+void
+testPageRefs (void)
+{
+  bm::LruBufferPool pool;
+  bm::PageRef ref, stale, other;
+  SET_TEST_NAME("Testing template pool page references");
+
+  createDummyPages("testbuffer.bin", 4);
+  ASSERT_ERROR(pool.pin(0, ref), "pool is not initialized");
+  CHECK(pool.init("testbuffer.bin", 1));
+  ASSERT_ERROR(pool.init("testbuffer.bin", 1), "pool is already initialized");
+
+  CHECK(pool.pin(0, ref));
+  CHECK(pool.pin(0, other));
+  ASSERT_EQUALS_INT(2, pool.fixCountAt(0), "pinned twice");
+  ASSERT_ERROR(pool.pin(1, stale), "only frame is pinned");
+  ASSERT_ERROR(pool.shutdown(), "pages are pinned");
+  CHECK(pool.unpin(ref));
+  CHECK(pool.unpin(other));
+  ASSERT_ERROR(pool.unpin(other), "no pin left");
+
+  stale = ref;
+  CHECK(pool.pin(1, ref));
+  ASSERT_ERROR(pool.unpin(stale), "frame now holds another page");
+  ASSERT_ERROR(pool.markDirty(stale), "frame now holds another page");
+  CHECK(pool.unpin(ref));
+  CHECK(pool.shutdown());
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  TEST_DONE();
+}
+
+// pins a page and returns early on the way, relying on the guard to unpin
+RC
+readFirstInt (BM_BufferPool *bm, PageNumber pageNum, int *value, bool fail)
+{
+  bm::PageGuard guard;
+  RC rc = guard.pin(bm, pageNum);
+  if (rc != RC_OK)
+    return rc;
+  if (fail)
+    return RC_ERROR;
+  *value = guard.view<int>()[0];
+  return RC_OK;
+}
+
+// guards unpin on every path, move their pin and mark written pages dirty
+void
+testPageGuards (void)
+{
+  BM_BufferPool *bm = MAKE_POOL();
+  int value = 0;
+  SET_TEST_NAME("Testing RAII page guards");
+
+  CHECK(createPageFile("testbuffer.bin"));
+  CHECK(initBufferPool(bm, "testbuffer.bin", 3, RS_LRU, NULL));
+
+  {
+    bm::WritePageGuard page;
+    CHECK(page.pin(bm, 2));
+    bm::PageView<int> ints = page.view<int>();
+    ASSERT_EQUALS_INT((int) (PAGE_SIZE / sizeof(int)), (int) ints.size(), "ints per page");
+    ints[0] = 42;
+    ints[ints.size() - 1] = 7;
+    ASSERT_EQUALS_POOL("[2x1],[-1 0],[-1 0]", bm, "write guard marks the page dirty");
+  }
+  ASSERT_EQUALS_POOL("[2x0],[-1 0],[-1 0]", bm, "unpinned at the end of the scope");
+
+  ASSERT_ERROR(readFirstInt(bm, 2, &value, true), "early return");
+  ASSERT_EQUALS_POOL("[2x0],[-1 0],[-1 0]", bm, "early return released the pin");
+  CHECK(readFirstInt(bm, 2, &value, false));
+  ASSERT_EQUALS_INT(42, value, "typed view reads the page");
+
+  {
+    bm::PageGuard first, second;
+    CHECK(first.pin(bm, 2));
+    second = std::move(first);
+    ASSERT_TRUE(!first && second, "pin moved to the second guard");
+    bm::PageGuard third(std::move(second));
+    ASSERT_EQUALS_POOL("[2x1],[-1 0],[-1 0]", bm, "moving keeps a single pin");
+    ASSERT_EQUALS_INT(7, third.view<int>()[PAGE_SIZE / sizeof(int) - 1], "last int of the page");
+
+    CHECK(third.pin(bm, 3));
+    ASSERT_EQUALS_POOL("[2x0],[3 1],[-1 0]", bm, "pinning another page releases the first");
+    CHECK(third.release());
+    CHECK(third.release());
+    ASSERT_EQUALS_POOL("[2x0],[3 0],[-1 0]", bm, "release is idempotent");
+  }
+
+  CHECK(shutdownBufferPool(bm));
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(bm);
+  TEST_DONE();
+}
+
+// pins count pages starting at first, one at a time, and counts the ones
+// holding the expected content
+bm::Task
+readPages (bm::AsyncBufferPool<bm::LruPolicy> &pool, int first, int count, int *matches)
+{
+  char expected[64];
+  int i;
+
+  for (i = 0; i < count; i++)
+    {
+      int page = (first + i) % 12;
+      bm::PinResult pin = co_await pool.pin(page);
+      if (pin.rc != RC_OK)
+        continue;
+      sprintf(expected, "testbuffer.bin-%i", page);
+      if (strcmp(expected, pin.ref.data) == 0)
+        (*matches)++;
+      CHECK(pool.unpin(pin.ref));
+    }
+}
+
+// pins a page and keeps the pin
+bm::Task
+pinOnce (bm::AsyncBufferPool<bm::LruPolicy> &pool, PageNumber pageNum, bm::PinResult *result)
+{
+  *result = co_await pool.pin(pageNum);
+}
+
+// coroutines pin pages read by I/O threads; concurrent pins of a page
+// share one read and resident pages do not suspend
+void
+testAsyncPin (void)
+{
+  bm::Executor executor;
+  bm::IoThreadPool io(2);
+  bm::AsyncBufferPool<bm::LruPolicy> pool(executor, io);
+  bm::PinResult first, second, third, failed;
+  int matches = 0, i;
+  SET_TEST_NAME("Testing coroutine pins");
+
+  createDummyPages("testbuffer.bin", 13);
+  CHECK(pool.init("testbuffer.bin", 4));
+
+  // one pin per task until its page is read, so no more tasks than frames
+  for (i = 0; i < 4; i++)
+    executor.spawn(readPages(pool, i * 3, 50, &matches));
+  executor.run();
+  ASSERT_EQUALS_INT(200, matches, "every pin sees its page");
+
+  // page 12 is not one of the pages read above
+  int reads = pool.numReadIO();
+  executor.spawn(pinOnce(pool, 12, &first));
+  executor.spawn(pinOnce(pool, 12, &second));
+  executor.run();
+  CHECK(first.rc);
+  CHECK(second.rc);
+  ASSERT_TRUE(first.ref.data == second.ref.data, "same frame");
+  ASSERT_EQUALS_STRING("testbuffer.bin-12", second.ref.data, "second pin waited for the read");
+  ASSERT_EQUALS_INT(reads + 1, pool.numReadIO(), "concurrent pins share one read");
+
+  reads = pool.numReadIO();
+  int suspended = pool.numSuspendedPins();
+  executor.spawn(pinOnce(pool, 12, &third));
+  executor.run();
+  CHECK(third.rc);
+  ASSERT_EQUALS_INT(reads, pool.numReadIO(), "resident page is not read again");
+  ASSERT_EQUALS_INT(suspended, pool.numSuspendedPins(), "resident page does not suspend");
+
+  bm::PinResult held[3];
+  for (i = 0; i < 3; i++)
+    executor.spawn(pinOnce(pool, i, &held[i]));
+  executor.spawn(pinOnce(pool, 6, &failed));
+  executor.run();
+  ASSERT_ERROR(failed.rc, "all frames are pinned");
+  for (i = 0; i < 3; i++)
+    CHECK(pool.unpin(held[i].ref));
+
+  CHECK(pool.unpin(first.ref));
+  CHECK(pool.unpin(second.ref));
+  CHECK(pool.unpin(third.ref));
+  executor.spawn(pinOnce(pool, -1, &failed));
+  executor.run();
+  ASSERT_ERROR(failed.rc, "negative page number");
+  CHECK(pool.shutdown());
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  TEST_DONE();
+}
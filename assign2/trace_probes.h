@@ -0,0 +1,77 @@
+#ifndef TRACE_PROBES_H
+#define TRACE_PROBES_H
+
+// USDT probes of the buffer manager (provider "bufmgr") and the storage
+// manager (provider "storage") for bpftrace, perf and SystemTap; the
+// scripts in tracing/ use them. With <sys/sdt.h> (systemtap-sdt-dev or
+// systemtap-sdt-devel) every probe is a single nop until a tracer attaches,
+// plus the clock reads at the start and end of each pin and I/O for its
+// latency argument. Without the header, or with -DBM_NO_TRACE, the probes
+// and the clock reads compile to nothing.
+//
+// Latencies are in nanoseconds, strings are page file names.
+//
+//   bufmgr:pin__hit      (fileId, pageNum, frame, latency)  lookup and pin
+//   bufmgr:pin__miss     (fileId, pageNum, frame, latency)  also eviction and load
+//   bufmgr:evict         (fileId, pageNum, frame, dirty)
+//   bufmgr:write__back   (fileId, pageNum, frame, bytes, latency)
+//   storage:read__block  (fileName, pageNum, numPages, latency, rc)
+//   storage:write__block (fileName, pageNum, bytes, latency, rc)
+
+#include <stdint.h>
+
+#if !defined(BM_NO_TRACE) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define BM_TRACE 1
+#endif
+#endif
+
+#ifdef BM_TRACE
+
+#include <time.h>
+
+// Monotonic clock in nanoseconds for latency arguments
+static inline uint64_t traceClock(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+#define TRACE_CLOCK() traceClock()
+
+#define TRACE_PIN_HIT(fileId, pageNum, frame, latency) \
+		DTRACE_PROBE4(bufmgr, pin__hit, fileId, pageNum, frame, latency)
+#define TRACE_PIN_MISS(fileId, pageNum, frame, latency) \
+		DTRACE_PROBE4(bufmgr, pin__miss, fileId, pageNum, frame, latency)
+#define TRACE_EVICT(fileId, pageNum, frame, dirty) \
+		DTRACE_PROBE4(bufmgr, evict, fileId, pageNum, frame, dirty)
+#define TRACE_WRITE_BACK(fileId, pageNum, frame, bytes, latency) \
+		DTRACE_PROBE5(bufmgr, write__back, fileId, pageNum, frame, bytes, latency)
+#define TRACE_READ_BLOCK(fileName, pageNum, numPages, latency, rc) \
+		DTRACE_PROBE5(storage, read__block, fileName, pageNum, numPages, latency, rc)
+#define TRACE_WRITE_BLOCK(fileName, pageNum, bytes, latency, rc) \
+		DTRACE_PROBE5(storage, write__block, fileName, pageNum, bytes, latency, rc)
+
+#else
+
+// Arguments are still evaluated as void, so variables that only feed a
+// probe do not warn; the clock is a constant the compiler folds away
+#define TRACE_CLOCK() ((uint64_t)0)
+
+#define TRACE_PIN_HIT(fileId, pageNum, frame, latency) \
+		((void)(fileId), (void)(pageNum), (void)(frame), (void)(latency))
+#define TRACE_PIN_MISS(fileId, pageNum, frame, latency) \
+		((void)(fileId), (void)(pageNum), (void)(frame), (void)(latency))
+#define TRACE_EVICT(fileId, pageNum, frame, dirty) \
+		((void)(fileId), (void)(pageNum), (void)(frame), (void)(dirty))
+#define TRACE_WRITE_BACK(fileId, pageNum, frame, bytes, latency) \
+		((void)(fileId), (void)(pageNum), (void)(frame), (void)(bytes), (void)(latency))
+#define TRACE_READ_BLOCK(fileName, pageNum, numPages, latency, rc) \
+		((void)(fileName), (void)(pageNum), (void)(numPages), (void)(latency), (void)(rc))
+#define TRACE_WRITE_BLOCK(fileName, pageNum, bytes, latency, rc) \
+		((void)(fileName), (void)(pageNum), (void)(bytes), (void)(latency), (void)(rc))
+
+#endif
+
+#endif
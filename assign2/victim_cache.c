@@ -0,0 +1,398 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include "victim_cache.h"
+
+/* Version line at the top of an index file */
+#define VICTIM_INDEX_MAGIC "BMVICTIM 1"
+
+/* Longest line of an index file, including the page file name */
+#define VICTIM_LINE_SIZE 1024
+
+/*
+ * Bucket of a page key (splitmix64 finalizer)
+ */
+static inline int bucketOf(const VictimCache *cache, FileId fileId, PageNumber pageNum)
+{
+    uint64_t h = ((uint64_t)(uint32_t)fileId << 32) | (uint32_t)pageNum;
+    h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+    h ^= h >> 31;
+    return (int)(h & (uint64_t)cache->bucketMask);
+}
+
+/*
+ * Checksum of a page, 8 bytes at a time (FNV-1a over words)
+ */
+static uint64_t pageChecksum(const char *page)
+{
+    uint64_t h = 0xCBF29CE484222325ULL;
+    for (int i = 0; i < PAGE_SIZE; i += 8) {
+        uint64_t word;
+        memcpy(&word, page + i, sizeof(word));
+        h = (h ^ word) * 0x100000001B3ULL;
+        h ^= h >> 29;
+    }
+    return h;
+}
+
+/*
+ * Finds the slot holding a page
+ * @return Slot index, -1 if the page is not cached
+ */
+static int findSlot(const VictimCache *cache, FileId fileId, PageNumber pageNum)
+{
+    for (int s = cache->buckets[bucketOf(cache, fileId, pageNum)]; s != -1;
+         s = cache->slots[s].hashNext) {
+        if (cache->slots[s].pageNum == pageNum && cache->slots[s].fileId == fileId) {
+            return s;
+        }
+    }
+    return -1;
+}
+
+/*
+ * Enters a page into a free slot's hash chain
+ */
+static void insertSlot(VictimCache *cache, int s, FileId fileId, PageNumber pageNum,
+                       uint64_t checksum)
+{
+    int bucket = bucketOf(cache, fileId, pageNum);
+    cache->slots[s].fileId = fileId;
+    cache->slots[s].pageNum = pageNum;
+    cache->slots[s].checksum = checksum;
+    cache->slots[s].hashNext = cache->buckets[bucket];
+    cache->buckets[bucket] = s;
+}
+
+/*
+ * Removes a slot from its hash chain and marks it free
+ */
+static void removeSlot(VictimCache *cache, int s)
+{
+    VictimSlot *slot = &cache->slots[s];
+    int *link = &cache->buckets[bucketOf(cache, slot->fileId, slot->pageNum)];
+    while (*link != s) {
+        link = &cache->slots[*link].hashNext;
+    }
+    *link = slot->hashNext;
+    slot->pageNum = NO_PAGE;
+}
+
+/*
+ * Reads one line of an index file without its newline
+ * @return 1 on success, 0 at the end of the file or for overlong lines
+ */
+static int readIndexLine(FILE *filePtr, char *line, int size)
+{
+    if (fgets(line, size, filePtr) == NULL) {
+        return 0;
+    }
+
+    size_t len = strlen(line);
+    if (len == 0 || line[len - 1] != '\n') {
+        return 0;
+    }
+    line[len - 1] = '\0';
+    return 1;
+}
+
+/*
+ * Restores the entries of a saved index, then removes the index file
+ * Entries survive only if the index matches the slot count and their page
+ * file still has the recorded size and modification time
+ */
+static void loadIndex(VictimCache *cache, VictimResolveFile resolve, void *context)
+{
+    FILE *filePtr = fopen(cache->indexFile, "r");
+    if (filePtr == NULL) {
+        return;
+    }
+
+    char line[VICTIM_LINE_SIZE];
+    int numSlots = 0;
+    int hand = 0;
+    int numFiles = 0;
+    int numEntries = 0;
+    FileId *fileMap = NULL;
+
+    if (!readIndexLine(filePtr, line, sizeof(line)) || strcmp(line, VICTIM_INDEX_MAGIC) != 0 ||
+        !readIndexLine(filePtr, line, sizeof(line)) ||
+        sscanf(line, "%d %d", &numSlots, &hand) != 2 || numSlots != cache->numSlots ||
+        hand < 0 || hand >= numSlots ||
+        !readIndexLine(filePtr, line, sizeof(line)) || sscanf(line, "%d", &numFiles) != 1 ||
+        numFiles < 0) {
+        goto cleanup;
+    }
+
+    fileMap = (FileId*)malloc(sizeof(FileId) * (numFiles + 1));
+    if (fileMap == NULL) {
+        goto cleanup;
+    }
+    for (int i = 0; i < numFiles; i++) {
+        long long size;
+        long long sec;
+        long nsec;
+        int nameStart;
+        struct stat st;
+        if (!readIndexLine(filePtr, line, sizeof(line)) ||
+            sscanf(line, "%lld %lld %ld %n", &size, &sec, &nsec, &nameStart) != 3) {
+            goto cleanup;
+        }
+
+        /* A page file written since the index was saved invalidates its pages */
+        const char *name = line + nameStart;
+        if (stat(name, &st) != 0 || (long long)st.st_size != size ||
+            (long long)st.st_mtim.tv_sec != sec || st.st_mtim.tv_nsec != nsec) {
+            fileMap[i] = -1;
+        } else {
+            fileMap[i] = resolve(context, name);
+        }
+    }
+
+    if (!readIndexLine(filePtr, line, sizeof(line)) || sscanf(line, "%d", &numEntries) != 1) {
+        goto cleanup;
+    }
+    for (int i = 0; i < numEntries && readIndexLine(filePtr, line, sizeof(line)); i++) {
+        int s;
+        int fileIdx;
+        int pageNum;
+        unsigned long long checksum;
+        if (sscanf(line, "%d %d %d %llx", &s, &fileIdx, &pageNum, &checksum) != 4 ||
+            s < 0 || s >= cache->numSlots || cache->slots[s].pageNum != NO_PAGE ||
+            fileIdx < 0 || fileIdx >= numFiles || fileMap[fileIdx] == -1 || pageNum < 0 ||
+            findSlot(cache, fileMap[fileIdx], pageNum) != -1) {
+            continue;
+        }
+        insertSlot(cache, s, fileMap[fileIdx], pageNum, (uint64_t)checksum);
+        cache->restored++;
+    }
+    cache->hand = hand;
+
+cleanup:
+    free(fileMap);
+    fclose(filePtr);
+    remove(cache->indexFile);
+}
+
+/*
+ * Writes the index of the cached pages to a temporary file and renames it
+ * over the index file
+ * @return 0 on success, -1 if the index could not be written
+ */
+static int saveIndex(VictimCache *cache, VictimFileName fileName, void *context)
+{
+    /* Page files referenced by a slot, numbered in order of first use */
+    int maxFileId = -1;
+    for (int s = 0; s < cache->numSlots; s++) {
+        if (cache->slots[s].pageNum != NO_PAGE && cache->slots[s].fileId > maxFileId) {
+            maxFileId = cache->slots[s].fileId;
+        }
+    }
+    int *fileIdx = (int*)malloc(sizeof(int) * (maxFileId + 2));
+    char *tmpName = (char*)malloc(strlen(cache->indexFile) + 5);
+    if (fileIdx == NULL || tmpName == NULL) {
+        free(fileIdx);
+        free(tmpName);
+        return -1;
+    }
+    for (int i = 0; i <= maxFileId; i++) {
+        fileIdx[i] = -1;
+    }
+    sprintf(tmpName, "%s.tmp", cache->indexFile);
+
+    FILE *filePtr = fopen(tmpName, "w");
+    if (filePtr == NULL) {
+        free(fileIdx);
+        free(tmpName);
+        return -1;
+    }
+
+    int numFiles = 0;
+    int numEntries = 0;
+    for (int s = 0; s < cache->numSlots; s++) {
+        if (cache->slots[s].pageNum != NO_PAGE) {
+            numEntries++;
+            if (fileIdx[cache->slots[s].fileId] == -1) {
+                fileIdx[cache->slots[s].fileId] = numFiles++;
+            }
+        }
+    }
+
+    fprintf(filePtr, "%s\n%d %d\n%d\n", VICTIM_INDEX_MAGIC, cache->numSlots, cache->hand,
+            numFiles);
+    int failed = 0;
+    for (int idx = 0; idx < numFiles; idx++) {
+        FileId fileId = 0;
+        while (fileIdx[fileId] != idx) {
+            fileId++;
+        }
+        const char *name = fileName(context, fileId);
+        struct stat st;
+        if (stat(name, &st) != 0) {
+            failed = 1;
+            break;
+        }
+        fprintf(filePtr, "%lld %lld %ld %s\n", (long long)st.st_size,
+                (long long)st.st_mtim.tv_sec, (long)st.st_mtim.tv_nsec, name);
+    }
+    fprintf(filePtr, "%d\n", numEntries);
+    for (int s = 0; s < cache->numSlots; s++) {
+        if (cache->slots[s].pageNum != NO_PAGE) {
+            fprintf(filePtr, "%d %d %d %llx\n", s, fileIdx[cache->slots[s].fileId],
+                    cache->slots[s].pageNum, (unsigned long long)cache->slots[s].checksum);
+        }
+    }
+
+    failed |= ferror(filePtr);
+    failed |= (fclose(filePtr) != 0);
+    if (!failed) {
+        failed = (rename(tmpName, cache->indexFile) != 0);
+    }
+    if (failed) {
+        remove(tmpName);
+    }
+
+    free(fileIdx);
+    free(tmpName);
+    return failed ? -1 : 0;
+}
+
+/*
+ * Opens or creates a cache file and restores its saved index
+ * @param cache - Cache to initialize
+ * @param fileName - Cache file, on the fast local device
+ * @param numSlots - Number of pages the cache file holds
+ * @param resolve - Registers the page files named in the index
+ * @param context - Passed to resolve
+ * @return 0 on success, -1 if out of memory or the file cannot be used
+ */
+extern int openVictimCache(VictimCache *cache, const char *fileName, int numSlots,
+                           VictimResolveFile resolve, void *context)
+{
+    if (numSlots <= 0 || numSlots > (1 << 30)) {
+        return -1;
+    }
+
+    int numBuckets = 1;
+    while (numBuckets < numSlots) {
+        numBuckets <<= 1;
+    }
+
+    cache->slots = (VictimSlot*)malloc(sizeof(VictimSlot) * numSlots);
+    cache->buckets = (int*)malloc(sizeof(int) * numBuckets);
+    cache->indexFile = (char*)malloc(strlen(fileName) + 5);
+    if (cache->slots == NULL || cache->buckets == NULL || cache->indexFile == NULL) {
+        free(cache->slots);
+        free(cache->buckets);
+        free(cache->indexFile);
+        return -1;
+    }
+    sprintf(cache->indexFile, "%s.idx", fileName);
+
+    /* Existing slots are only trusted through the index */
+    if ((openPageFile(fileName, &cache->fh) != RC_OK &&
+         (createPageFile(fileName) != RC_OK || openPageFile(fileName, &cache->fh) != RC_OK))) {
+        free(cache->slots);
+        free(cache->buckets);
+        free(cache->indexFile);
+        return -1;
+    }
+    if (ensureCapacity(numSlots, &cache->fh) != RC_OK) {
+        closePageFile(&cache->fh);
+        free(cache->slots);
+        free(cache->buckets);
+        free(cache->indexFile);
+        return -1;
+    }
+
+    for (int i = 0; i < numBuckets; i++) {
+        cache->buckets[i] = -1;
+    }
+    for (int s = 0; s < numSlots; s++) {
+        cache->slots[s].pageNum = NO_PAGE;
+    }
+    cache->numSlots = numSlots;
+    cache->bucketMask = numBuckets - 1;
+    cache->hand = 0;
+    cache->hits = 0;
+    cache->writes = 0;
+    cache->restored = 0;
+
+    loadIndex(cache, resolve, context);
+    return 0;
+}
+
+/*
+ * Saves the index and closes the cache file
+ * @param fileName - Names the page files of the entries, NULL to drop the index
+ * @return 0 on success, -1 if the index could not be saved
+ */
+extern int closeVictimCache(VictimCache *cache, VictimFileName fileName, void *context)
+{
+    int result = (fileName != NULL) ? saveIndex(cache, fileName, context) : 0;
+
+    closePageFile(&cache->fh);
+    free(cache->slots);
+    free(cache->buckets);
+    free(cache->indexFile);
+    cache->slots = NULL;
+    cache->buckets = NULL;
+    cache->indexFile = NULL;
+    return result;
+}
+
+/*
+ * Moves a page out of the cache
+ * @param page - Receives the PAGE_SIZE bytes of the page
+ * @return true on a hit, false if the page is not cached or its slot is damaged
+ */
+extern bool readVictimPage(VictimCache *cache, FileId fileId, PageNumber pageNum, char *page)
+{
+    int s = findSlot(cache, fileId, pageNum);
+    if (s == -1) {
+        return false;
+    }
+
+    bool valid = readBlock(s, &cache->fh, page) == RC_OK &&
+                 pageChecksum(page) == cache->slots[s].checksum;
+    removeSlot(cache, s);
+    if (valid) {
+        cache->hits++;
+    }
+    return valid;
+}
+
+/*
+ * Copies a clean page into the slot under the hand, replacing its page
+ */
+extern void storeVictimPage(VictimCache *cache, FileId fileId, PageNumber pageNum,
+                            const char *page)
+{
+    dropVictimPage(cache, fileId, pageNum);
+
+    int s = cache->hand;
+    cache->hand = (cache->hand + 1) % cache->numSlots;
+    if (cache->slots[s].pageNum != NO_PAGE) {
+        removeSlot(cache, s);
+    }
+
+    if (writeBlock(s, &cache->fh, (SM_PageHandle)page) == RC_OK) {
+        insertSlot(cache, s, fileId, pageNum, pageChecksum(page));
+        cache->writes++;
+    }
+}
+
+/*
+ * Forgets a cached page, if any
+ */
+extern void dropVictimPage(VictimCache *cache, FileId fileId, PageNumber pageNum)
+{
+    int s = findSlot(cache, fileId, pageNum);
+    if (s != -1) {
+        removeSlot(cache, s);
+    }
+}
@@ -0,0 +1,64 @@
+#ifndef VICTIM_CACHE_H
+#define VICTIM_CACHE_H
+
+// Victim cache on a fast local device: clean pages evicted from a buffer
+// pool are copied into the slots of a local page file, so later misses read
+// them there instead of from their slow page file. Slots are reused in FIFO
+// order and a page leaves the cache when the pool reads it back. Closing the
+// cache saves its index to "<cache file>.idx" with the size and modification
+// time of every page file it refers to; opening restores the entries whose
+// page file still matches and removes the index, so a crash leaves an empty
+// cache rather than a stale one.
+
+#include <stdint.h>
+#include "buffer_mgr.h"
+
+typedef struct VictimSlot {
+	FileId fileId;
+	PageNumber pageNum;  // NO_PAGE for free slots
+	uint64_t checksum;   // Of the slot's page, verified on every read
+	int hashNext;        // Next slot of the same bucket, -1 at the end
+} VictimSlot;
+
+typedef struct VictimCache {
+	SM_FileHandle fh;    // Cache file, page i holds slot i
+	char *indexFile;
+	VictimSlot *slots;
+	int numSlots;
+	int *buckets;        // First slot of each hash bucket, -1 if none
+	int bucketMask;
+	int hand;            // Next slot to overwrite
+	int hits;            // Misses served from the cache file
+	int writes;          // Pages copied into the cache file
+	int restored;        // Entries recovered from the saved index
+} VictimCache;
+
+// Registers the page file named in a saved index with the pool; returns
+// its id, or -1 if it cannot be opened
+typedef FileId (*VictimResolveFile) (void *context, const char *fileName);
+
+// Name of a registered page file
+typedef const char *(*VictimFileName) (void *context, FileId fileId);
+
+// Opens or creates the cache file with numSlots slots and restores the
+// saved index; returns 0 on success, -1 if the file cannot be used
+int openVictimCache (VictimCache *cache, const char *fileName, int numSlots,
+		VictimResolveFile resolve, void *context);
+
+// Saves the index unless fileName is NULL, then closes the cache file;
+// returns 0 on success, -1 if the index could not be saved
+int closeVictimCache (VictimCache *cache, VictimFileName fileName, void *context);
+
+// Moves a page out of the cache into page (PAGE_SIZE bytes); returns true
+// on a hit, false if the page is not cached or its slot fails the checksum
+bool readVictimPage (VictimCache *cache, FileId fileId, PageNumber pageNum, char *page);
+
+// Copies a clean page into the next slot; a failed write just leaves the
+// page uncached
+void storeVictimPage (VictimCache *cache, FileId fileId, PageNumber pageNum,
+		const char *page);
+
+// Forgets a page that reached the pool by another path
+void dropVictimPage (VictimCache *cache, FileId fileId, PageNumber pageNum);
+
+#endif